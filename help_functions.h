@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file           : help_functions.h
+ * @brief          : Utility and helper functions interface
+ * @author         : Ahmad Asmandar
+ * @company        : Kompass GmbH
+ * @date           : 01.08.2025
+ ******************************************************************************
+ * @description
+ *   Types and prototypes of help_functions.c: command clean-up, time stamp,
+ *   microsecond delay, temperature JSON and the Z-frame parser that fills
+ *   remoteState.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+#ifndef HELP_FUNCTIONS_H
+#define HELP_FUNCTIONS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "main.h"    /* HAL types and handles, __disable_irq() */
+#include "ds3231.h"  /* DS_TIME, DS3231_get() */
+#include "tmp1075.h" /* TMP1075_Get_Temperature_Celsius() */
+
+/* Exported constants --------------------------------------------------------*/
+/* 1: RemoteState_t also keeps the position text as received; 0 drops the
+ * 32-byte copy and leaves only position_um */
+#ifndef Z_POSITION_TEXT
+#define Z_POSITION_TEXT 1
+#endif
+
+/* 1: measure_temperatures() sends the snapshot that 19_temp_acquisition.c reads
+ * in the background, via measure_temperatures_cached() of 20_json_telemetry.c
+ * (both linked into the project, temp_acq_init() holds the addresses);
+ * 0 keeps the blocking TMP1075 reads with HAL_Delay(10) per sensor */
+#ifndef TEMP_ACQ_CACHED
+#define TEMP_ACQ_CACHED 0
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+/* State of the Z axis controller, replaced as a whole by parse_z_frame() */
+typedef struct {
+#if Z_POSITION_TEXT
+    char position[32];   /* "p" as received, e.g. "12.500" */
+#endif
+    int32_t position_um; /* "p" in micrometres (12.500 -> 12500) */
+    uint8_t position_ok; /* 0: "p" missing, malformed or out of range */
+    uint8_t referenced;
+    uint8_t busy;
+    uint8_t back;
+    uint8_t front;
+    uint8_t speed;
+} RemoteState_t;
+
+/* Exported variables --------------------------------------------------------*/
+extern RemoteState_t      remoteState;
+extern TIM_HandleTypeDef  htim9;  /* 1 MHz counter for delay_us() */
+extern UART_HandleTypeDef huart2; /* log UART, TX owned by uart_log */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void   strip_T_after_chevron(char *buf, size_t buf_size);
+void   sanitize_command(char *cmd, size_t buf_size);
+size_t normalize_command(char *cmd, size_t buf_size);
+void   Print_Time(void);
+void   delay_us(uint16_t microseconds);
+void   measure_temperatures(uint8_t num, char *json_out, size_t out_size, uint8_t temp_sens_counter,
+                            uint8_t *temp_addresses);
+void   parse_z_frame(const char *frame);
+#if TEMP_ACQ_CACHED
+size_t measure_temperatures_cached(char *json_out, size_t out_size); /* 20_json_telemetry.c */
+#endif
+int    print_number_or_float(UART_HandleTypeDef *huart, float val, const char *label, int width, int prec,
+                             const char *suffix, char *out, size_t out_sz, int also_print);
+
+#endif /* HELP_FUNCTIONS_H */
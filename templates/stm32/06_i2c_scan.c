@@ -3,11 +3,17 @@
  */
 #include <stdio.h>
 #include "stm32xx_hal.h"
+#include "uart_log.h"
 
 I2C_HandleTypeDef hi2c1;
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef  hdma_usart2_tx;
 
-int __io_putchar(int ch){ HAL_UART_Transmit(&huart2,(uint8_t*)&ch,1,HAL_MAX_DELAY); return ch; }
+// printf goes through the buffered DMA logger (21_uart_log.c)
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_complete(); }
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_error(); }
+void DMA1_Stream6_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_usart2_tx); }
+void USART2_IRQHandler(void){ HAL_UART_IRQHandler(&huart2); }
 
 static void MX_I2C1_Init(void)
 {
@@ -34,6 +40,25 @@ static void MX_USART2_UART_Init(void)
   huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
   huart2.Init.OverSampling = UART_OVERSAMPLING_16;
   HAL_UART_Init(&huart2);
+
+  // log TX by DMA (21_uart_log.c); example (F4): USART2_TX = DMA1 stream 6 ch 4
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_usart2_tx.Instance = DMA1_Stream6;
+  hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+  hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+  hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+  HAL_DMA_Init(&hdma_usart2_tx);
+  __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);   // TC after the last byte: HAL_UART_TxCpltCallback
+  HAL_NVIC_EnableIRQ(USART2_IRQn);
 }
 
 void SystemClock_Config(void);
@@ -45,6 +70,7 @@ int main(void)
   SystemClock_Config();
   MX_GPIO_Init();
   MX_USART2_UART_Init();
+  uart_log_init(&huart2);
   MX_I2C1_Init();
 
   for(;;){
@@ -5,13 +5,14 @@
 #include <string.h>
 #include <stddef.h>
 
-void strip_T_after_chevron(char *buf)
+/* buf_size: size of buf; nothing past it is read, the result is always terminated */
+void strip_T_after_chevron(char *buf, size_t buf_size)
 {
-    // If buffer is at least 3 chars and buf[0]== '>' and buf[1] == 'T', remove that 'T'
-    if (!buf) return;
+    if (!buf || buf_size < 2) return;
     if (buf[0] == '>' && buf[1] == 'T') {
-        // Move tail (starting at buf[2]) one position to the left, including the terminator
-        size_t tail_len = strlen(buf + 2) + 1;
+        // Move tail (starting at buf[2]) one position to the left and terminate it
+        size_t tail_len = strnlen(buf + 2, buf_size - 2);
         memmove(&buf[1], &buf[2], tail_len);
+        buf[1 + tail_len] = '\0';
     }
 }
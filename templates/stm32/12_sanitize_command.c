@@ -11,10 +11,13 @@ void sanitize_command(char *cmd, size_t buf_size)
 {
     if (!cmd || buf_size==0) return;
 
-    // 1) Trim leading CR/LF
-    size_t skip = strspn(cmd, "\r\n");
+    // 1) Trim leading CR/LF, bounded by buf_size even without a terminator
+    size_t skip = 0;
+    while (skip < buf_size && (cmd[skip] == '\r' || cmd[skip] == '\n')) ++skip;
     if (skip) {
-        memmove(cmd, cmd + skip, strlen(cmd + skip) + 1);
+        size_t n = strnlen(cmd + skip, buf_size - skip);
+        memmove(cmd, cmd + skip, n);
+        cmd[n] = '\0'; // skip > 0, so n < buf_size
     }
 
     // 2) Check for Z# at the end and prepend '>' if missing
@@ -1,24 +1,55 @@
 /* Extracted from help_functions.c
  * Function: Print_Time()
- * Purpose: Read RTC (DS3231_get) and transmit formatted timestamp via UART DMA
+ * Purpose: Read RTC (DS3231_get) and transmit formatted timestamp via UART DMA.
+ *          Fixed layout "D:hhmmss_DDMMYY;" built from a two-digit lookup table,
+ *          queued in the UART logger, which owns the huart2 TX DMA.
  */
-#include <stdio.h>
-#include <string.h>
+#include <stdint.h>
 #include "stm32xx_hal.h" // replace as needed
+#include "uart_log.h"    // uart_log_write() from 21_uart_log.c
 
 // externs (provided by your project)
 // extern UART_HandleTypeDef huart2;
 // typedef struct { uint8_t hour,min,sec,mday,mon,year; } DS_TIME;
 // void DS3231_get(DS_TIME *t);
 
+#define TIME_STAMP_LEN 16u
+
+/* "00".."99", indexed by 2 * value */
+static const char two_digits[200] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static inline char *put_2digits(char *p, unsigned v)
+{
+    const char *d = &two_digits[2u * (v < 100u ? v : 99u)];
+    p[0] = d[0];
+    p[1] = d[1];
+    return p + 2;
+}
+
+/* Main loop only: time_buf is static and uart_log_write() copies it before
+ * returning, so no DMA ever reads a stack frame. Fields above 99 show as 99. */
 void Print_Time()
 {
+    static char time_buf[TIME_STAMP_LEN];
     DS_TIME new_get_time;
-    char time_buffer[50];
     DS3231_get(&new_get_time);
-    snprintf(time_buffer, sizeof(time_buffer),
-             "D:%02u%02u%02u_%02u%02u%02u;",
-             new_get_time.hour, new_get_time.min, new_get_time.sec,
-             new_get_time.mday, new_get_time.mon, new_get_time.year);
-    HAL_UART_Transmit_DMA(&huart2, (uint8_t *)time_buffer, strlen(time_buffer));
+
+    char *p = time_buf;
+    *p++ = 'D';
+    *p++ = ':';
+    p = put_2digits(p, new_get_time.hour);
+    p = put_2digits(p, new_get_time.min);
+    p = put_2digits(p, new_get_time.sec);
+    *p++ = '_';
+    p = put_2digits(p, new_get_time.mday);
+    p = put_2digits(p, new_get_time.mon);
+    p = put_2digits(p, new_get_time.year);
+    *p = ';';
+
+    uart_log_write(time_buf, TIME_STAMP_LEN);
 }
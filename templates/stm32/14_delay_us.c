@@ -8,15 +8,15 @@
 
 void delay_us(uint16_t microseconds)
 {
-    uint16_t startTick = __HAL_TIM_GET_COUNTER(&htim9);
-    uint16_t endTick   = (uint16_t)(startTick + microseconds) % (htim9.Init.Period + 1); /* Handle overflow */
+    uint32_t period  = htim9.Init.Period + 1u;
+    uint32_t last    = __HAL_TIM_GET_COUNTER(&htim9);
+    uint32_t elapsed = 0;
 
-    if (endTick < startTick) { /* Handle timer wraparound */
-        while (__HAL_TIM_GET_COUNTER(&htim9) >= startTick) {
-            /* Wait for counter to wrap around */
-        }
-    }
-    while (__HAL_TIM_GET_COUNTER(&htim9) < endTick) {
-        /* Wait until target tick is reached */
+    /* Sum the ticks between reads instead of computing an end tick: works for any
+     * Period, across wraps and for delays longer than one period */
+    while (elapsed < microseconds) {
+        uint32_t now = __HAL_TIM_GET_COUNTER(&htim9);
+        elapsed += (now + period - last) % period;
+        last = now;
     }
 }
@@ -6,6 +6,7 @@
 #include <string.h>
 #include <stdint.h>
 #include "stm32xx_hal.h" // replace with your series header
+#include "uart_log.h"    // uart_log_write() from 21_uart_log.c
 
 // externs/placeholders expected from the project environment
 // extern UART_HandleTypeDef huart2;
@@ -67,5 +68,5 @@ void measure_temperatures(uint8_t num, char *json_out, size_t out_size,
     strncpy(json_out, json_output, out_size - 1);
     json_out[out_size - 1] = '\0';
 
-    HAL_UART_Transmit_DMA(&huart2, (uint8_t *)json_out, strlen(json_out));
+    uart_log_write(json_out, strlen(json_out));   // logger owns the huart2 TX DMA
 }
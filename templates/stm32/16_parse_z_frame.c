@@ -1,14 +1,23 @@
 /* Extracted from help_functions.c
  * Function: parse_z_frame()
  * Purpose: Parse a JSON-like frame from USART and atomically update RemoteState_t.
+ *          Single pass over the frame; each "k": tag is dispatched on its key byte
+ *          through a jump table instead of one strstr() per field.
+ *          The position is decoded to micrometres ("12.500" -> 12500) with format
+ *          and range checks; the raw text is only kept if Z_POSITION_TEXT is 1.
  */
 #include <string.h>
 #include <stdint.h>
 #include <stddef.h>
 
-/* Placeholders you should adapt to your project */
+/* Placeholders you should adapt to your project (help_functions.h declares them) */
+// #define Z_POSITION_TEXT 1          // 0: drop the text copy of the position
 // typedef struct {
+// #if Z_POSITION_TEXT
 //   char     position[32];
+// #endif
+//   int32_t  position_um;
+//   uint8_t  position_ok;               // 0: "p" missing, malformed or out of range
 //   uint8_t  referenced;
 //   uint8_t  busy;
 //   uint8_t  back;
@@ -19,60 +28,139 @@
 // void __disable_irq(void);
 // void __enable_irq(void);
 
-void parse_z_frame(const char *frame)
+#ifndef Z_POS_MIN_UM
+#define Z_POS_MIN_UM (-100000000L)  /* -100 m, narrow to the axis travel */
+#endif
+#ifndef Z_POS_MAX_UM
+#define Z_POS_MAX_UM 100000000L
+#endif
+
+/* Field handler: parse value at 'val' into 'st', return where scanning continues */
+typedef const char *(*ZFieldHandler_t)(const char *val, RemoteState_t *st);
+
+static const char *z_skip_sep(const char *p)
 {
-    RemoteState_t tmp = {0};
+    while (*p == ' ' || *p == ':') ++p;
+    return p;
+}
+
+/* "[-+]mm[.ddd]" -> micrometres; a 4th decimal rounds, more are ignored.
+ * NULL if it is not a number or outside Z_POS_MIN_UM..Z_POS_MAX_UM */
+static const char *z_decode_um(const char *p, int32_t *um)
+{
+    uint8_t neg = 0;
+    int64_t v = 0;
+    uint32_t digits = 0, frac = 0;
 
-    /* p – Position ------------------------------------------------ */
-    const char *tag = strstr(frame, "\"p\":");
-    if (tag) {
-        tag += 3;
-        while (*tag == ' ' || *tag == ':') ++tag;
-        size_t n = 0;
-        while (*tag && *tag != ',' && *tag != '}' && n < sizeof tmp.position - 1) {
-            tmp.position[n++] = *tag++;
+    if (*p == '-' || *p == '+') neg = (*p++ == '-');
+    for (; *p >= '0' && *p <= '9'; ++p, ++digits) {
+        if (v > Z_POS_MAX_UM / 1000 - Z_POS_MIN_UM / 1000) return NULL;
+        v = v * 10 + (*p - '0');
+    }
+    if (*p == '.') {
+        for (++p; *p >= '0' && *p <= '9'; ++p, ++digits) {
+            if (frac < 3u) { v = v * 10 + (*p - '0'); ++frac; }
+            else if (frac == 3u) { v += (*p >= '5'); ++frac; }
         }
-        tmp.position[n] = '\0';
     }
+    if (digits == 0) return NULL;
+    for (; frac < 3u; ++frac) v *= 10;
+    if (neg) v = -v;
+    if (v < Z_POS_MIN_UM || v > Z_POS_MAX_UM) return NULL;
+    *um = (int32_t)v;
+    return p;
+}
 
-    /* r – Referenced --------------------------------------------- */
-    tag = strstr(frame, "\"r\":");
-    if (tag) {
-        tag += 3;
-        while (*tag == ' ' || *tag == ':') ++tag;
-        tmp.referenced = (*tag == '1');
+/* p – Position ------------------------------------------------ */
+static const char *z_field_position(const char *val, RemoteState_t *st)
+{
+    val = z_skip_sep(val);
+    const char *end = z_decode_um(val, &st->position_um);
+    st->position_ok = (end && (*end == ',' || *end == '}' || *end == ' ' || *end == '\0'));
+#if Z_POSITION_TEXT
+    size_t n = 0;
+    while (*val && *val != ',' && *val != '}' && n < sizeof st->position - 1) {
+        st->position[n++] = *val++;
     }
+    st->position[n] = '\0';
+#endif
+    return end ? end : val;
+}
 
-    /* b – Busy ---------------------------------------------------- */
-    tag = strstr(frame, "\"b\":");
-    if (tag) {
-        tag += 3;
-        while (*tag == ' ' || *tag == ':') ++tag;
-        tmp.busy = (*tag == '1');
-    }
+/* r – Referenced --------------------------------------------- */
+static const char *z_field_referenced(const char *val, RemoteState_t *st)
+{
+    val = z_skip_sep(val);
+    st->referenced = (*val == '1');
+    return val;
+}
 
-    /* o – Back-Switch -------------------------------------------- */
-    tag = strstr(frame, "\"o\":");
-    if (tag) {
-        tag += 3;
-        while (*tag == ' ' || *tag == ':') ++tag;
-        tmp.back = (*tag == '1');
-    }
+/* b – Busy ---------------------------------------------------- */
+static const char *z_field_busy(const char *val, RemoteState_t *st)
+{
+    val = z_skip_sep(val);
+    st->busy = (*val == '1');
+    return val;
+}
+
+/* o – Back-Switch -------------------------------------------- */
+static const char *z_field_back(const char *val, RemoteState_t *st)
+{
+    val = z_skip_sep(val);
+    st->back = (*val == '1');
+    return val;
+}
 
-    /* u – Front-Switch ------------------------------------------- */
-    tag = strstr(frame, "\"u\":");
-    if (tag) {
-        tag += 3;
-        while (*tag == ' ' || *tag == ':') ++tag;
-        tmp.front = (*tag == '1');
+/* u – Front-Switch ------------------------------------------- */
+static const char *z_field_front(const char *val, RemoteState_t *st)
+{
+    val = z_skip_sep(val);
+    st->front = (*val == '1');
+    return val;
+}
+
+/* v – Speed (truncated to 8 bit like the former strtoul cast) - */
+static const char *z_field_speed(const char *val, RemoteState_t *st)
+{
+    val = z_skip_sep(val);
+    uint32_t v = 0;
+    while (*val >= '0' && *val <= '9') {
+        v = v * 10u + (uint32_t)(*val++ - '0');
     }
+    st->speed = (uint8_t)v;
+    return val;
+}
+
+void parse_z_frame(const char *frame)
+{
+    /* Jump table indexed by the key byte ('a'..'z') */
+    static const ZFieldHandler_t z_field_table[26] = {
+        ['p' - 'a'] = z_field_position,
+        ['r' - 'a'] = z_field_referenced,
+        ['b' - 'a'] = z_field_busy,
+        ['o' - 'a'] = z_field_back,
+        ['u' - 'a'] = z_field_front,
+        ['v' - 'a'] = z_field_speed,
+    };
 
-    /* v – Speed --------------------------------------------------- */
-    tag = strstr(frame, "\"v\":");
-    if (tag) {
-        tag += 3;
-        while (*tag == ' ' || *tag == ':') ++tag;
-        tmp.speed = (uint8_t)strtoul(tag, NULL, 10);
+    RemoteState_t tmp = {0};
+    uint32_t seen = 0;          /* first occurrence of a key wins */
+    const char *s = frame;
+
+    while (*s) {
+        /* '"' key '"' ':' – short-circuit stops at the terminator */
+        if (s[0] == '"' && s[1] >= 'a' && s[1] <= 'z' && s[2] == '"' && s[3] == ':') {
+            uint8_t idx = (uint8_t)(s[1] - 'a');
+            ZFieldHandler_t handler = z_field_table[idx];
+            if (handler && !(seen & (1UL << idx))) {
+                seen |= 1UL << idx;
+                s = handler(s + 3, &tmp);
+            } else {
+                s += 3;
+            }
+            continue;
+        }
+        ++s;
     }
 
     /* atomar übernehmen ------------------------------------------ */
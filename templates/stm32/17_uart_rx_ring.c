@@ -0,0 +1,233 @@
+/* STM32 HAL template: lock-free SPSC ring for UART DMA reception
+ * Practice: circular DMA + ReceiveToIdle, in-place frame delimiting, zero-copy views.
+ *
+ * Producer: HAL_UARTEx_RxEventCallback (DMA half/full transfer and idle line).
+ *           It scans only the newly received bytes and queues one descriptor per
+ *           '#'-terminated command or '}'-terminated Z frame. A binary frame of
+ *           33_telemetry_frame.c (0xA5, never part of the ASCII text) is taken by
+ *           its length byte instead, so payload bytes equal to '#' or '}' do not
+ *           split it.
+ * Consumer: main loop; rx_ring_peek() hands out a view of up to two segments
+ *           (the second one is used when a frame wraps the end of the buffer),
+ *           rx_ring_release() drops the oldest frame. DMA cannot be held back:
+ *           both compare the frame against the DMA write position (from NDTR),
+ *           so a frame the DMA has lapped, before peek or while the consumer
+ *           still read it, is counted in lapped and must be discarded.
+ * Single core: volatile indices plus __DMB() are the only synchronisation.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32xx_hal.h" // replace with your series header
+
+/* Placeholders you should adapt to your project */
+// extern UART_HandleTypeDef huart6;   // RX DMA configured with DMA_CIRCULAR
+// void parse_z_frame(const char *frame);                                       // help_functions.c
+// CmdStatus_t cmd_dispatch(const char *cmd, size_t len);                        // 29_cmd_dispatch.c
+// TlmParse_t tlm_parse(const uint8_t *buf, size_t n, TlmFrame_t *f, size_t *used); // 33_telemetry_frame.c
+// bool tlm_decode_z(const TlmFrame_t *f);                                      // 33_telemetry_frame.c
+
+#define RX_RING_SIZE   256u  /* DMA buffer, power of two */
+#define RX_FRAME_QLEN  8u    /* pending frame descriptors, power of two */
+#define RX_CMD_MAX     32u   /* longest command rx_poll() accepts, incl. NUL */
+
+/* Binary frame of 33_telemetry_frame.c: sync | version | type | len | payload[len] | crc16 */
+#define RX_BIN_SYNC    0xA5u /* TLM_SYNC */
+#define RX_BIN_HDR     4u    /* TLM_HDR_LEN, len is its last byte */
+#define RX_BIN_MAX     64u   /* TLM_MAX_PAYLOAD */
+
+typedef enum { RX_FRAME_CMD = '#', RX_FRAME_Z = '}', RX_FRAME_BIN = RX_BIN_SYNC } RxFrameType_t;
+
+typedef struct {
+    const uint8_t *seg[2];   /* seg[1] is only used on wrap-around */
+    uint16_t       len[2];
+    RxFrameType_t  type;
+    uint32_t       start;    /* free-running offset, for the lap check */
+} RxView_t;
+
+/* 18_normalize_command.c: normalizes a command straight out of a view */
+size_t normalize_command_from_view(const RxView_t *v, char *out, size_t out_size);
+
+typedef struct {
+    uint8_t           buf[RX_RING_SIZE];     /* written by DMA only */
+    UART_HandleTypeDef *huart;               /* its hdmarx NDTR gives the DMA position */
+    volatile uint32_t head;                  /* free-running: bytes scanned (producer) */
+    uint32_t          frame_start;           /* producer private */
+    uint32_t          bin_left;              /* producer private: bytes missing of a binary frame */
+    uint32_t          q_start[RX_FRAME_QLEN];
+    uint32_t          q_end[RX_FRAME_QLEN];
+    uint8_t           q_type[RX_FRAME_QLEN];
+    volatile uint32_t q_head;                /* producer */
+    volatile uint32_t q_tail;                /* consumer */
+    volatile uint32_t overruns;              /* producer: frames dropped */
+    volatile uint32_t lapped;                /* consumer: frames overwritten by DMA */
+    volatile uint32_t too_long;              /* consumer: frames larger than rx_poll()'s buffers */
+    volatile uint32_t bin_errors;            /* consumer: binary frames tlm_parse() refused */
+} RxRing_t;
+
+static RxRing_t rx;
+
+void rx_ring_start(UART_HandleTypeDef *huart)
+{
+    memset(&rx, 0, sizeof rx);
+    rx.huart = huart;
+    HAL_UARTEx_ReceiveToIdle_DMA(huart, rx.buf, RX_RING_SIZE);
+    /* Half-transfer stays enabled: it bounds the work per callback to RX_RING_SIZE/2 */
+}
+
+/* Producer ------------------------------------------------------------------ */
+static void rx_ring_push(uint32_t end, uint8_t type)
+{
+    uint32_t qh = rx.q_head;
+    if (qh - rx.q_tail >= RX_FRAME_QLEN || end - rx.frame_start >= RX_RING_SIZE) {
+        rx.overruns++;                       /* queue full or frame longer than the ring */
+    } else {
+        rx.q_start[qh & (RX_FRAME_QLEN - 1u)] = rx.frame_start;
+        rx.q_end[qh & (RX_FRAME_QLEN - 1u)]   = end;
+        rx.q_type[qh & (RX_FRAME_QLEN - 1u)]  = type;
+        __DMB();                             /* descriptor visible before the index */
+        rx.q_head = qh + 1u;
+    }
+    rx.frame_start = end;
+}
+
+/* Size = current DMA write position inside buf (HT, TC or idle line) */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    if (huart->Instance != USART6) return;
+
+    uint32_t h   = rx.head;
+    uint32_t pos = Size & (RX_RING_SIZE - 1u);
+    uint32_t n   = (pos - h) & (RX_RING_SIZE - 1u);
+
+    while (n--) {
+        uint8_t c = rx.buf[h & (RX_RING_SIZE - 1u)];
+        ++h;
+        if (rx.bin_left) {
+            /* Length byte: payload and CRC follow; a bad one ends the frame here
+             * and tlm_parse() refuses it */
+            if (h - rx.frame_start == RX_BIN_HDR) rx.bin_left = c <= RX_BIN_MAX ? c + 3u : 1u;
+            if (--rx.bin_left == 0u) rx_ring_push(h, RX_FRAME_BIN);
+        } else if (c == RX_BIN_SYNC) {
+            rx.frame_start = h - 1u;         /* undelimited text before it is dropped */
+            rx.bin_left = RX_BIN_HDR - 1u;
+        } else if (c == '#' || c == '}') {
+            rx_ring_push(h, c);
+        }
+    }
+    __DMB();
+    rx.head = h;
+}
+
+/* Consumer ------------------------------------------------------------------ */
+/* Free-running count of bytes the DMA has written: the scanned head plus what
+ * NDTR says lies beyond it. Retried if the callback moved head meanwhile. */
+static uint32_t rx_dma_written(void)
+{
+    uint32_t h, pos;
+    do {
+        h   = rx.head;
+        pos = RX_RING_SIZE - __HAL_DMA_GET_COUNTER(rx.huart->hdmarx);
+        __DMB();
+    } while (h != rx.head);
+    return h + ((pos - h) & (RX_RING_SIZE - 1u));
+}
+
+/* The byte at start is intact while the DMA, one byte possibly in flight, has
+ * not come round to it again */
+static inline bool rx_intact(uint32_t start)
+{
+    return rx_dma_written() - start < RX_RING_SIZE;
+}
+
+bool rx_ring_peek(RxView_t *v)
+{
+    while (rx.q_tail != rx.q_head) {
+        __DMB();                             /* index read before the descriptor */
+        uint32_t qt    = rx.q_tail & (RX_FRAME_QLEN - 1u);
+        uint32_t start = rx.q_start[qt];
+        uint32_t len   = rx.q_end[qt] - start;
+
+        if (!rx_intact(start)) {
+            /* DMA has lapped this frame before we got to it */
+            rx.lapped++;
+            rx.q_tail = rx.q_tail + 1u;
+            continue;
+        }
+
+        uint32_t idx   = start & (RX_RING_SIZE - 1u);
+        uint32_t first = RX_RING_SIZE - idx;
+        if (first > len) first = len;
+
+        v->seg[0] = &rx.buf[idx];
+        v->len[0] = (uint16_t)first;
+        v->seg[1] = rx.buf;
+        v->len[1] = (uint16_t)(len - first);
+        v->type   = (RxFrameType_t)rx.q_type[qt];
+        v->start  = start;
+        return true;
+    }
+    return false;
+}
+
+/* Drops the peeked frame. False if the DMA overwrote it while it was held:
+ * whatever the consumer read or copied from the view is then garbage. */
+bool rx_ring_release(const RxView_t *v)
+{
+    __DMB();                                 /* finish reading before the check */
+    bool ok = rx_intact(v->start);
+    if (!ok) rx.lapped++;
+    rx.q_tail = rx.q_tail + 1u;
+    return ok;
+}
+
+/* Byte i of a view, wrap handled */
+static inline uint8_t rx_view_at(const RxView_t *v, uint32_t i)
+{
+    return (i < v->len[0]) ? v->seg[0][i] : v->seg[1][i - v->len[0]];
+}
+
+/* Flatten a view for legacy NUL-terminated helpers; returns copied length */
+size_t rx_view_copy(const RxView_t *v, char *dst, size_t dst_size)
+{
+    if (!dst || dst_size == 0) return 0;
+    size_t n0 = v->len[0] < dst_size - 1 ? v->len[0] : dst_size - 1;
+    size_t n1 = v->len[1] < dst_size - 1 - n0 ? v->len[1] : dst_size - 1 - n0;
+    memcpy(dst, v->seg[0], n0);
+    memcpy(dst + n0, v->seg[1], n1);
+    dst[n0 + n1] = '\0';
+    return n0 + n1;
+}
+
+/* Example main-loop consumer: copy out, release, act only on intact frames */
+void rx_poll(void)
+{
+    RxView_t v;
+    while (rx_ring_peek(&v)) {
+        size_t len = (size_t)v.len[0] + v.len[1];
+        if (v.type == RX_FRAME_Z) {
+            char frame[RX_RING_SIZE / 2];
+            rx_view_copy(&v, frame, sizeof frame);
+            if (rx_ring_release(&v)) {
+                if (len < sizeof frame) parse_z_frame(frame);
+                else rx.too_long++;          /* never parse a cut frame */
+            }
+        } else if (v.type == RX_FRAME_BIN) {
+            char frame[RX_BIN_HDR + RX_BIN_MAX + 3u];   /* the producer never makes it longer */
+            rx_view_copy(&v, frame, sizeof frame);
+            if (rx_ring_release(&v)) {
+                TlmFrame_t f;
+                size_t used;
+                if (tlm_parse((const uint8_t *)frame, len, &f, &used) == TLM_FRAME_OK && used == len) tlm_decode_z(&f);
+                else rx.bin_errors++;
+            }
+        } else {
+            char cmd[RX_CMD_MAX];
+            size_t n = normalize_command_from_view(&v, cmd, sizeof cmd);
+            if (rx_ring_release(&v)) {
+                if (len < sizeof cmd) cmd_dispatch(cmd, n);
+                else rx.too_long++;
+            }
+        }
+    }
+}
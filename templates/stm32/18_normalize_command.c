@@ -0,0 +1,102 @@
+/* Extracted from help_functions.c
+ * Function: normalize_command()
+ * Purpose: Fused sanitize_command() + strip_T_after_chevron():
+ *   1) Remove leading CR/LF
+ *   2) If it then ends with "Z#" and doesn't start with '>', prepend '>'
+ *   3) Drop a 'T' right after the leading '>' (">TMA090.000#" -> ">MA090.000#")
+ *   The final layout is computed first and the payload is written once.
+ */
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/* From 17_uart_rx_ring.c when normalizing straight out of the RX ring */
+// typedef struct {
+//   const uint8_t *seg[2];
+//   uint16_t       len[2];
+//   RxFrameType_t  type;
+//   uint32_t       start;
+// } RxView_t;
+
+size_t normalize_command(char *cmd, size_t buf_size)
+{
+    if (!cmd || buf_size == 0) return 0;
+
+    // Leading CR/LF and length, never past buf_size - 1
+    size_t skip = 0;
+    while (skip < buf_size - 1 && (cmd[skip] == '\r' || cmd[skip] == '\n')) ++skip;
+    const char *src = cmd + skip;
+    size_t len = strnlen(src, buf_size - 1 - skip);
+
+    // Final layout: optional '>' followed by src[from..len)
+    int lead = 0;
+    size_t from = 0;
+    if (len >= 2 && src[len - 1] == '#' && src[len - 2] == 'Z' && src[0] != '>' && len + 1 < buf_size) {
+        lead = 1;
+        from = (src[0] == 'T') ? 1 : 0;
+    } else if (len >= 2 && src[0] == '>' && src[1] == 'T') {
+        lead = 1;
+        from = 2;
+    }
+
+    size_t n = len - from;
+    char *dst = cmd + lead;
+    if (dst != src + from) {
+        memmove(dst, src + from, n);
+    }
+    dst[n] = '\0';
+    if (lead) cmd[0] = '>';
+    return n + (size_t)lead;
+}
+
+/* Byte i of a (possibly wrapped) ring view */
+static inline char view_at(const RxView_t *v, size_t i)
+{
+    return (char)((i < v->len[0]) ? v->seg[0][i] : v->seg[1][i - v->len[0]]);
+}
+
+/* Copy view bytes [off, off+n) to dst, at most two memcpy */
+static void view_copy_range(const RxView_t *v, size_t off, size_t n, char *dst)
+{
+    if (off < v->len[0]) {
+        size_t a = v->len[0] - off;
+        if (a > n) a = n;
+        memcpy(dst, v->seg[0] + off, a);
+        dst += a; n -= a; off = 0;
+    } else {
+        off -= v->len[0];
+    }
+    memcpy(dst, v->seg[1] + off, n);
+}
+
+/* Same as copying the view into out (truncated to out_size - 1) and then calling
+ * normalize_command(), but every output byte is written exactly once. */
+size_t normalize_command_from_view(const RxView_t *v, char *out, size_t out_size)
+{
+    if (!v || !out || out_size == 0) return 0;
+
+    size_t total = (size_t)v->len[0] + v->len[1];
+    if (total > out_size - 1) total = out_size - 1;
+
+    size_t skip = 0;
+    while (skip < total && (view_at(v, skip) == '\r' || view_at(v, skip) == '\n')) ++skip;
+    size_t len = total - skip;
+    char c0 = len ? view_at(v, skip) : '\0';
+    char c1 = len > 1 ? view_at(v, skip + 1) : '\0';
+
+    int lead = 0;
+    size_t from = 0;
+    if (len >= 2 && view_at(v, total - 1) == '#' && view_at(v, total - 2) == 'Z' && c0 != '>' && len + 1 < out_size) {
+        lead = 1;
+        from = (c0 == 'T') ? 1 : 0;
+    } else if (len >= 2 && c0 == '>' && c1 == 'T') {
+        lead = 1;
+        from = 2;
+    }
+
+    size_t n = len - from;
+    if (lead) out[0] = '>';
+    view_copy_range(v, skip + from, n, out + lead);
+    out[lead + n] = '\0';
+    return n + (size_t)lead;
+}
@@ -0,0 +1,153 @@
+/* STM32 HAL template: non-blocking TMP1075 acquisition
+ * Practice: interrupt-driven I2C reads, tick-based state machine, double-buffered results.
+ *
+ * Replaces the blocking TMP1075_Get_Temperature_Celsius() + HAL_Delay(10) loop of
+ * measure_temperatures(): temp_acq_poll() is called from the main loop, each sensor
+ * is read with HAL_I2C_Mem_Read_IT and the completion callback advances the round.
+ * A finished round is published by flipping a sequence counter, so readers always
+ * copy a consistent snapshot and never touch the bus.
+ * measure_temperatures_cached() in 20_json_telemetry.c builds the JSON from it.
+ */
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32xx_hal.h" // replace with your series header
+
+/* Placeholders you should adapt to your project */
+// extern I2C_HandleTypeDef hi2c1;
+
+#define TEMP_ACQ_MAX        8u    /* TMP1075: 0x48..0x4F */
+#define TEMP_ACQ_PERIOD_MS  250u  /* start of one round to the next */
+#define TEMP_ACQ_GAP_MS     10u   /* pause between sensors (was HAL_Delay(10)) */
+#define TMP1075_REG_TEMP    0x00u
+
+/* 1: this file defines HAL_I2C_MemRxCpltCallback and HAL_I2C_ErrorCallback.
+ * 0: another module owns them and forwards to temp_acq_i2c_rx_done() and
+ * temp_acq_i2c_error(), e.g. 23_i2c_scan_async.c on the same hi2c1 */
+#ifndef TEMP_ACQ_I2C_CALLBACKS
+#define TEMP_ACQ_I2C_CALLBACKS 1
+#endif
+
+typedef struct {
+    uint32_t tick;                 /* HAL_GetTick() when the round completed */
+    uint8_t  count;
+    uint8_t  valid;                /* bit i set when sensor i answered */
+    uint8_t  addr[TEMP_ACQ_MAX];
+    int16_t  raw[TEMP_ACQ_MAX];    /* 1/16 degC (12-bit, left-justified >> 4) */
+} TempSnapshot_t;
+
+typedef enum { TACQ_IDLE, TACQ_BUSY, TACQ_GAP } TempAcqState_t;
+
+static struct {
+    I2C_HandleTypeDef       *hi2c;
+    TempSnapshot_t           snap[2];   /* snap[seq & 1] is published */
+    volatile uint32_t        seq;       /* 0 = nothing published yet */
+    volatile TempAcqState_t  state;
+    volatile uint32_t        t_mark;    /* round start (IDLE) or last completion (GAP) */
+    uint32_t                 round_start;
+    uint8_t                  idx;
+    uint8_t                  rx[2];
+    uint8_t                  addr[TEMP_ACQ_MAX];
+    uint8_t                  count;
+} tacq;
+
+void temp_acq_init(I2C_HandleTypeDef *hi2c, const uint8_t *addresses, uint8_t count)
+{
+    memset(&tacq, 0, sizeof tacq);
+    tacq.hi2c  = hi2c;
+    tacq.count = count > TEMP_ACQ_MAX ? TEMP_ACQ_MAX : count;
+    memcpy(tacq.addr, addresses, tacq.count);
+    tacq.t_mark = HAL_GetTick() - TEMP_ACQ_PERIOD_MS;   /* first round starts immediately */
+}
+
+static TempSnapshot_t *temp_acq_back(void)
+{
+    return &tacq.snap[(tacq.seq + 1u) & 1u];
+}
+
+/* Called from the I2C callbacks: store result, go to the next sensor or publish */
+static void temp_acq_finish(bool ok)
+{
+    TempSnapshot_t *b = temp_acq_back();
+    uint8_t i = tacq.idx;
+
+    b->addr[i] = tacq.addr[i];
+    if (ok) {
+        b->raw[i] = (int16_t)((uint16_t)(tacq.rx[0] << 8) | tacq.rx[1]) >> 4;
+        b->valid |= (uint8_t)(1u << i);
+    }
+
+    tacq.t_mark = HAL_GetTick();
+    if (++tacq.idx >= tacq.count) {
+        b->count = tacq.count;
+        b->tick  = tacq.t_mark;
+        __DMB();
+        tacq.seq = tacq.seq + 1u;       /* publish: back becomes front */
+        tacq.t_mark = tacq.round_start;
+        tacq.state = TACQ_IDLE;
+    } else {
+        tacq.state = TACQ_GAP;
+    }
+}
+
+static void temp_acq_start_read(void)
+{
+    tacq.state = TACQ_BUSY;
+    if (HAL_I2C_Mem_Read_IT(tacq.hi2c, (uint16_t)(tacq.addr[tacq.idx] << 1), TMP1075_REG_TEMP,
+                            I2C_MEMADD_SIZE_8BIT, tacq.rx, sizeof tacq.rx) != HAL_OK) {
+        temp_acq_finish(false);   /* bus busy: same path as a failed read */
+    }
+}
+
+/* I2C completions; both ignore anything but our own running read */
+void temp_acq_i2c_rx_done(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c == tacq.hi2c && tacq.state == TACQ_BUSY) temp_acq_finish(true);
+}
+
+void temp_acq_i2c_error(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c == tacq.hi2c && tacq.state == TACQ_BUSY) temp_acq_finish(false);
+}
+
+#if TEMP_ACQ_I2C_CALLBACKS
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) { temp_acq_i2c_rx_done(hi2c); }
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) { temp_acq_i2c_error(hi2c); }
+#endif
+
+/* Main loop: never blocks, only starts the next transfer when it is due */
+void temp_acq_poll(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    switch (tacq.state) {
+        case TACQ_IDLE:
+            if (tacq.count && now - tacq.t_mark >= TEMP_ACQ_PERIOD_MS) {
+                TempSnapshot_t *b = temp_acq_back();
+                b->valid = 0;
+                tacq.round_start = now;
+                tacq.idx = 0;
+                temp_acq_start_read();
+            }
+            break;
+        case TACQ_GAP:
+            if (now - tacq.t_mark >= TEMP_ACQ_GAP_MS) temp_acq_start_read();
+            break;
+        case TACQ_BUSY:
+        default:
+            break;
+    }
+}
+
+/* Copy the latest complete round; false until the first round is done */
+bool temp_acq_latest(TempSnapshot_t *out)
+{
+    uint32_t s;
+    do {
+        s = tacq.seq;
+        __DMB();
+        *out = tacq.snap[s & 1u];
+        __DMB();
+    } while (s != tacq.seq);          /* a newer round was published meanwhile */
+    return s != 0;
+}
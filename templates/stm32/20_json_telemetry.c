@@ -0,0 +1,179 @@
+/* STM32 HAL template: allocation-free JSON telemetry encoder
+ * Practice: streaming writer with overflow flag, fixed-point numbers, one TX owner per UART.
+ *
+ * Replaces print_number_or_float() + snprintf() + strncpy() in measure_temperatures():
+ * numbers are formatted with integer math only, the sensor keys are precomputed
+ * (quotes and colon included) and the document is written into one scratch
+ * buffer that the UART logger copies and sends by DMA.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "stm32xx_hal.h" // replace with your series header
+#include "uart_log.h"    // uart_log_write() from 21_uart_log.c
+
+/* Placeholders you should adapt to your project */
+// TempSnapshot_t / temp_acq_latest() from 19_temp_acquisition.c
+// tlm_format() / tlm_frame_temperatures() from 33_telemetry_frame.c
+
+#define TLM_TX_SIZE  256u   /* at most UART_LOG_BUF_SIZE: the logger sends it unsplit */
+
+typedef struct {
+    char  *buf;
+    size_t cap;
+    size_t len;
+    bool   overflow;   /* sticky: set once anything did not fit */
+} JsonWriter_t;
+
+void jw_init(JsonWriter_t *w, char *buf, size_t cap)
+{
+    w->buf = buf;
+    w->cap = cap;
+    w->len = 0;
+    w->overflow = (buf == NULL || cap == 0);
+}
+
+static void jw_raw(JsonWriter_t *w, const char *s, size_t n)
+{
+    if (w->overflow || n > w->cap - w->len) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static inline void jw_char(JsonWriter_t *w, char c)
+{
+    jw_raw(w, &c, 1);
+}
+
+/* Unsigned decimal, digits produced backwards into a small scratch */
+void jw_u32(JsonWriter_t *w, uint32_t v)
+{
+    char tmp[10];
+    size_t i = sizeof tmp;
+    do {
+        tmp[--i] = (char)('0' + v % 10u);
+        v /= 10u;
+    } while (v);
+    jw_raw(w, &tmp[i], sizeof tmp - i);
+}
+
+/* Fixed-point: value = scaled / 10^decimals, e.g. (-55, 1) -> "-5.5" */
+void jw_fixed(JsonWriter_t *w, int32_t scaled, uint8_t decimals)
+{
+    static const uint32_t pow10[] = {1u, 10u, 100u, 1000u, 10000u, 100000u};
+    if (decimals >= sizeof pow10 / sizeof pow10[0]) decimals = 5;
+
+    uint32_t mag = (scaled < 0) ? 0u - (uint32_t)scaled : (uint32_t)scaled;
+    if (scaled < 0) jw_char(w, '-');
+    jw_u32(w, mag / pow10[decimals]);
+    if (decimals) {
+        char frac[5];
+        uint32_t f = mag % pow10[decimals];
+        for (uint8_t i = decimals; i > 0; --i) {
+            frac[i - 1] = (char)('0' + f % 10u);
+            f /= 10u;
+        }
+        jw_char(w, '.');
+        jw_raw(w, frac, decimals);
+    }
+}
+
+/* Precomputed keys for the known TMP1075 addresses */
+#define TLM_KEY(a, s) { (a), "\"" s "\":", sizeof("\"" s "\":") - 1u }
+static const struct {
+    uint8_t     addr;
+    const char *key;
+    uint8_t     len;
+} tlm_keys[] = {
+    TLM_KEY(73, "temp_system"),
+    TLM_KEY(72, "temp_drivers"),
+    TLM_KEY(75, "temp_motor_x"),
+    TLM_KEY(79, "temp_motor_y"),
+};
+
+static void jw_sensor_key(JsonWriter_t *w, uint8_t addr)
+{
+    for (size_t k = 0; k < sizeof tlm_keys / sizeof tlm_keys[0]; ++k) {
+        if (tlm_keys[k].addr == addr) {
+            jw_raw(w, tlm_keys[k].key, tlm_keys[k].len);
+            return;
+        }
+    }
+    jw_char(w, '"');                 /* unknown sensor: raw address as key */
+    jw_u32(w, addr);
+    jw_raw(w, "\":", 2);
+}
+
+/* 1/16 degC -> tenths, rounded half away from zero */
+static inline int32_t tlm_raw16_to_tenths(int16_t raw)
+{
+    int32_t t = (int32_t)raw * 10;
+    return (t >= 0 ? t + 8 : t - 8) / 16;
+}
+
+/* {"temp_system":24.5,...}\r\n ; returns length, 0 on overflow */
+size_t tlm_encode_temperatures(JsonWriter_t *w, const TempSnapshot_t *s)
+{
+    bool first = true;
+    jw_char(w, '{');
+    for (uint8_t j = 0; j < s->count; ++j) {
+        if (!(s->valid & (1u << j))) continue;
+        if (!first) jw_char(w, ',');
+        first = false;
+        jw_sensor_key(w, s->addr[j]);
+        jw_fixed(w, tlm_raw16_to_tenths(s->raw[j]), 1);
+    }
+    jw_raw(w, "}\r\n", 3);
+    return w->overflow ? 0 : w->len;
+}
+
+/* measure_temperatures() from the values cached by 19_temp_acquisition.c: no bus
+ * traffic, no HAL_Delay, no float, the same document as the telemetry. Returns
+ * its length, or 0 with an empty string when no round is published yet or it
+ * does not fit: never a cut document. */
+size_t measure_temperatures_cached(char *json_out, size_t out_size)
+{
+    if (!json_out || out_size == 0) return 0;
+
+    TempSnapshot_t s;
+    json_out[0] = '\0';
+    if (!temp_acq_latest(&s)) return 0;
+
+    JsonWriter_t w;
+    jw_init(&w, json_out, out_size - 1);   /* keep room for the terminator */
+    size_t n = tlm_encode_temperatures(&w, &s);
+    json_out[n] = '\0';
+    return n;
+}
+
+/* Sending ------------------------------------------------------------------- */
+/* The document is encoded into a scratch buffer and copied into the UART logger
+ * (21_uart_log.c), which owns the TX DMA and queues it behind pending log output. */
+static char              tlm_tx[TLM_TX_SIZE];
+static volatile uint32_t tlm_dropped;
+
+/* Encode the latest snapshot and send it, as JSON or as a binary frame once
+ * the host negotiated one; main loop only */
+bool measure_temperatures_send(void)
+{
+    TempSnapshot_t s;
+    if (!temp_acq_latest(&s)) return false;
+
+    size_t n;
+    if (tlm_format() == TLM_FMT_BINARY) {
+        n = tlm_frame_temperatures((uint8_t *)tlm_tx, sizeof tlm_tx, &s);
+    } else {
+        JsonWriter_t w;
+        jw_init(&w, tlm_tx, sizeof tlm_tx);
+        n = tlm_encode_temperatures(&w, &s);
+    }
+    if (n == 0 || !uart_log_write(tlm_tx, (uint32_t)n)) {   /* never send a cut document */
+        tlm_dropped++;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,173 @@
+/* STM32 HAL template: buffered, DMA-backed printf retarget
+ * Practice: double-buffered TX, flush on newline/full, overflow policy.
+ *
+ * Drop-in replacement for the per-template
+ *   int __io_putchar(int ch){ HAL_UART_Transmit(&huart2,(uint8_t*)&ch,1,HAL_MAX_DELAY); ... }
+ * printf() only copies into the fill buffer; a '\n' or a full buffer hands it to
+ * UART DMA and switches to the other buffer. The caller waits only when both
+ * buffers are in use and UART_LOG_POLICY is UART_LOG_BLOCK.
+ * Needs a TX DMA stream linked to the UART (CubeMX: USARTx_TX, normal mode)
+ * and both the DMA stream and the UART interrupt enabled: the DMA TC starts the
+ * UART TC interrupt, which calls HAL_UART_TxCpltCallback. The templates do
+ * this in MX_USART2_UART_Init() (F4: DMA1 stream 6 channel 4).
+ * The logger is the only user of that DMA stream: telemetry (20_json_telemetry.c)
+ * and Print_Time() hand their bytes to uart_log_write() instead of starting
+ * transfers of their own, so nobody waits for a completion that went elsewhere.
+ *
+ * API in uart_log.h. Both TX hooks must be wired: uart_log_tx_complete() from
+ * HAL_UART_TxCpltCallback and uart_log_tx_error() from HAL_UART_ErrorCallback.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32xx_hal.h" // replace with your series header
+#include "uart_log.h"
+
+#define UART_LOG_DROP   0   /* discard bytes while both buffers are busy */
+#define UART_LOG_BLOCK  1   /* wait for the running transfer to finish */
+
+#ifndef UART_LOG_POLICY
+#define UART_LOG_POLICY UART_LOG_DROP
+#endif
+#ifndef UART_LOG_BUF_SIZE
+#define UART_LOG_BUF_SIZE 256u
+#endif
+
+static UART_HandleTypeDef *log_huart;
+static char                log_buf[2][UART_LOG_BUF_SIZE];
+static volatile uint16_t   log_len[2];
+static volatile uint8_t    log_fill;            /* buffer printf writes into */
+static volatile uint8_t    log_dma_busy;        /* other buffer is on the wire */
+static volatile uint8_t    log_flush_pending;   /* '\n' seen while DMA was busy or refused */
+static volatile uint32_t   log_dropped;
+
+void uart_log_init(UART_HandleTypeDef *huart)
+{
+    log_huart = huart;
+    log_len[0] = log_len[1] = 0;
+    log_fill = 0;
+    log_dma_busy = 0;
+    log_flush_pending = 0;
+}
+
+/* IRQs disabled: send the fill buffer and switch to the other one.
+ * log_dma_busy is only cleared by the TX complete/error hooks, never from gState:
+ * HAL sets READY before it calls HAL_UART_TxCpltCallback, so a higher-priority
+ * ISR logging in between would start the next buffer and the late callback
+ * would then send it again. */
+static void uart_log_kick(void)
+{
+    uint8_t f = log_fill;
+    if (log_len[f] == 0 || log_dma_busy) return;
+
+    log_dma_busy = 1;
+    if (HAL_UART_Transmit_DMA(log_huart, (uint8_t *)log_buf[f], log_len[f]) != HAL_OK) {
+        log_dma_busy = 0;              /* UART taken by someone else: keep the data */
+        log_flush_pending = 1;         /* and retry from the next TX complete */
+        return;
+    }
+    log_flush_pending = 0;
+    log_fill = f ^ 1u;
+    log_len[f ^ 1u] = 0;
+}
+
+int __io_putchar(int ch)
+{
+    for (;;) {
+        __disable_irq();
+        uint8_t f = log_fill;
+        if (log_len[f] < UART_LOG_BUF_SIZE) {
+            log_buf[f][log_len[f]] = (char)ch;
+            log_len[f] = log_len[f] + 1u;
+            if (ch == '\n') {
+                if (log_dma_busy) log_flush_pending = 1;
+                else uart_log_kick();
+            }
+            __enable_irq();
+            return ch;
+        }
+        /* fill buffer full */
+        uart_log_kick();
+        uint8_t stuck = (log_fill == f);
+        __enable_irq();
+        if (!stuck) continue;          /* switched buffers, retry */
+
+#if UART_LOG_POLICY == UART_LOG_DROP
+        log_dropped++;
+        return ch;
+#else
+        while (log_fill == f && log_dma_busy) { }   /* switched by uart_log_tx_complete() */
+#endif
+    }
+}
+
+/* Append a block without splitting it and start sending; false if it was
+ * dropped (longer than a buffer, or both buffers busy under UART_LOG_DROP) */
+bool uart_log_write(const void *data, uint32_t n)
+{
+    if (n > UART_LOG_BUF_SIZE) {
+        log_dropped += n;
+        return false;
+    }
+    for (;;) {
+        __disable_irq();
+        uint8_t f = log_fill;
+        if (n <= UART_LOG_BUF_SIZE - log_len[f]) {
+            memcpy(&log_buf[f][log_len[f]], data, n);
+            log_len[f] = (uint16_t)(log_len[f] + n);
+            if (log_dma_busy) log_flush_pending = 1;
+            else uart_log_kick();
+            __enable_irq();
+            return true;
+        }
+        uart_log_kick();
+        uint8_t stuck = (log_fill == f);
+        __enable_irq();
+        if (!stuck) continue;
+
+#if UART_LOG_POLICY == UART_LOG_DROP
+        log_dropped += n;
+        return false;
+#else
+        while (log_fill == f && log_dma_busy) { }
+#endif
+    }
+}
+
+/* Call from HAL_UART_TxCpltCallback() for the log UART */
+void uart_log_tx_complete(void)
+{
+    log_dma_busy = 0;
+    if (log_flush_pending || log_len[log_fill] == UART_LOG_BUF_SIZE) {
+        uart_log_kick();
+    }
+}
+
+/* Call from HAL_UART_ErrorCallback() for the log UART. A TX DMA error ends the
+ * transfer (gState back to ready) without a TX complete; receive errors leave
+ * the transfer running and are ignored here. */
+void uart_log_tx_error(void)
+{
+    if (log_dma_busy && log_huart->gState == HAL_UART_STATE_READY) {
+        uart_log_tx_complete();
+    }
+}
+
+/* Push out whatever is buffered, e.g. before entering STOP mode */
+void uart_log_flush(void)
+{
+    __disable_irq();
+    if (log_dma_busy) log_flush_pending = 1;
+    else uart_log_kick();
+    __enable_irq();
+}
+
+/* True once everything written so far is out; flush first, then poll this
+ * before a low-power mode that stops the DMA */
+bool uart_log_idle(void)
+{
+    __disable_irq();
+    bool idle = !log_dma_busy && log_len[log_fill] == 0;
+    __enable_irq();
+    return idle;
+}
@@ -0,0 +1,196 @@
+/* STM32 HAL template: ADC scan + circular DMA with oversampling
+ * Practice: multi-channel scan, half/full-transfer callbacks, decimating average.
+ *
+ * Replaces start/poll/print/HAL_Delay of 05_adc_poll.c: the ADC converts the scan
+ * sequence continuously into a circular DMA buffer. Each half of the buffer holds
+ * ADC_OVERSAMPLE complete scans; its callback sums them per channel and publishes
+ * one decimated result per channel while DMA keeps filling the other half.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "stm32xx_hal.h"
+#include "uart_log.h" // __io_putchar from 21_uart_log.c
+
+#define ADC_CHANNELS    4u
+#define ADC_OVERSAMPLE  16u    /* scans per result, power of two */
+#define ADC_OS_SHIFT    2u     /* 16 x 12 bit summed >> 2 = 14-bit result */
+
+ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef  hdma_usart2_tx;
+
+/* [half][scan][channel], DMA writes it in exactly this order */
+static uint16_t adc_dma[2u * ADC_OVERSAMPLE * ADC_CHANNELS];
+
+static volatile uint16_t adc_result[ADC_CHANNELS];
+static volatile uint32_t adc_seq;          /* odd while adc_result is written */
+static volatile uint32_t adc_overrun;      /* result replaced before it was read */
+static uint32_t adc_seq_read;
+
+static const uint32_t adc_channels[ADC_CHANNELS] = {
+  ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_4, ADC_CHANNEL_8 // PA0, PA1, PA4, PB0
+};
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_complete(); }
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_error(); }
+void DMA1_Stream6_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_usart2_tx); }
+void USART2_IRQHandler(void){ HAL_UART_IRQHandler(&huart2); }
+
+/* One half of the DMA buffer: ADC_OVERSAMPLE scans -> one result per channel */
+static void adc_decimate(const uint16_t *half)
+{
+  uint32_t acc[ADC_CHANNELS] = {0};
+  for (uint32_t s = 0; s < ADC_OVERSAMPLE; ++s) {
+    for (uint32_t ch = 0; ch < ADC_CHANNELS; ++ch) {
+      acc[ch] += half[s * ADC_CHANNELS + ch];
+    }
+  }
+
+  if (adc_seq != adc_seq_read) adc_overrun++;
+  adc_seq++;                                /* odd: writing */
+  for (uint32_t ch = 0; ch < ADC_CHANNELS; ++ch) {
+    adc_result[ch] = (uint16_t)(acc[ch] >> ADC_OS_SHIFT);
+  }
+  adc_seq++;                                /* even: stable */
+}
+
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  if (hadc == &hadc1) adc_decimate(&adc_dma[0]);
+}
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  if (hadc == &hadc1) adc_decimate(&adc_dma[ADC_OVERSAMPLE * ADC_CHANNELS]);
+}
+
+/* Copy the newest results; returns 0 if nothing new since the last call */
+static int adc_read(uint16_t out[ADC_CHANNELS])
+{
+  uint32_t s;
+  do {
+    s = adc_seq;
+    for (uint32_t ch = 0; ch < ADC_CHANNELS; ++ch) out[ch] = adc_result[ch];
+  } while ((s & 1u) || s != adc_seq);      /* retry if the ISR wrote meanwhile */
+
+  if (s == adc_seq_read) return 0;
+  adc_seq_read = s;
+  return 1;
+}
+
+static void MX_DMA_Init(void)
+{
+  __HAL_RCC_DMA2_CLK_ENABLE();
+  hdma_adc1.Instance = DMA2_Stream0;       // example (F4: ADC1 on DMA2 stream 0, channel 0)
+  hdma_adc1.Init.Channel = DMA_CHANNEL_0;
+  hdma_adc1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+  hdma_adc1.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_adc1.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+  hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+  hdma_adc1.Init.Mode = DMA_CIRCULAR;
+  hdma_adc1.Init.Priority = DMA_PRIORITY_HIGH;
+  HAL_DMA_Init(&hdma_adc1);
+  __HAL_LINKDMA(&hadc1, DMA_Handle, hdma_adc1);
+
+  HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+}
+
+void DMA2_Stream0_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_adc1); }
+
+static void MX_ADC1_Init(void)
+{
+  __HAL_RCC_ADC1_CLK_ENABLE();
+  hadc1.Instance = ADC1;
+  hadc1.Init.Resolution = ADC_RESOLUTION_12B;
+  hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+  hadc1.Init.ScanConvMode = ADC_SCAN_ENABLE;
+  hadc1.Init.ContinuousConvMode = ENABLE;
+  hadc1.Init.DiscontinuousConvMode = DISABLE;
+  hadc1.Init.NbrOfConversion = ADC_CHANNELS;
+  hadc1.Init.DMAContinuousRequests = ENABLE;
+  hadc1.Init.EOCSelection = ADC_EOC_SEQ_CONV;
+  HAL_ADC_Init(&hadc1);
+
+  ADC_ChannelConfTypeDef c = {0};
+  c.SamplingTime = ADC_SAMPLETIME_84CYCLES; // sets the sample rate together with the ADC clock
+  for (uint32_t i = 0; i < ADC_CHANNELS; ++i) {
+    c.Channel = adc_channels[i];
+    c.Rank = i + 1u;
+    HAL_ADC_ConfigChannel(&hadc1, &c);
+  }
+}
+
+static void MX_USART2_UART_Init(void)
+{
+  __HAL_RCC_USART2_CLK_ENABLE();
+  huart2.Instance = USART2;
+  huart2.Init.BaudRate = 115200;
+  huart2.Init.WordLength = UART_WORDLENGTH_8B;
+  huart2.Init.StopBits = UART_STOPBITS_1;
+  huart2.Init.Parity = UART_PARITY_NONE;
+  huart2.Init.Mode = UART_MODE_TX_RX;
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
+  HAL_UART_Init(&huart2);
+
+  // log TX by DMA (21_uart_log.c); example (F4): USART2_TX = DMA1 stream 6 ch 4
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_usart2_tx.Instance = DMA1_Stream6;
+  hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+  hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+  hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+  HAL_DMA_Init(&hdma_usart2_tx);
+  __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);   // TC after the last byte: HAL_UART_TxCpltCallback
+  HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+
+int main(void)
+{
+  HAL_Init();
+  SystemClock_Config();
+  MX_GPIO_Init();
+  MX_USART2_UART_Init();
+  uart_log_init(&huart2);
+  MX_DMA_Init();
+  MX_ADC1_Init();
+
+  HAL_ADC_Start_DMA(&hadc1, (uint32_t *)adc_dma, sizeof(adc_dma) / sizeof(adc_dma[0]));
+
+  uint16_t v[ADC_CHANNELS];
+  uint32_t last_print = 0;
+  while (1) {
+    if (adc_read(v) && HAL_GetTick() - last_print >= 500u) {
+      last_print = HAL_GetTick();
+      printf("ADC: %u %u %u %u (ovr %lu)\r\n", v[0], v[1], v[2], v[3], (unsigned long)adc_overrun);
+    }
+    __WFI();                               /* next DMA half wakes us */
+  }
+}
+
+static void MX_GPIO_Init(void)
+{
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOB_CLK_ENABLE();
+  GPIO_InitTypeDef g = {0};
+  g.Pin = GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_4; g.Mode = GPIO_MODE_ANALOG; g.Pull = GPIO_NOPULL;
+  HAL_GPIO_Init(GPIOA, &g);
+  g.Pin = GPIO_PIN_0;
+  HAL_GPIO_Init(GPIOB, &g);
+}
+
+void SystemClock_Config(void){ /* device specific */ }
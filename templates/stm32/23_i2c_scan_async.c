@@ -0,0 +1,248 @@
+/* STM32 HAL template: interrupt-driven I2C bus scan
+ * Practice: address probing from completion callbacks, 128-bit result bitmap,
+ *           filtered rescans, completion callback.
+ *
+ * 06_i2c_scan.c blocks in HAL_I2C_IsDeviceReady(..., 5 ms) for every address.
+ * Here each probe is a zero-length write started with HAL_I2C_Master_Transmit_IT:
+ * ACK ends in HAL_I2C_MasterTxCpltCallback, NACK in HAL_I2C_ErrorCallback, and
+ * both start the next probe. The CPU is free for the whole scan.
+ * (Series whose HAL rejects Size == 0 can probe with a 1-byte Master_Receive_IT.)
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32xx_hal.h"
+#include "uart_log.h" // __io_putchar from 21_uart_log.c
+
+#define I2C_SCAN_TIMEOUT_MS 5u   /* per probe, only for a stuck bus */
+
+/* 1: 19_temp_acquisition.c shares hi2c1. Build it with TEMP_ACQ_I2C_CALLBACKS 0;
+ * the I2C callbacks here then serve both, an error going to the scan while a
+ * scan runs and to the acquisition otherwise. The handle carries one transfer
+ * at a time: a probe that finds it busy counts as absent, so rescan between
+ * temperature rounds. */
+#ifndef I2C_SCAN_TEMP_ACQ
+#define I2C_SCAN_TEMP_ACQ 0
+#endif
+
+#define I2C_BIT_SET(bm, a)  ((bm)[(a) >> 5] |= 1UL << ((a) & 31u))
+#define I2C_BIT_GET(bm, a)  (((bm)[(a) >> 5] >> ((a) & 31u)) & 1u)
+
+typedef void (*I2cScanDoneFn)(const uint32_t found[4]);
+
+#if I2C_SCAN_TEMP_ACQ
+void temp_acq_i2c_rx_done(I2C_HandleTypeDef *hi2c);   /* 19_temp_acquisition.c */
+void temp_acq_i2c_error(I2C_HandleTypeDef *hi2c);
+#endif
+
+I2C_HandleTypeDef hi2c1;
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef  hdma_usart2_tx;
+
+static struct {
+  I2C_HandleTypeDef *hi2c;
+  uint32_t           mask[4];      /* addresses to probe */
+  uint32_t           found[4];     /* responders, updated for the probed addresses */
+  uint32_t           work[4];      /* responders of the running scan */
+  I2cScanDoneFn      done;
+  volatile uint8_t   busy;
+  volatile uint8_t   addr;         /* address being probed */
+  volatile uint8_t   aborting;     /* abort of a stuck probe issued, once per probe */
+  volatile uint32_t  t_probe;
+  uint32_t           t_start;
+  uint32_t           last_ms;      /* duration of the last scan */
+} scan;
+
+static uint8_t scan_dummy;
+
+/* Start the next probe at or after 'from'; finish the scan if none is left */
+static void i2c_scan_next(uint8_t from)
+{
+  for (uint32_t a = from; a < 128u; ++a) {
+    if (!I2C_BIT_GET(scan.mask, a)) continue;
+    scan.addr = (uint8_t)a;
+    scan.aborting = 0;
+    scan.t_probe = HAL_GetTick();
+    if (HAL_I2C_Master_Transmit_IT(scan.hi2c, (uint16_t)(a << 1), &scan_dummy, 0) == HAL_OK) {
+      return;
+    }
+    /* could not start (bus busy): treat as not present */
+  }
+  for (uint32_t w = 0; w < 4u; ++w) {    /* a filtered rescan keeps the other results */
+    scan.found[w] = (scan.found[w] & ~scan.mask[w]) | scan.work[w];
+  }
+  scan.last_ms = HAL_GetTick() - scan.t_start;
+  scan.busy = 0;
+  if (scan.done) scan.done(scan.found);
+}
+
+/* filter == NULL: full scan of 0x01..0x7E, otherwise only the given addresses */
+bool i2c_scan_start(I2C_HandleTypeDef *hi2c, const uint32_t filter[4], I2cScanDoneFn done)
+{
+  if (scan.busy) return false;
+  scan.hi2c = hi2c;
+  scan.done = done;
+  if (filter) {
+    memcpy(scan.mask, filter, sizeof scan.mask);
+  } else {
+    scan.mask[0] = 0xFFFFFFFEUL;   /* skip 0x00 general call */
+    scan.mask[1] = scan.mask[2] = 0xFFFFFFFFUL;
+    scan.mask[3] = 0x7FFFFFFFUL;   /* skip 0x7F */
+  }
+  memset(scan.work, 0, sizeof scan.work);
+  scan.t_start = HAL_GetTick();
+  scan.busy = 1;
+  i2c_scan_next(0);
+  return true;
+}
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+  if (hi2c != scan.hi2c || !scan.busy) return;
+  I2C_BIT_SET(scan.work, scan.addr);            /* ACK */
+  i2c_scan_next((uint8_t)(scan.addr + 1u));
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+  if (hi2c == scan.hi2c && scan.busy) {
+    i2c_scan_next((uint8_t)(scan.addr + 1u));  /* NACK (AF) or bus error */
+    return;
+  }
+#if I2C_SCAN_TEMP_ACQ
+  temp_acq_i2c_error(hi2c);
+#endif
+}
+
+#if I2C_SCAN_TEMP_ACQ
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) { temp_acq_i2c_rx_done(hi2c); }
+#endif
+
+void HAL_I2C_AbortCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+  HAL_I2C_ErrorCallback(hi2c);
+}
+
+/* Main loop: only needed to recover a probe that never completes. The abort
+ * is issued once; its completion (AbortCpltCallback) moves on. If the HAL
+ * refuses it, no transfer is running and the probe is skipped here. */
+void i2c_scan_poll(void)
+{
+  if (!scan.busy || scan.aborting || HAL_GetTick() - scan.t_probe <= I2C_SCAN_TIMEOUT_MS) return;
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();                                /* the probe may finish meanwhile */
+  if (scan.busy && !scan.aborting && HAL_GetTick() - scan.t_probe > I2C_SCAN_TIMEOUT_MS) {
+    scan.aborting = 1;
+    if (HAL_I2C_Master_Abort_IT(scan.hi2c, (uint16_t)(scan.addr << 1)) != HAL_OK) {
+      i2c_scan_next((uint8_t)(scan.addr + 1u));
+    }
+  }
+  __set_PRIMASK(primask);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_complete(); }
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_error(); }
+void DMA1_Stream6_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_usart2_tx); }
+void USART2_IRQHandler(void){ HAL_UART_IRQHandler(&huart2); }
+void I2C1_EV_IRQHandler(void){ HAL_I2C_EV_IRQHandler(&hi2c1); }
+void I2C1_ER_IRQHandler(void){ HAL_I2C_ER_IRQHandler(&hi2c1); }
+
+/* Known devices: TMP1075 sensors used by measure_temperatures() */
+static uint32_t tmp1075_filter[4];
+static volatile uint8_t scan_report;
+
+static void on_scan_done(const uint32_t found[4])
+{
+  (void)found;
+  scan_report = 1;    /* runs in IRQ context: just flag the main loop */
+}
+
+static void MX_I2C1_Init(void)
+{
+  __HAL_RCC_I2C1_CLK_ENABLE();
+  hi2c1.Instance = I2C1;
+  hi2c1.Init.Timing = 0x00707CBB; // example timing
+  hi2c1.Init.OwnAddress1 = 0;
+  hi2c1.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+  hi2c1.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+  hi2c1.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+  hi2c1.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+  HAL_I2C_Init(&hi2c1);
+
+  HAL_NVIC_SetPriority(I2C1_EV_IRQn, 2, 0);
+  HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
+  HAL_NVIC_SetPriority(I2C1_ER_IRQn, 2, 0);
+  HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
+}
+
+static void MX_USART2_UART_Init(void)
+{
+  __HAL_RCC_USART2_CLK_ENABLE();
+  huart2.Instance = USART2;
+  huart2.Init.BaudRate = 115200;
+  huart2.Init.WordLength = UART_WORDLENGTH_8B;
+  huart2.Init.StopBits = UART_STOPBITS_1;
+  huart2.Init.Parity = UART_PARITY_NONE;
+  huart2.Init.Mode = UART_MODE_TX_RX;
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
+  HAL_UART_Init(&huart2);
+
+  // log TX by DMA (21_uart_log.c); example (F4): USART2_TX = DMA1 stream 6 ch 4
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_usart2_tx.Instance = DMA1_Stream6;
+  hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+  hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+  hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+  HAL_DMA_Init(&hdma_usart2_tx);
+  __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);   // TC after the last byte: HAL_UART_TxCpltCallback
+  HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+
+int main(void)
+{
+  HAL_Init();
+  SystemClock_Config();
+  MX_GPIO_Init();
+  MX_USART2_UART_Init();
+  uart_log_init(&huart2);
+  MX_I2C1_Init();
+
+  const uint8_t known[] = {73, 72, 75, 79};
+  for (uint32_t i = 0; i < sizeof known; ++i) I2C_BIT_SET(tmp1075_filter, known[i]);
+
+  i2c_scan_start(&hi2c1, NULL, on_scan_done);     /* full scan once */
+  uint32_t last = HAL_GetTick();
+  for(;;){
+    i2c_scan_poll();
+    if (scan_report) {
+      scan_report = 0;
+      for (uint32_t a = 1; a < 127u; ++a) {
+        if (I2C_BIT_GET(scan.found, a)) printf("Found I2C 0x%02X\r\n", (unsigned)a);
+      }
+      printf("scan took %lu ms\r\n", (unsigned long)scan.last_ms);
+    }
+    if (HAL_GetTick() - last >= 2000u) {            /* cheap rescan of the known sensors */
+      last = HAL_GetTick();
+      i2c_scan_start(&hi2c1, tmp1075_filter, on_scan_done);
+    }
+    __WFI();
+  }
+}
+
+static void MX_GPIO_Init(void){ __HAL_RCC_GPIOB_CLK_ENABLE(); }
+void SystemClock_Config(void){ /* device specific */ }
@@ -0,0 +1,274 @@
+/* STM32 HAL template: SPI full-duplex DMA transfer engine
+ * Practice: transfer descriptors, queue, chip-select chaining in the completion
+ *           callback, ping-pong stream buffers, non-blocking submit/complete.
+ *
+ * 07_spi_loopback.c blocks in HAL_SPI_TransmitReceive(..., HAL_MAX_DELAY).
+ * Here spi_submit() only queues a descriptor. HAL_SPI_TxRxCpltCallback releases
+ * the finished device's CS, reports completion and immediately starts the next
+ * queued descriptor, so transfers run back-to-back without the main loop.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32xx_hal.h"
+#include "uart_log.h" // __io_putchar from 21_uart_log.c
+
+#define SPI_QUEUE_LEN  8u     /* power of two */
+#define SPI_PP_SIZE    64u    /* bytes per ping-pong stream buffer */
+
+typedef enum { SPI_XFER_IDLE, SPI_XFER_QUEUED, SPI_XFER_ACTIVE, SPI_XFER_DONE, SPI_XFER_ERROR } SpiXferState_t;
+
+typedef struct SpiXfer SpiXfer_t;
+typedef void (*SpiDoneFn)(SpiXfer_t *x);     /* called in IRQ context */
+
+struct SpiXfer {
+  GPIO_TypeDef            *cs_port;          /* NULL: no chip select */
+  uint16_t                 cs_pin;
+  const uint8_t           *tx;
+  uint8_t                 *rx;
+  uint16_t                 len;
+  SpiDoneFn                done;
+  volatile SpiXferState_t  state;
+};
+
+SPI_HandleTypeDef hspi1;
+DMA_HandleTypeDef hdma_spi1_tx;
+DMA_HandleTypeDef hdma_spi1_rx;
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef  hdma_usart2_tx;
+
+static SpiXfer_t *spi_q[SPI_QUEUE_LEN];
+static volatile uint32_t spi_q_head;     /* written by spi_submit() */
+static volatile uint32_t spi_q_tail;     /* advanced by spi_start_next() */
+static SpiXfer_t *volatile spi_active;
+
+/* IRQs disabled or in IRQ: start the oldest queued descriptor, if any */
+static void spi_start_next(void)
+{
+  while (!spi_active && spi_q_tail != spi_q_head) {
+    SpiXfer_t *x = spi_q[spi_q_tail & (SPI_QUEUE_LEN - 1u)];
+    spi_q_tail = spi_q_tail + 1u;
+
+    spi_active = x;
+    x->state = SPI_XFER_ACTIVE;
+    if (x->cs_port) HAL_GPIO_WritePin(x->cs_port, x->cs_pin, GPIO_PIN_RESET);
+    if (HAL_SPI_TransmitReceive_DMA(&hspi1, (uint8_t *)x->tx, x->rx, x->len) != HAL_OK) {
+      if (x->cs_port) HAL_GPIO_WritePin(x->cs_port, x->cs_pin, GPIO_PIN_SET);
+      spi_active = NULL;
+      x->state = SPI_XFER_ERROR;
+      if (x->done) x->done(x);
+    }
+  }
+}
+
+/* Non-blocking: false if the queue is full */
+bool spi_submit(SpiXfer_t *x)
+{
+  bool ok = false;
+  __disable_irq();
+  if (spi_q_head - spi_q_tail < SPI_QUEUE_LEN) {
+    x->state = SPI_XFER_QUEUED;
+    spi_q[spi_q_head & (SPI_QUEUE_LEN - 1u)] = x;
+    spi_q_head = spi_q_head + 1u;
+    spi_start_next();
+    ok = true;
+  }
+  __enable_irq();
+  return ok;
+}
+
+static inline bool spi_xfer_busy(const SpiXfer_t *x)
+{
+  return x->state == SPI_XFER_QUEUED || x->state == SPI_XFER_ACTIVE;
+}
+
+static void spi_finish(SpiXferState_t st)
+{
+  SpiXfer_t *x = spi_active;
+  if (!x) return;
+  if (x->cs_port) HAL_GPIO_WritePin(x->cs_port, x->cs_pin, GPIO_PIN_SET);
+  spi_active = NULL;
+  x->state = st;
+  if (x->done) x->done(x);
+  spi_start_next();                          /* chain the next device right away */
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi){ if (hspi == &hspi1) spi_finish(SPI_XFER_DONE); }
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi){ if (hspi == &hspi1) spi_finish(SPI_XFER_ERROR); }
+
+/* Ping-pong streaming: fill one buffer while the other one is on the bus */
+static uint8_t   spi_pp_tx[2][SPI_PP_SIZE];
+static uint8_t   spi_pp_rx[2][SPI_PP_SIZE];
+static SpiXfer_t spi_pp_xfer[2];
+static uint8_t   spi_pp_next;
+
+/* Returns the next stream buffer once its previous transfer has finished */
+uint8_t *spi_pp_acquire(void)
+{
+  SpiXfer_t *x = &spi_pp_xfer[spi_pp_next];
+  return spi_xfer_busy(x) ? NULL : spi_pp_tx[spi_pp_next];
+}
+
+bool spi_pp_submit(uint16_t len, GPIO_TypeDef *cs_port, uint16_t cs_pin, SpiDoneFn done)
+{
+  SpiXfer_t *x = &spi_pp_xfer[spi_pp_next];
+  if (spi_xfer_busy(x) || len > SPI_PP_SIZE) return false;
+  x->cs_port = cs_port;
+  x->cs_pin = cs_pin;
+  x->tx = spi_pp_tx[spi_pp_next];
+  x->rx = spi_pp_rx[spi_pp_next];
+  x->len = len;
+  x->done = done;
+  if (!spi_submit(x)) return false;
+  spi_pp_next ^= 1u;
+  return true;
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_complete(); }
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_error(); }
+void DMA1_Stream6_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_usart2_tx); }
+void USART2_IRQHandler(void){ HAL_UART_IRQHandler(&huart2); }
+void DMA2_Stream2_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_spi1_rx); }
+void DMA2_Stream3_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_spi1_tx); }
+
+static void MX_DMA_Init(void)
+{
+  __HAL_RCC_DMA2_CLK_ENABLE();
+  // example (F4): SPI1_RX = DMA2 stream 2 ch 3, SPI1_TX = DMA2 stream 3 ch 3
+  hdma_spi1_rx.Instance = DMA2_Stream2;
+  hdma_spi1_rx.Init.Channel = DMA_CHANNEL_3;
+  hdma_spi1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+  hdma_spi1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_spi1_rx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_spi1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_spi1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_spi1_rx.Init.Mode = DMA_NORMAL;
+  hdma_spi1_rx.Init.Priority = DMA_PRIORITY_HIGH;
+  HAL_DMA_Init(&hdma_spi1_rx);
+  __HAL_LINKDMA(&hspi1, hdmarx, hdma_spi1_rx);
+
+  hdma_spi1_tx.Instance = DMA2_Stream3;
+  hdma_spi1_tx.Init = hdma_spi1_rx.Init;
+  hdma_spi1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_spi1_tx.Init.Priority = DMA_PRIORITY_LOW;
+  HAL_DMA_Init(&hdma_spi1_tx);
+  __HAL_LINKDMA(&hspi1, hdmatx, hdma_spi1_tx);
+
+  HAL_NVIC_SetPriority(DMA2_Stream2_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
+  HAL_NVIC_SetPriority(DMA2_Stream3_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream3_IRQn);
+}
+
+static void MX_SPI1_Init(void)
+{
+  __HAL_RCC_SPI1_CLK_ENABLE();
+  hspi1.Instance = SPI1;
+  hspi1.Init.Mode = SPI_MODE_MASTER;
+  hspi1.Init.Direction = SPI_DIRECTION_2LINES;
+  hspi1.Init.DataSize = SPI_DATASIZE_8BIT;
+  hspi1.Init.CLKPolarity = SPI_POLARITY_LOW;
+  hspi1.Init.CLKPhase = SPI_PHASE_1EDGE;
+  hspi1.Init.NSS = SPI_NSS_SOFT;
+  hspi1.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_16;
+  hspi1.Init.FirstBit = SPI_FIRSTBIT_MSB;
+  hspi1.Init.TIMode = SPI_TIMODE_DISABLE;
+  hspi1.Init.CRCCalculation = SPI_CRCCALCULATION_DISABLE;
+  HAL_SPI_Init(&hspi1);
+}
+
+static void MX_USART2_UART_Init(void)
+{
+  __HAL_RCC_USART2_CLK_ENABLE();
+  huart2.Instance = USART2;
+  huart2.Init.BaudRate = 115200;
+  huart2.Init.WordLength = UART_WORDLENGTH_8B;
+  huart2.Init.StopBits = UART_STOPBITS_1;
+  huart2.Init.Parity = UART_PARITY_NONE;
+  huart2.Init.Mode = UART_MODE_TX_RX;
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
+  HAL_UART_Init(&huart2);
+
+  // log TX by DMA (21_uart_log.c); example (F4): USART2_TX = DMA1 stream 6 ch 4
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_usart2_tx.Instance = DMA1_Stream6;
+  hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+  hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+  hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+  HAL_DMA_Init(&hdma_usart2_tx);
+  __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);   // TC after the last byte: HAL_UART_TxCpltCallback
+  HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+
+static volatile uint32_t stream_blocks, stream_errors;   /* written by the SPI IRQ only */
+static void on_block(SpiXfer_t *x){ if (x->state == SPI_XFER_DONE) stream_blocks++; else stream_errors++; }
+
+/* Blocks finished since the previous call. The counter is never reset from
+ * here: a read-modify-write would race the IRQ's ++ and lose blocks. */
+static uint32_t stream_blocks_since(uint32_t *prev)
+{
+  uint32_t now = stream_blocks;
+  uint32_t n = now - *prev;
+  *prev = now;
+  return n;
+}
+
+int main(void)
+{
+  HAL_Init();
+  SystemClock_Config();
+  MX_GPIO_Init();
+  MX_USART2_UART_Init();
+  uart_log_init(&huart2);
+  MX_DMA_Init();
+  MX_SPI1_Init();
+
+  /* Single descriptor: the old loopback check, now non-blocking */
+  static uint8_t tx[8] = {1,2,3,4,5,6,7,8};
+  static uint8_t rx[8];
+  static SpiXfer_t loop = { GPIOA, GPIO_PIN_4, tx, rx, sizeof(tx), NULL, SPI_XFER_IDLE };
+  spi_submit(&loop);
+  while (spi_xfer_busy(&loop)) { __WFI(); }
+  printf(memcmp(tx, rx, sizeof(tx)) == 0 ? "SPI OK\r\n" : "SPI mismatch\r\n");
+
+  /* Streaming: keep both ping-pong buffers in flight */
+  uint8_t seq = 0;
+  uint32_t last = HAL_GetTick(), blocks_prev = 0;
+  while (1) {
+    uint8_t *buf = spi_pp_acquire();
+    if (buf) {
+      for (uint32_t i = 0; i < SPI_PP_SIZE; ++i) buf[i] = seq++;
+      spi_pp_submit(SPI_PP_SIZE, GPIOA, GPIO_PIN_4, on_block);
+    }
+    if (HAL_GetTick() - last >= 1000u) {
+      last = HAL_GetTick();
+      printf("SPI %lu B/s, err %lu\r\n", (unsigned long)(stream_blocks_since(&blocks_prev) * SPI_PP_SIZE),
+             (unsigned long)stream_errors);
+    }
+  }
+}
+
+static void MX_GPIO_Init(void)
+{
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  GPIO_InitTypeDef g = {0};
+  g.Pin = GPIO_PIN_4; g.Mode = GPIO_MODE_OUTPUT_PP; g.Pull = GPIO_NOPULL; g.Speed = GPIO_SPEED_FREQ_HIGH;
+  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_4, GPIO_PIN_SET);   // CS idle high
+  HAL_GPIO_Init(GPIOA, &g);
+}
+
+void SystemClock_Config(void){ /* device specific */ }
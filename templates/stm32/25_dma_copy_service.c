@@ -0,0 +1,278 @@
+/* STM32 HAL template: DMA mem2mem copy service
+ * Practice: completion callbacks instead of polling, chunking across DMA streams,
+ *           CPU fallback below a measured size threshold, DWT benchmark matrix.
+ *
+ * 08_dma_mem2mem.c starts a DMA copy and then polls HAL_DMA_PollForTransfer, so the
+ * CPU gains nothing. copy_async() returns at once: large co-aligned blocks are split
+ * into chunks that all available streams pull from, head/tail bytes and small or
+ * misaligned copies are done by the CPU, and the done callback fires when the last
+ * chunk completes. copy_bench() measures CPU vs DMA per size and alignment and sets
+ * the crossover threshold.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32xx_hal.h"
+#include "uart_log.h" // __io_putchar from 21_uart_log.c
+
+#define COPY_DMA_CHANNELS   2u
+#define COPY_CHUNK_WORDS    1024u   /* 4 KiB per DMA start, keeps both streams busy */
+
+typedef void (*CopyDoneFn)(bool ok);    /* may run in DMA IRQ context */
+
+DMA_HandleTypeDef hdma_m2m[COPY_DMA_CHANNELS];
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef  hdma_usart2_tx;
+
+static uint32_t copy_dma_threshold = 256u;   /* bytes; replaced by copy_bench() */
+
+static struct {
+  uint8_t          *dst;
+  const uint8_t    *src;
+  uint32_t          off;         /* next byte offset handed to a stream */
+  uint32_t          words_left;
+  uint8_t           active;      /* streams currently running */
+  uint8_t           failed;
+  CopyDoneFn        done;
+  volatile uint8_t  busy;
+} cp;
+
+/* Word-wise CPU copy for co-aligned buffers, memcpy otherwise */
+static void copy_cpu(uint8_t *d, const uint8_t *s, size_t n)
+{
+  if (((uintptr_t)d & 3u) != ((uintptr_t)s & 3u)) {
+    memcpy(d, s, n);
+    return;
+  }
+  while (n && ((uintptr_t)d & 3u)) { *d++ = *s++; n--; }
+  uint32_t *dw = (uint32_t *)d;
+  const uint32_t *sw = (const uint32_t *)s;
+  for (; n >= 16u; n -= 16u) {
+    dw[0] = sw[0]; dw[1] = sw[1]; dw[2] = sw[2]; dw[3] = sw[3];
+    dw += 4; sw += 4;
+  }
+  for (; n >= 4u; n -= 4u) *dw++ = *sw++;
+  d = (uint8_t *)dw; s = (const uint8_t *)sw;
+  while (n--) *d++ = *s++;
+}
+
+/* IRQs disabled or in DMA IRQ: give the stream the next chunk */
+static bool copy_kick(DMA_HandleTypeDef *h)
+{
+  if (cp.words_left == 0) return false;
+  uint32_t n = cp.words_left < COPY_CHUNK_WORDS ? cp.words_left : COPY_CHUNK_WORDS;
+  if (HAL_DMA_Start_IT(h, (uint32_t)(uintptr_t)(cp.src + cp.off),
+                       (uint32_t)(uintptr_t)(cp.dst + cp.off), n) != HAL_OK) {
+    return false;
+  }
+  cp.off += n * 4u;
+  cp.words_left -= n;
+  cp.active++;
+  return true;
+}
+
+/* IRQs disabled or in DMA IRQ */
+static void copy_finish_if_idle(void)
+{
+  if (cp.active != 0 || !cp.busy) return;
+  if (cp.words_left) {                       /* no stream could be started: finish on the CPU */
+    copy_cpu(cp.dst + cp.off, cp.src + cp.off, cp.words_left * 4u);
+    cp.words_left = 0;
+  }
+  cp.busy = 0;
+  if (cp.done) cp.done(!cp.failed);
+}
+
+static void copy_dma_cplt(DMA_HandleTypeDef *h)
+{
+  cp.active--;
+  copy_kick(h);
+  copy_finish_if_idle();
+}
+
+static void copy_dma_error(DMA_HandleTypeDef *h)
+{
+  (void)h;                                   /* chunk is lost, stop handing out new ones */
+  cp.active--;
+  cp.failed = 1;
+  cp.words_left = 0;
+  copy_finish_if_idle();
+}
+
+/* Returns false while a previous copy is still running */
+bool copy_async(void *dst, const void *src, size_t len, CopyDoneFn done)
+{
+  uint8_t *d = dst;
+  const uint8_t *s = src;
+  if (cp.busy) return false;
+
+  if (len < copy_dma_threshold || len < 8u || ((uintptr_t)d & 3u) != ((uintptr_t)s & 3u)) {
+    copy_cpu(d, s, len);
+    if (done) done(true);
+    return true;
+  }
+
+  /* CPU takes the unaligned head and the tail, DMA the aligned words */
+  size_t head = (4u - ((uintptr_t)d & 3u)) & 3u;
+  size_t words = (len - head) / 4u;
+  size_t tail = len - head - words * 4u;
+  copy_cpu(d, s, head);
+  copy_cpu(d + head + words * 4u, s + head + words * 4u, tail);
+
+  __disable_irq();
+  cp.dst = d + head;
+  cp.src = s + head;
+  cp.off = 0;
+  cp.words_left = (uint32_t)words;
+  cp.active = 0;
+  cp.failed = 0;
+  cp.done = done;
+  cp.busy = 1;
+  for (uint32_t i = 0; i < COPY_DMA_CHANNELS; ++i) copy_kick(&hdma_m2m[i]);
+  copy_finish_if_idle();
+  __enable_irq();
+  return true;                               /* CPU is free until done() */
+}
+
+static inline bool copy_busy(void) { return cp.busy; }
+
+/* Benchmark matrix ------------------------------------------------------------ */
+/* Word aligned, so offset 0 is the aligned case and 1 the byte-head case */
+static uint8_t bench_src[4096 + 8] __attribute__((aligned(4)));
+static uint8_t bench_dst[4096 + 8] __attribute__((aligned(4)));
+
+static uint32_t cycles_cpu(size_t n, uint32_t sa, uint32_t da)
+{
+  uint32_t t0 = DWT->CYCCNT;
+  copy_cpu(bench_dst + da, bench_src + sa, n);
+  return DWT->CYCCNT - t0;
+}
+
+static uint32_t cycles_dma(size_t n)
+{
+  uint32_t saved = copy_dma_threshold;
+  copy_dma_threshold = 0;                    /* force the DMA path */
+  uint32_t t0 = DWT->CYCCNT;
+  copy_async(bench_dst, bench_src, n, NULL);
+  while (copy_busy()) { }
+  uint32_t t = DWT->CYCCNT - t0;
+  copy_dma_threshold = saved;
+  return t;
+}
+
+void copy_bench(void)
+{
+  static const size_t sizes[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  uint32_t threshold = 0;
+  printf("size  cpu(a0) cpu(a1) cpu(a0/1)  dma(a0)\r\n");
+  for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; ++i) {
+    size_t n = sizes[i];
+    uint32_t c0 = cycles_cpu(n, 0, 0);         /* both word aligned */
+    uint32_t c1 = cycles_cpu(n, 1, 1);         /* co-aligned, byte head */
+    uint32_t cx = cycles_cpu(n, 0, 1);         /* not co-aligned: memcpy */
+    uint32_t dm = cycles_dma(n);
+    printf("%4u %8lu %7lu %9lu %8lu\r\n", (unsigned)n, (unsigned long)c0, (unsigned long)c1,
+           (unsigned long)cx, (unsigned long)dm);
+    if (!threshold && dm < c0) threshold = (uint32_t)n;
+  }
+  copy_dma_threshold = threshold ? threshold : UINT32_MAX;
+  printf("DMA threshold: %lu bytes\r\n", (unsigned long)copy_dma_threshold);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_complete(); }
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_error(); }
+void DMA1_Stream6_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_usart2_tx); }
+void USART2_IRQHandler(void){ HAL_UART_IRQHandler(&huart2); }
+void DMA2_Stream0_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_m2m[0]); }
+void DMA2_Stream1_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_m2m[1]); }
+
+static void MX_DMA_Init(void)
+{
+  __HAL_RCC_DMA2_CLK_ENABLE();  // F4: only DMA2 can do memory-to-memory
+  hdma_m2m[0].Instance = DMA2_Stream0;
+  hdma_m2m[1].Instance = DMA2_Stream1;
+  for (uint32_t i = 0; i < COPY_DMA_CHANNELS; ++i) {
+    DMA_HandleTypeDef *h = &hdma_m2m[i];
+    h->Init.Channel = DMA_CHANNEL_0;
+    h->Init.Direction = DMA_MEMORY_TO_MEMORY;
+    h->Init.PeriphInc = DMA_PINC_ENABLE;
+    h->Init.MemInc = DMA_MINC_ENABLE;
+    h->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    h->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    h->Init.Mode = DMA_NORMAL;
+    h->Init.Priority = DMA_PRIORITY_LOW;
+    HAL_DMA_Init(h);
+    h->XferCpltCallback = copy_dma_cplt;
+    h->XferErrorCallback = copy_dma_error;
+  }
+  HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 3, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+  HAL_NVIC_SetPriority(DMA2_Stream1_IRQn, 3, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream1_IRQn);
+}
+
+static void MX_USART2_UART_Init(void)
+{
+  __HAL_RCC_USART2_CLK_ENABLE();
+  huart2.Instance = USART2;
+  huart2.Init.BaudRate = 115200;
+  huart2.Init.WordLength = UART_WORDLENGTH_8B;
+  huart2.Init.StopBits = UART_STOPBITS_1;
+  huart2.Init.Parity = UART_PARITY_NONE;
+  huart2.Init.Mode = UART_MODE_TX_RX;
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
+  HAL_UART_Init(&huart2);
+
+  // log TX by DMA (21_uart_log.c); example (F4): USART2_TX = DMA1 stream 6 ch 4
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_usart2_tx.Instance = DMA1_Stream6;
+  hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+  hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+  hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+  HAL_DMA_Init(&hdma_usart2_tx);
+  __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);   // TC after the last byte: HAL_UART_TxCpltCallback
+  HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+
+static volatile uint8_t copied, copy_ok;
+static void on_copied(bool ok){ copy_ok = ok; copied = 1; }
+
+int main(void)
+{
+  HAL_Init();
+  SystemClock_Config();
+  MX_GPIO_Init();
+  MX_USART2_UART_Init();
+  uart_log_init(&huart2);
+  MX_DMA_Init();
+
+  for (uint32_t i = 0; i < sizeof bench_src; i++) bench_src[i] = (uint8_t)i;
+  copy_bench();
+
+  copy_async(bench_dst + 1, bench_src + 1, 3000, on_copied);
+  uint32_t spins = 0;
+  while (!copied) { spins++; }               /* stand-in for real CPU work */
+  printf("copy %s, CPU free for %lu loop iterations\r\n",
+         copy_ok && memcmp(bench_dst + 1, bench_src + 1, 3000) == 0 ? "OK" : "FAILED", (unsigned long)spins);
+  while(1){ __WFI(); }
+}
+
+static void MX_GPIO_Init(void){ /* clocks as needed */ }
+void SystemClock_Config(void){ /* device specific */ }
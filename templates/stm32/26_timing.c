@@ -0,0 +1,160 @@
+/* STM32 HAL template: microsecond timing service
+ * Practice: DWT cycle counter (TIM fallback), monotonic now_us(), wrap-proof
+ *           deadlines, non-blocking timeouts, calibrated busy-waits.
+ *
+ * The raw counter (DWT->CYCCNT, or a free-running 16-bit TIM at 1 MHz on parts
+ * without DWT such as Cortex-M0) is only ever used through unsigned differences,
+ * so wraps need no special cases. now_us() folds the elapsed raw ticks into a
+ * 32-bit microsecond clock; it must run at least once per half counter period
+ * (about 12 s for DWT at 168 MHz, 32 ms for the TIM), which SysTick covers.
+ *
+ * timing.h:
+ *   void     timing_init(void);
+ *   uint32_t now_us(void);
+ *   void     timeout_start(Timeout_t *t, uint32_t us);
+ *   bool     timeout_expired(const Timeout_t *t);
+ *   uint32_t timeout_remaining(const Timeout_t *t);
+ *   void     busy_wait_us(uint32_t us);
+ *
+ * State machine use:
+ *   case ST_WAIT: if (timeout_expired(&t)) { ... state = ST_NEXT; } break;
+ *
+ * Host tests: define TIMING_READ_RAW() to read a variable and TIMING_TICKS_PER_US
+ * to a constant; then the wrap cases can be driven from the test.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32xx_hal.h" // replace with your series header
+
+#define TIMING_DWT  0   /* 32-bit core cycle counter, Cortex-M3/M4/M7 */
+#define TIMING_TIM  1   /* 16-bit timer, PSC for 1 MHz, ARR = 0xFFFF */
+
+#ifndef TIMING_SOURCE
+#define TIMING_SOURCE TIMING_DWT
+#endif
+
+#if TIMING_SOURCE == TIMING_TIM
+extern TIM_HandleTypeDef htim9;
+#endif
+
+#ifndef TIMING_READ_RAW
+#if TIMING_SOURCE == TIMING_DWT
+#define TIMING_READ_RAW()  (DWT->CYCCNT)
+#else
+#define TIMING_READ_RAW()  ((uint32_t)__HAL_TIM_GET_COUNTER(&htim9))
+#endif
+#endif
+
+#if TIMING_SOURCE == TIMING_DWT
+#define TIMING_RAW_MASK  0xFFFFFFFFUL
+#else
+#define TIMING_RAW_MASK  0xFFFFUL
+#endif
+#define TIMING_MAX_STEP  (TIMING_RAW_MASK / 2u)   /* longest wait between two counter reads */
+
+typedef struct {
+    uint32_t start;   /* now_us() when started */
+    uint32_t span;    /* microseconds */
+} Timeout_t;
+
+#ifdef TIMING_TICKS_PER_US
+static uint32_t tm_ticks_per_us = TIMING_TICKS_PER_US;
+#else
+static uint32_t tm_ticks_per_us = 1u;     /* set by timing_init() */
+#endif
+static uint32_t tm_wait_overhead;         /* raw ticks spent in busy_wait_us(0) */
+static uint32_t tm_last_raw;
+static uint32_t tm_us;                    /* microseconds up to tm_last_raw */
+static uint32_t tm_frac;                  /* leftover raw ticks, < tm_ticks_per_us */
+
+/* Monotonic microseconds; wraps after ~71 minutes, compare with differences only */
+uint32_t now_us(void)
+{
+    uint32_t pm = __get_PRIMASK();
+    __disable_irq();                      /* called from SysTick and thread mode */
+    uint32_t raw = TIMING_READ_RAW();
+    uint32_t d   = (raw - tm_last_raw) & TIMING_RAW_MASK;
+    tm_last_raw  = raw;
+    tm_us   += d / tm_ticks_per_us;
+    tm_frac += d % tm_ticks_per_us;
+    if (tm_frac >= tm_ticks_per_us) {
+        tm_frac -= tm_ticks_per_us;
+        tm_us++;
+    }
+    uint32_t us = tm_us;
+    __set_PRIMASK(pm);
+    return us;
+}
+
+/* Deadlines are start + span, so any span up to 2^32-1 us survives the wrap */
+void timeout_start(Timeout_t *t, uint32_t us)
+{
+    t->start = now_us();
+    t->span  = us;
+}
+
+bool timeout_expired(const Timeout_t *t)
+{
+    return now_us() - t->start >= t->span;
+}
+
+uint32_t timeout_remaining(const Timeout_t *t)
+{
+    uint32_t el = now_us() - t->start;
+    return el >= t->span ? 0u : t->span - el;
+}
+
+/* Busy-wait on the raw counter; for short waits where a state machine is overkill */
+void busy_wait_us(uint32_t us)
+{
+    uint32_t start = TIMING_READ_RAW();
+    uint64_t ticks = (uint64_t)us * tm_ticks_per_us;
+    ticks = ticks > tm_wait_overhead ? ticks - tm_wait_overhead : 0u;
+
+    while (ticks) {
+        uint32_t step = ticks > TIMING_MAX_STEP ? TIMING_MAX_STEP : (uint32_t)ticks;
+        while (((TIMING_READ_RAW() - start) & TIMING_RAW_MASK) < step) {
+        }
+        start += step;
+        ticks -= step;
+    }
+}
+
+/* Measure the fixed cost of a busy_wait_us() call so short waits are not too long */
+static void timing_calibrate(void)
+{
+    uint32_t best = UINT32_MAX;
+    tm_wait_overhead = 0;
+    for (uint32_t i = 0; i < 8u; ++i) {
+        uint32_t t0 = TIMING_READ_RAW();
+        busy_wait_us(0);
+        uint32_t d = (TIMING_READ_RAW() - t0) & TIMING_RAW_MASK;
+        if (d < best) best = d;
+    }
+    tm_wait_overhead = best;
+}
+
+void timing_init(void)
+{
+#if TIMING_SOURCE == TIMING_DWT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#ifndef TIMING_TICKS_PER_US
+    tm_ticks_per_us = SystemCoreClock / 1000000u;
+#endif
+#else
+    HAL_TIM_Base_Start(&htim9);           /* tm_ticks_per_us stays 1 */
+#endif
+    tm_last_raw = TIMING_READ_RAW();
+    tm_us = 0;
+    tm_frac = 0;
+    timing_calibrate();
+}
+
+/* CubeMX keeps this in stm32xx_it.c: add the now_us() call there */
+void SysTick_Handler(void)
+{
+    HAL_IncTick();
+    (void)now_us();                       /* keeps now_us() ahead of counter wraps */
+}
@@ -0,0 +1,311 @@
+/* STM32 HAL template: cooperative run-to-completion scheduler
+ * Practice: hashed timer wheel, ISR event flags, sleep when idle, dispatch stats.
+ *
+ * Replaces the blocking while(1) + HAL_Delay loops of 04/05/09/10. Tasks are
+ * registered with a period (timer wheel) and/or an event mask (flags posted from
+ * ISRs). sched_run_once() catches up on every millisecond tick since its last
+ * call, runs the due tasks, then the tasks whose events were posted. When
+ * nothing is pending the CPU sleeps in WFI until the next interrupt (SysTick at
+ * the latest). SCHED_CYCLES() splits the time into idle, task and scheduler
+ * overhead.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32xx_hal.h"
+#include "uart_log.h" // __io_putchar from 21_uart_log.c
+
+#define SCHED_WHEEL_SLOTS  32u     /* power of two; periods may exceed it */
+
+#ifndef SCHED_CYCLES
+#define SCHED_CYCLES()     (DWT->CYCCNT)
+#endif
+
+#define EV_BUTTON  (1UL << 0)
+
+typedef void (*TaskFn)(uint32_t events);     /* events == 0: timer run */
+
+typedef struct Task Task_t;
+struct Task {
+  TaskFn    fn;
+  uint32_t  period;      /* ms, 0: event-only */
+  uint32_t  deadline;    /* ms of allowed dispatch latency, counts misses */
+  uint32_t  events;      /* event bits this task wants */
+  uint32_t  due;         /* tick of the next timer run */
+  Task_t   *slot_next;   /* wheel slot list */
+  Task_t   *all_next;    /* registration list, for events */
+  uint32_t  runs, misses, max_latency;
+};
+
+static Task_t  *sched_wheel[SCHED_WHEEL_SLOTS];
+static Task_t  *sched_tasks;
+static uint32_t sched_tick;                  /* last tick processed */
+static volatile uint32_t sched_events;       /* posted from ISRs */
+
+static struct {
+  uint32_t idle, task, overhead;             /* cycles */
+  uint32_t dispatches;
+} sched_stats;
+
+static void sched_wheel_insert(Task_t *t)
+{
+  Task_t **slot = &sched_wheel[t->due & (SCHED_WHEEL_SLOTS - 1u)];
+  t->slot_next = *slot;
+  *slot = t;
+}
+
+/* first: ms until the first timer run */
+void sched_add(Task_t *t, uint32_t first)
+{
+  t->all_next = sched_tasks;
+  sched_tasks = t;
+  if (t->period) {
+    t->due = sched_tick + (first ? first : 1u);
+    sched_wheel_insert(t);
+  }
+}
+
+/* ISR-safe: wake the tasks subscribed to these bits */
+void sched_post(uint32_t ev)
+{
+  uint32_t pm = __get_PRIMASK();
+  __disable_irq();
+  sched_events |= ev;
+  __set_PRIMASK(pm);
+}
+
+static void sched_dispatch(Task_t *t, uint32_t ev, uint32_t *t0)
+{
+  uint32_t t1 = SCHED_CYCLES();
+  t->fn(ev);
+  uint32_t t2 = SCHED_CYCLES();
+  sched_stats.overhead += t1 - *t0;
+  sched_stats.task += t2 - t1;
+  sched_stats.dispatches++;
+  t->runs++;
+  *t0 = t2;
+}
+
+/* Only the tasks of one slot are looked at per tick; the rest wait for their lap */
+static void sched_advance(uint32_t tick, uint32_t now, uint32_t *t0)
+{
+  Task_t **pp = &sched_wheel[tick & (SCHED_WHEEL_SLOTS - 1u)];
+  Task_t *due = NULL;
+  while (*pp) {
+    Task_t *t = *pp;
+    if (t->due == tick) {                    /* unlink, run after the scan */
+      *pp = t->slot_next;
+      t->slot_next = due;
+      due = t;
+    } else {
+      pp = &t->slot_next;
+    }
+  }
+  while (due) {
+    Task_t *t = due;
+    due = t->slot_next;
+    uint32_t lat = now - tick;
+    if (lat > t->max_latency) t->max_latency = lat;
+    if (t->deadline && lat > t->deadline) t->misses++;
+    sched_dispatch(t, 0, t0);
+    t->due += t->period;
+    if ((int32_t)(t->due - now) <= 0) {      /* overran whole periods: skip them */
+      t->due = now + t->period;
+    }
+    sched_wheel_insert(t);
+  }
+}
+
+/* One pass; returns false when it went to sleep */
+bool sched_run_once(void)
+{
+  uint32_t t0 = SCHED_CYCLES();
+  uint32_t now = HAL_GetTick();
+  bool ran = false;
+
+  while (sched_tick != now) {
+    sched_tick++;
+    uint32_t before = sched_stats.dispatches;
+    sched_advance(sched_tick, now, &t0);
+    ran |= sched_stats.dispatches != before;
+  }
+
+  __disable_irq();
+  uint32_t ev = sched_events;
+  sched_events = 0;
+  __enable_irq();
+  if (ev) {
+    for (Task_t *t = sched_tasks; t; t = t->all_next) {
+      if (t->events & ev) sched_dispatch(t, t->events & ev, &t0);
+    }
+    ran = true;
+  }
+  if (ran) {
+    sched_stats.overhead += SCHED_CYCLES() - t0;
+    return true;
+  }
+
+  /* IRQs masked so an event posted after the check still ends the WFI */
+  __disable_irq();
+  if (!sched_events && HAL_GetTick() == sched_tick) {
+    uint32_t s = SCHED_CYCLES();
+    sched_stats.overhead += s - t0;
+    __WFI();
+    sched_stats.idle += SCHED_CYCLES() - s;
+  } else {
+    sched_stats.overhead += SCHED_CYCLES() - t0;
+  }
+  __enable_irq();
+  return false;
+}
+
+/* Demo: the loops of 04 (PWM ramp), 09 (RTC print) and 10 (button) as tasks */
+TIM_HandleTypeDef htim3;
+RTC_HandleTypeDef hrtc;
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef  hdma_usart2_tx;
+
+static void task_pwm_ramp(uint32_t ev)
+{
+  static uint32_t duty;
+  (void)ev;
+  __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, duty);
+  duty = (duty + 50u) % 1000u;
+}
+
+static void task_rtc_print(uint32_t ev)
+{
+  RTC_TimeTypeDef t; RTC_DateTypeDef d;
+  (void)ev;
+  HAL_RTC_GetTime(&hrtc, &t, RTC_FORMAT_BIN);
+  HAL_RTC_GetDate(&hrtc, &d, RTC_FORMAT_BIN);   // must read date after time
+  printf("%02u:%02u:%02u\r\n", t.Hours, t.Minutes, t.Seconds);
+}
+
+static void task_button(uint32_t ev)
+{
+  if (ev & EV_BUTTON) HAL_GPIO_TogglePin(GPIOA, GPIO_PIN_5);
+}
+
+static void task_stats(uint32_t ev)
+{
+  (void)ev;
+  uint32_t total = sched_stats.idle + sched_stats.task + sched_stats.overhead;
+  if (!total) return;
+  printf("idle %lu%%, sched %lu cyc/dispatch\r\n",
+         (unsigned long)((uint64_t)sched_stats.idle * 100u / total),
+         (unsigned long)(sched_stats.dispatches ? sched_stats.overhead / sched_stats.dispatches : 0u));
+  sched_stats.idle = sched_stats.task = sched_stats.overhead = sched_stats.dispatches = 0;
+}
+
+static Task_t t_pwm    = { .fn = task_pwm_ramp,  .period = 50,   .deadline = 5 };
+static Task_t t_rtc    = { .fn = task_rtc_print, .period = 1000, .deadline = 50 };
+static Task_t t_button = { .fn = task_button,    .events = EV_BUTTON };
+static Task_t t_stats  = { .fn = task_stats,     .period = 5000 };
+
+void EXTI0_IRQHandler(void){ HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_0); }
+void HAL_GPIO_EXTI_Callback(uint16_t pin){ if (pin == GPIO_PIN_0) sched_post(EV_BUTTON); }
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_complete(); }
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_error(); }
+void DMA1_Stream6_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_usart2_tx); }
+void USART2_IRQHandler(void){ HAL_UART_IRQHandler(&huart2); }
+
+static void MX_TIM3_Init(void)
+{
+  __HAL_RCC_TIM3_CLK_ENABLE();
+  TIM_OC_InitTypeDef sConfig = {0};
+  htim3.Instance = TIM3;
+  htim3.Init.Prescaler = 7999;   // adjust for your clock
+  htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim3.Init.Period = 999;
+  htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  HAL_TIM_PWM_Init(&htim3);
+  sConfig.OCMode = TIM_OCMODE_PWM1;
+  sConfig.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfig.OCFastMode = TIM_OCFAST_DISABLE;
+  HAL_TIM_PWM_ConfigChannel(&htim3, &sConfig, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+}
+
+static void MX_RTC_Init(void)
+{
+  __HAL_RCC_RTC_ENABLE();
+  hrtc.Instance = RTC;
+  hrtc.Init.HourFormat = RTC_HOURFORMAT_24;
+  hrtc.Init.AsynchPrediv = 127;
+  hrtc.Init.SynchPrediv = 255;
+  hrtc.Init.OutPut = RTC_OUTPUT_DISABLE;
+  HAL_RTC_Init(&hrtc);
+}
+
+static void MX_USART2_UART_Init(void)
+{
+  __HAL_RCC_USART2_CLK_ENABLE();
+  huart2.Instance = USART2;
+  huart2.Init.BaudRate = 115200;
+  huart2.Init.WordLength = UART_WORDLENGTH_8B;
+  huart2.Init.StopBits = UART_STOPBITS_1;
+  huart2.Init.Parity = UART_PARITY_NONE;
+  huart2.Init.Mode = UART_MODE_TX_RX;
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
+  HAL_UART_Init(&huart2);
+
+  // log TX by DMA (21_uart_log.c); example (F4): USART2_TX = DMA1 stream 6 ch 4
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_usart2_tx.Instance = DMA1_Stream6;
+  hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+  hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+  hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+  HAL_DMA_Init(&hdma_usart2_tx);
+  __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);   // TC after the last byte: HAL_UART_TxCpltCallback
+  HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+
+int main(void)
+{
+  HAL_Init();
+  SystemClock_Config();
+  MX_GPIO_Init();
+  MX_USART2_UART_Init();
+  uart_log_init(&huart2);
+  MX_TIM3_Init();
+  MX_RTC_Init();
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  sched_tick = HAL_GetTick();
+  sched_add(&t_pwm, 0);
+  sched_add(&t_rtc, 0);
+  sched_add(&t_button, 0);
+  sched_add(&t_stats, 5000);
+  for(;;){ sched_run_once(); }
+}
+
+static void MX_GPIO_Init(void)
+{
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  GPIO_InitTypeDef g = {0};
+  g.Pin = GPIO_PIN_5; g.Mode = GPIO_MODE_OUTPUT_PP; g.Pull = GPIO_NOPULL; g.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOA, &g);
+  g.Pin = GPIO_PIN_0; g.Mode = GPIO_MODE_IT_FALLING; g.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(GPIOA, &g);
+  HAL_NVIC_SetPriority(EXTI0_IRQn, 2, 0);
+  HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+  // Configure alternate function pin for TIM3 CH1 as needed
+}
+
+void SystemClock_Config(void){ /* device specific */ }
@@ -0,0 +1,145 @@
+/* STM32 HAL template: PWM waveforms streamed by timer-update DMA
+ * Practice: duty lookup tables, circular DMA into CCR, preload for glitch-free updates.
+ *
+ * 04_timer_pwm.c sets the duty from the main loop every 50 ms, so every sample
+ * carries the loop's jitter. Here the tables are generated once at init and the
+ * TIM3 update event requests a DMA transfer of the next sample into CCR1. With
+ * CCR preload (set by HAL for PWM modes) the new value takes effect exactly at
+ * the next period. Circular mode repeats the table without any CPU work:
+ *   f_wave = f_timer / (PSC + 1) / (ARR + 1) / WAVE_LEN
+ * The wave_gen_* functions use no HAL and build on the host for testing.
+ */
+#include <stdint.h>
+#include <math.h>
+#include "stm32xx_hal.h"
+
+#define WAVE_LEN  256u      /* samples per waveform period */
+#define WAVE_ARR  999u      /* PWM period - 1, duty range 0..WAVE_ARR */
+
+TIM_HandleTypeDef htim3;
+DMA_HandleTypeDef hdma_tim3_up;
+
+static uint16_t wave_ramp[WAVE_LEN];
+static uint16_t wave_sine[WAVE_LEN];
+static uint16_t wave_scurve[WAVE_LEN];
+
+static int32_t div_round(int64_t a, int64_t b)   /* b > 0 */
+{
+  return (int32_t)(a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b));
+}
+
+/* Linear lo -> hi; hi < lo gives a falling ramp. Both ends are exact */
+void wave_gen_ramp(uint16_t *t, uint32_t n, uint16_t lo, uint16_t hi)
+{
+  int32_t span = (int32_t)hi - (int32_t)lo;
+  for (uint32_t i = 0; i < n; ++i) {
+    t[i] = (uint16_t)(lo + (n > 1u ? div_round((int64_t)span * i, n - 1u) : 0));
+  }
+}
+
+/* One sine period around (lo + hi) / 2, starting at the midpoint */
+void wave_gen_sine(uint16_t *t, uint32_t n, uint16_t lo, uint16_t hi)
+{
+  float mid = 0.5f * ((float)lo + (float)hi);
+  float amp = 0.5f * ((float)hi - (float)lo);
+  for (uint32_t i = 0; i < n; ++i) {
+    float v = mid + amp * sinf(6.2831853f * (float)i / (float)n);
+    if (v < (float)lo) v = lo;
+    if (v > (float)hi) v = hi;
+    t[i] = (uint16_t)(v + 0.5f);
+  }
+}
+
+/* Smoothstep 3x^2 - 2x^3 with x = i/m, exact up to the final rounding: zero slope
+ * at both ends, for axis moves. n <= 4096 keeps span * i^2 * (3m - 2i) in 64 bits */
+void wave_gen_scurve(uint16_t *t, uint32_t n, uint16_t lo, uint16_t hi)
+{
+  int32_t span = (int32_t)hi - (int32_t)lo;
+  int64_t m = n > 1u ? (int64_t)n - 1 : 1;
+  for (uint32_t i = 0; i < n; ++i) {
+    int64_t num = (int64_t)i * i * (3 * m - 2 * (int64_t)i);           /* x^2 (3 - 2x) * m^3 */
+    t[i] = (uint16_t)(lo + div_round(span * num, m * m * m));
+  }
+}
+
+/* Switch the running waveform; takes effect at the next update event */
+void wave_play(const uint16_t *tab, uint32_t n)
+{
+  __HAL_TIM_DISABLE_DMA(&htim3, TIM_DMA_UPDATE);
+  HAL_DMA_Abort(&hdma_tim3_up);
+  HAL_DMA_Start(&hdma_tim3_up, (uint32_t)(uintptr_t)tab, (uint32_t)(uintptr_t)&TIM3->CCR1, n);
+  __HAL_TIM_ENABLE_DMA(&htim3, TIM_DMA_UPDATE);
+}
+
+static void MX_DMA_Init(void)
+{
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_tim3_up.Instance = DMA1_Stream2;        // example (F4: TIM3_UP = DMA1 stream 2, channel 5)
+  hdma_tim3_up.Init.Channel = DMA_CHANNEL_5;
+  hdma_tim3_up.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_tim3_up.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_tim3_up.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_tim3_up.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+  hdma_tim3_up.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+  hdma_tim3_up.Init.Mode = DMA_CIRCULAR;
+  hdma_tim3_up.Init.Priority = DMA_PRIORITY_HIGH;
+  HAL_DMA_Init(&hdma_tim3_up);
+  __HAL_LINKDMA(&htim3, hdma[TIM_DMA_ID_UPDATE], hdma_tim3_up);
+}
+
+static void MX_TIM3_Init(void)
+{
+  __HAL_RCC_TIM3_CLK_ENABLE();
+  TIM_OC_InitTypeDef sConfig = {0};
+
+  htim3.Instance = TIM3;
+  htim3.Init.Prescaler = 83;     // 84 MHz -> 1 MHz tick, adjust for your clock
+  htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim3.Init.Period = WAVE_ARR;  // 1 kHz PWM, 256 ms per table pass
+  htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  HAL_TIM_PWM_Init(&htim3);
+
+  sConfig.OCMode = TIM_OCMODE_PWM1;
+  sConfig.Pulse = 0;
+  sConfig.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfig.OCFastMode = TIM_OCFAST_DISABLE;
+  HAL_TIM_PWM_ConfigChannel(&htim3, &sConfig, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+}
+
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+
+int main(void)
+{
+  HAL_Init();
+  SystemClock_Config();
+  MX_GPIO_Init();
+  MX_DMA_Init();
+  MX_TIM3_Init();
+
+  wave_gen_ramp(wave_ramp, WAVE_LEN, 0, WAVE_ARR);
+  wave_gen_sine(wave_sine, WAVE_LEN, 0, WAVE_ARR);
+  wave_gen_scurve(wave_scurve, WAVE_LEN, 0, WAVE_ARR);
+
+  const uint16_t *tabs[] = { wave_ramp, wave_sine, wave_scurve };
+  uint32_t k = 0, last = HAL_GetTick();
+  wave_play(tabs[k], WAVE_LEN);
+  while (1) {
+    if (HAL_GetTick() - last >= 2000u) {     // only table switches need the CPU
+      last = HAL_GetTick();
+      k = (k + 1u) % 3u;
+      wave_play(tabs[k], WAVE_LEN);
+    }
+    __WFI();
+  }
+}
+
+static void MX_GPIO_Init(void)
+{
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  // Configure alternate function pin for TIM3 CH1 as needed
+}
+
+void SystemClock_Config(void) { /* device specific */ }
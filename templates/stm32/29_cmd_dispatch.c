@@ -0,0 +1,119 @@
+/* Command dispatcher for the motion-control protocol
+ * Purpose: map the opcode of a normalized command (">MA090.000#", ">Z#") to its
+ *          handler through a perfect hash, parse the argument as fixed point.
+ *
+ *   key  = op[0] | op[1] << 8             (one or two capital letters)
+ *   slot = (uint16_t)(key * CMD_HASH_MULT) >> (16 - CMD_HASH_BITS)
+ *
+ * CMD_HASH_MULT comes from tools/gen_cmd_hash.py for the opcode list below; rerun
+ * it when adding an opcode. The table is filled by designated initializers, so a
+ * collision shows up as -Woverride-init at compile time. Lookup is one multiply
+ * and one compare, the argument is read in place (no copy, no strtod/strtoul).
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* python tools/gen_cmd_hash.py MA MR SP RF ST Z EN DI */
+#define CMD_HASH_BITS  3u
+#define CMD_HASH_MULT  0x01DFu
+
+#define CMD_KEY(a, b)  ((uint16_t)((uint8_t)(a) | ((uint16_t)(uint8_t)(b) << 8)))
+#define CMD_SLOT(key)  ((uint16_t)((uint16_t)((key) * CMD_HASH_MULT) >> (16u - CMD_HASH_BITS)))
+
+typedef enum { CMD_OK = 0, CMD_ERR_FORMAT, CMD_ERR_UNKNOWN, CMD_ERR_ARG } CmdStatus_t;
+typedef enum { CMD_ARG_NONE, CMD_ARG_OPTIONAL, CMD_ARG_REQUIRED } CmdArg_t;
+
+/* arg: value in thousandths ("090.000" -> 90000), 0 when has_arg is false */
+typedef void (*CmdFn)(int32_t arg, bool has_arg);
+
+typedef struct {
+    uint16_t key;    /* 0: empty slot */
+    uint8_t  args;   /* CmdArg_t */
+    CmdFn    fn;
+} CmdEntry_t;
+
+/* Placeholders you should adapt to your project */
+void cmd_move_abs(int32_t arg, bool has_arg);   /* MA: position in milli-units */
+void cmd_move_rel(int32_t arg, bool has_arg);   /* MR */
+void cmd_speed(int32_t arg, bool has_arg);      /* SP */
+void cmd_reference(int32_t arg, bool has_arg);  /* RF */
+void cmd_stop(int32_t arg, bool has_arg);       /* ST */
+void cmd_status(int32_t arg, bool has_arg);     /* Z: answer with a Z frame */
+void cmd_enable(int32_t arg, bool has_arg);     /* EN */
+void cmd_disable(int32_t arg, bool has_arg);    /* DI */
+
+#define CMD_ENTRY(a, b, args, fn)  [CMD_SLOT(CMD_KEY(a, b))] = { CMD_KEY(a, b), (args), (fn) }
+
+static const CmdEntry_t cmd_table[1u << CMD_HASH_BITS] = {
+    CMD_ENTRY('M', 'A', CMD_ARG_REQUIRED, cmd_move_abs),
+    CMD_ENTRY('M', 'R', CMD_ARG_REQUIRED, cmd_move_rel),
+    CMD_ENTRY('S', 'P', CMD_ARG_REQUIRED, cmd_speed),
+    CMD_ENTRY('R', 'F', CMD_ARG_NONE,     cmd_reference),
+    CMD_ENTRY('S', 'T', CMD_ARG_NONE,     cmd_stop),
+    CMD_ENTRY('Z', 0,   CMD_ARG_NONE,     cmd_status),
+    CMD_ENTRY('E', 'N', CMD_ARG_NONE,     cmd_enable),
+    CMD_ENTRY('D', 'I', CMD_ARG_OPTIONAL, cmd_disable),
+};
+
+/* [-]digits[.ddd] in [p, end) -> thousandths; at most 3 decimals, fits int32 */
+static bool cmd_parse_milli(const char *p, const char *end, int32_t *out)
+{
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+
+    int64_t v = 0;
+    uint32_t digits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p++ - '0');
+        if (v > INT32_MAX / 1000 + 1) return false;
+        digits++;
+    }
+    uint32_t frac = 0;
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (frac == 3u) return false;          /* finer than the scale */
+            v = v * 10 + (*p++ - '0');
+            frac++;
+            digits++;
+        }
+    }
+    if (p != end || digits == 0) return false;
+    for (; frac < 3u; ++frac) v *= 10;
+    if (neg) v = -v;
+    if (v > INT32_MAX || v < -INT32_MAX) return false;
+    *out = (int32_t)v;
+    return true;
+}
+
+/* cmd/len as returned by normalize_command(); the buffer is only read */
+CmdStatus_t cmd_dispatch(const char *cmd, size_t len)
+{
+    if (len < 3 || cmd[0] != '>' || cmd[len - 1] != '#') return CMD_ERR_FORMAT;
+    const char *p = cmd + 1;
+    const char *end = cmd + len - 1;
+
+    uint16_t key = 0;
+    uint32_t n = 0;
+    while (p < end && *p >= 'A' && *p <= 'Z') {
+        if (n == 2u) return CMD_ERR_UNKNOWN;
+        key |= (uint16_t)((uint8_t)*p++ << (8u * n++));
+    }
+    if (n == 0) return CMD_ERR_FORMAT;
+
+    const CmdEntry_t *e = &cmd_table[CMD_SLOT(key)];
+    if (e->key != key) return CMD_ERR_UNKNOWN;
+
+    int32_t arg = 0;
+    bool has_arg = (p != end);
+    if (has_arg ? e->args == CMD_ARG_NONE : e->args == CMD_ARG_REQUIRED) return CMD_ERR_ARG;
+    if (has_arg && !cmd_parse_milli(p, end, &arg)) return CMD_ERR_ARG;
+    e->fn(arg, has_arg);
+    return CMD_OK;
+}
+
+/* Example (after reception):
+ *   size_t n = normalize_command(buf, sizeof buf);
+ *   if (cmd_dispatch(buf, n) != CMD_OK) { ... reply with an error ... }
+ */
@@ -0,0 +1,189 @@
+/* STM32 HAL template: DWT hot-path profiler
+ * Practice: cycle counter probes, fixed stats table, compact binary dump.
+ *
+ *   PROFILE_BEGIN(PROF_PARSE_Z);
+ *   parse_z_frame(frame);
+ *   PROFILE_END(PROF_PARSE_Z);
+ *
+ * Each probe keeps count/min/max/sum of DWT cycles (minus the measured cost of an
+ * empty BEGIN/END pair). profile_dump() writes the table through __io_putchar
+ * (21_uart_log.c) as one binary record that tools/profile_report.py finds in the
+ * log stream and prints as a sorted report. The record is COBS encoded and sent
+ * between two 0x00, framed like the records of 32_binlog.c, so it shares the
+ * port with printf text and binlog records. With PROFILE_ENABLE 0 the macros
+ * expand to nothing and no table is linked. Host builds define PROFILE_CYCLES()
+ * to read a variable; the DWT is then left alone.
+ *
+ * Record, little endian, before COBS:
+ *   'P' 'F' ver=2 | cpu_mhz u16 | n u8 | n x { id u8, len u8, name[len],
+ *   count u32, min u32, max u32, sum u64 } | checksum u8 (sum of all bytes before)
+ */
+#include <stdint.h>
+#include "stm32xx_hal.h" // replace with your series header
+
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE 1
+#endif
+#ifndef PROFILE_CYCLES
+#define PROFILE_CYCLES() (DWT->CYCCNT)
+#define PROFILE_USE_DWT  1
+#endif
+
+/* Probe ids; add a name below for each */
+typedef enum {
+    PROF_PARSE_Z,
+    PROF_MEASURE_TEMP,
+    PROF_NORMALIZE_CMD,
+    PROF_UART_RX_CB,
+    PROF_COUNT
+} ProfileId_t;
+
+#if PROFILE_ENABLE
+
+#define PROFILE_BEGIN(id)  uint32_t prof_t0_##id = PROFILE_CYCLES()
+#define PROFILE_END(id)    profile_record((id), PROFILE_CYCLES() - prof_t0_##id)
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} ProfileStat_t;
+
+static const char *const prof_names[PROF_COUNT] = {
+    [PROF_PARSE_Z]       = "parse_z_frame",
+    [PROF_MEASURE_TEMP]  = "measure_temperatures",
+    [PROF_NORMALIZE_CMD] = "normalize_command",
+    [PROF_UART_RX_CB]    = "uart_rx_event_cb",
+};
+
+static ProfileStat_t prof_stat[PROF_COUNT];
+static uint32_t      prof_overhead;
+
+int __io_putchar(int ch);
+
+void profile_record(ProfileId_t id, uint32_t cycles)
+{
+    cycles = cycles > prof_overhead ? cycles - prof_overhead : 0u;
+    uint32_t pm = __get_PRIMASK();
+    __disable_irq();                           /* probes may also sit in ISRs */
+    ProfileStat_t *s = &prof_stat[id];
+    if (s->count == 0 || cycles < s->min) s->min = cycles;
+    if (cycles > s->max) s->max = cycles;
+    s->sum += cycles;
+    s->count++;
+    __set_PRIMASK(pm);
+}
+
+void profile_reset(void)
+{
+    uint32_t pm = __get_PRIMASK();
+    __disable_irq();
+    for (uint32_t i = 0; i < PROF_COUNT; ++i) prof_stat[i] = (ProfileStat_t){0};
+    __set_PRIMASK(pm);
+}
+
+/* Cost of an empty BEGIN/END pair, subtracted from every sample */
+void profile_init(void)
+{
+#ifdef PROFILE_USE_DWT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    uint32_t best = UINT32_MAX;
+    for (uint32_t i = 0; i < 16u; ++i) {
+        uint32_t t0 = PROFILE_CYCLES();
+        uint32_t t1 = PROFILE_CYCLES();
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+    prof_overhead = best;
+    profile_reset();
+}
+
+/* COBS on the fly, the same encoding as blog_cobs_encode(): up to 254
+ * non-zero bytes are held back until their length code is known */
+typedef struct {
+    uint8_t blk[254];
+    uint8_t n;
+    uint8_t sum;
+} ProfCobs_t;
+
+static void prof_block(ProfCobs_t *c)
+{
+    __io_putchar(c->n + 1u);
+    for (uint32_t i = 0; i < c->n; ++i) __io_putchar(c->blk[i]);
+    c->n = 0;
+}
+
+static void prof_put(ProfCobs_t *c, const void *p, uint32_t n)
+{
+    const uint8_t *b = p;
+    while (n--) {
+        uint8_t v = *b++;
+        c->sum = (uint8_t)(c->sum + v);
+        if (v == 0u) {
+            prof_block(c);                     /* the 0x00 becomes the code */
+            continue;
+        }
+        c->blk[c->n++] = v;
+        if (c->n == sizeof c->blk) prof_block(c);
+    }
+}
+
+/* Little endian core: the fields go out as they are in memory */
+void profile_dump(void)
+{
+    uint8_t  hdr[6] = { 'P', 'F', 2u, 0u, 0u, PROF_COUNT };
+    uint16_t mhz = (uint16_t)(SystemCoreClock / 1000000u);
+    hdr[3] = (uint8_t)mhz;
+    hdr[4] = (uint8_t)(mhz >> 8);
+    ProfCobs_t c;
+    c.n = 0;
+    c.sum = 0;
+    __io_putchar(0);                           /* ends printf text sent before */
+    prof_put(&c, hdr, sizeof hdr);
+
+    for (uint32_t i = 0; i < PROF_COUNT; ++i) {
+        ProfileStat_t s;
+        uint32_t pm = __get_PRIMASK();
+        __disable_irq();
+        s = prof_stat[i];                      /* consistent snapshot of one probe */
+        __set_PRIMASK(pm);
+
+        const char *name = prof_names[i];
+        uint8_t len = 0;
+        while (name[len] && len < 255u) ++len;
+        uint8_t id_len[2] = { (uint8_t)i, len };
+        prof_put(&c, id_len, 2);
+        prof_put(&c, name, len);
+        prof_put(&c, &s.count, 4);
+        prof_put(&c, &s.min, 4);
+        prof_put(&c, &s.max, 4);
+        prof_put(&c, &s.sum, 8);
+    }
+    uint8_t sum = c.sum;
+    prof_put(&c, &sum, 1);
+    prof_block(&c);                            /* last block, its 0x00 implied */
+    __io_putchar(0);
+}
+
+#else  /* PROFILE_ENABLE == 0: no code, no data */
+
+#define PROFILE_BEGIN(id)  do { } while (0)
+#define PROFILE_END(id)    do { } while (0)
+#define profile_init()     do { } while (0)
+#define profile_reset()    do { } while (0)
+#define profile_dump()     do { } while (0)
+
+#endif
+
+/* Example: around the UART RX callback of 17_uart_rx_ring.c
+ *   void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t pos)
+ *   {
+ *       PROFILE_BEGIN(PROF_UART_RX_CB);
+ *       ...
+ *       PROFILE_END(PROF_UART_RX_CB);
+ *   }
+ * and every few seconds from the main loop:
+ *   profile_dump(); uart_log_flush(); profile_reset();
+ */
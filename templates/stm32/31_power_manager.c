@@ -0,0 +1,361 @@
+/* STM32 HAL template: power manager with wake-source accounting
+ * Practice: pick SLEEP/STOP/STANDBY from the next deadline, RTC wakeup timer,
+ *           fast clock restore after STOP, time/latency statistics per state.
+ *
+ * 10_low_power_stop.c enters STOP unconditionally and reconfigures clocks through
+ * a stub. Here pm_idle(deadline) chooses the deepest state that still wakes up in
+ * time: WFI for short gaps, STOP with the RTC wakeup timer for longer ones, and
+ * STANDBY (RAM lost, reset on wake) only when nothing is scheduled and the
+ * application allows it. After STOP the PLL is restarted from the register values
+ * captured once SystemClock_Config() had succeeded; if HSE or PLL do not come up in
+ * time the full SystemClock_Config() runs instead. HAL ticks are advanced by the
+ * time spent in STOP so HAL_GetTick() based deadlines stay right.
+ * The UART logger (21_uart_log.c) is drained before STOP and STANDBY, as long as
+ * the budget allows; pm_report() prints the figures of the last report window.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32xx_hal.h"
+#include "uart_log.h" // __io_putchar from 21_uart_log.c
+
+#define PM_NO_DEADLINE      0xFFFFFFFFUL
+#define PM_STOP_MIN_MS      3u       /* below: STOP entry + clock restore costs more than it saves */
+#define PM_STANDBY_MIN_MS   60000u   /* only for long, unscheduled idle */
+#define PM_CLK_TIMEOUT      50000u   /* polls for HSE/PLL ready before giving up */
+
+/* Typical currents for the battery estimate, adapt to your board (uA) */
+#define PM_I_RUN_UA         20000u
+#define PM_I_SLEEP_UA       6000u
+#define PM_I_STOP_UA        300u
+
+typedef enum { PM_RUN, PM_SLEEP, PM_STOP, PM_STANDBY, PM_STATES } PmState_t;
+typedef enum { PM_WAKE_RTC, PM_WAKE_BUTTON, PM_WAKE_OTHER, PM_WAKE_SOURCES } PmWake_t;
+
+RTC_HandleTypeDef hrtc;
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef  hdma_usart2_tx;
+extern __IO uint32_t uwTick;               // HAL tick counter
+
+static const char *const pm_state_name[PM_STATES] = { "run", "sleep", "stop", "standby" };
+static const char *const pm_wake_name[PM_WAKE_SOURCES] = { "rtc", "button", "other" };
+
+static struct {
+  uint32_t entries[PM_STATES];
+  uint32_t ms[PM_STATES];
+  uint32_t wakes[PM_WAKE_SOURCES];
+  uint32_t lat_sum_us[PM_WAKE_SOURCES];    /* wake ISR entry -> clocks restored */
+  uint32_t lat_max_us[PM_WAKE_SOURCES];
+  uint32_t clk_fallbacks;
+  uint32_t since;                          /* HAL_GetTick() at the last report */
+} pm;
+
+static struct { uint32_t pllcfgr, cfgr; bool valid; } pm_clk;
+static volatile PmWake_t pm_wake_src;
+static volatile uint32_t pm_wake_cyc;      /* DWT->CYCCNT at the first wake ISR */
+static volatile bool pm_wake_seen;
+static bool pm_standby_allowed;
+
+void SystemClock_Config(void);
+
+/* STANDBY loses RAM and GPIO state: only allow it where the app can restart cleanly */
+void pm_allow_standby(bool allow){ pm_standby_allowed = allow; }
+
+/* Remember the working clock tree; call after SystemClock_Config() */
+static void pm_clock_capture(void)
+{
+  pm_clk.pllcfgr = RCC->PLLCFGR;
+  pm_clk.cfgr = RCC->CFGR;
+  pm_clk.valid = (RCC->CFGR & RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL && (RCC->CR & RCC_CR_HSERDY);
+}
+
+static bool pm_wait(uint32_t mask)
+{
+  for (uint32_t n = 0; n < PM_CLK_TIMEOUT; ++n) {
+    if (RCC->CR & mask) return true;
+  }
+  return false;
+}
+
+/* STOP leaves the system on HSI with HSE and PLL off; flash latency and the PLL
+ * dividers survive, so only the oscillators and the switch are redone */
+static void pm_clock_restore(void)
+{
+  if (pm_clk.valid) {
+    RCC->CR |= RCC_CR_HSEON;
+    if (pm_wait(RCC_CR_HSERDY) && RCC->PLLCFGR == pm_clk.pllcfgr) {
+      RCC->CR |= RCC_CR_PLLON;
+      if (pm_wait(RCC_CR_PLLRDY)) {
+        RCC->CFGR = pm_clk.cfgr;           /* prescalers + SW = PLL */
+        for (uint32_t n = 0; n < PM_CLK_TIMEOUT; ++n) {
+          if ((RCC->CFGR & RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL) return;
+        }
+      }
+    }
+  }
+  pm.clk_fallbacks++;
+  SystemClock_Config();
+}
+
+/* After STOP the calendar shadow registers still hold the time from before the
+ * sleep until the next RTCCLK sync: clear RSF and wait for it (RM: "RTC
+ * synchronization" after low-power modes) */
+static void pm_rtc_resync(void)
+{
+  __HAL_RTC_WRITEPROTECTION_DISABLE(&hrtc);
+  HAL_RTC_WaitForSynchro(&hrtc);
+  __HAL_RTC_WRITEPROTECTION_ENABLE(&hrtc);
+}
+
+/* RTC time of day in ms, works while SysTick is stopped */
+static uint32_t pm_rtc_ms(void)
+{
+  RTC_TimeTypeDef t; RTC_DateTypeDef d;
+  HAL_RTC_GetTime(&hrtc, &t, RTC_FORMAT_BIN);
+  HAL_RTC_GetDate(&hrtc, &d, RTC_FORMAT_BIN);   // unlocks the shadow registers
+  uint32_t sub = (t.SecondFraction - t.SubSeconds) * 1000u / (t.SecondFraction + 1u);
+  return ((t.Hours * 60u + t.Minutes) * 60u + t.Seconds) * 1000u + sub;
+}
+
+static uint32_t pm_rtc_elapsed(uint32_t from)
+{
+  uint32_t now = pm_rtc_ms();
+  return now >= from ? now - from : now + 86400000u - from;   /* midnight */
+}
+
+/* LSE/16 = 2048 Hz up to 32 s, 1 Hz beyond */
+static void pm_arm_wakeup(uint32_t ms)
+{
+  if (ms <= 32000u) {
+    HAL_RTCEx_SetWakeUpTimer_IT(&hrtc, ms * 2048u / 1000u - 1u, RTC_WAKEUPCLOCK_RTCCLK_DIV16);
+  } else {
+    uint32_t s = ms / 1000u;
+    HAL_RTCEx_SetWakeUpTimer_IT(&hrtc, (s > 65536u ? 65536u : s) - 1u, RTC_WAKEUPCLOCK_CK_SPRE_16BITS);
+  }
+}
+
+/* First thing in the wake ISRs: the ISR and whatever else is pending run before
+ * HAL_PWR_EnterSTOPMode() returns, so a stamp taken after it would miss them.
+ * CYCCNT is frozen in STOP, the time from the event to the ISR is not counted. */
+static void pm_wake_isr(PmWake_t src)
+{
+  if (pm_wake_seen) return;                /* keep the source that ended the sleep */
+  pm_wake_cyc = DWT->CYCCNT;
+  pm_wake_src = src;
+  pm_wake_seen = true;
+}
+
+static void pm_account_wake(void)
+{
+  if (!pm_wake_seen) pm_wake_cyc = DWT->CYCCNT;   /* PM_WAKE_OTHER: no ISR of ours, from here */
+  PmWake_t src = pm_wake_src;
+  uint32_t cyc = DWT->CYCCNT - pm_wake_cyc; /* the restore runs on HSI until the final switch */
+  uint32_t us = cyc / (HSI_VALUE / 1000000u);
+  pm.wakes[src]++;
+  pm.lat_sum_us[src] += us;
+  if (us > pm.lat_max_us[src]) pm.lat_max_us[src] = us;
+}
+
+static uint32_t pm_budget(uint32_t deadline)
+{
+  if (deadline == PM_NO_DEADLINE) return PM_NO_DEADLINE;
+  int32_t left = (int32_t)(deadline - HAL_GetTick());
+  return left > 0 ? (uint32_t)left : 0u;
+}
+
+/* deadline: HAL_GetTick() value of the next scheduled work, or PM_NO_DEADLINE */
+void pm_idle(uint32_t deadline)
+{
+  uint32_t budget = pm_budget(deadline);
+  if (budget == 0) return;
+
+  uart_log_flush();
+  if (budget >= PM_STOP_MIN_MS) {
+    /* DMA stops in STOP and STANDBY loses RAM: nothing may be in flight */
+    while (!uart_log_idle()) {
+      if (pm_budget(deadline) < PM_STOP_MIN_MS) break;   /* too late for STOP: SLEEP keeps DMA running */
+      __WFI();                             /* DMA/UART or SysTick interrupt */
+      uart_log_flush();
+    }
+    budget = pm_budget(deadline);
+    if (budget == 0) return;
+  }
+  uint32_t now = HAL_GetTick();
+  pm_wake_src = PM_WAKE_OTHER;
+  pm_wake_seen = false;
+
+  if (budget < PM_STOP_MIN_MS) {
+    pm.entries[PM_SLEEP]++;
+    HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    pm.ms[PM_SLEEP] += HAL_GetTick() - now;
+    return;
+  }
+
+  if (budget == PM_NO_DEADLINE && pm_standby_allowed) {
+    pm.entries[PM_STANDBY]++;
+    HAL_PWR_EnableBkUpAccess();            /* backup domain is write protected after reset */
+    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR0, pm_rtc_ms());
+    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR1, HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR1) + 1u);
+    pm_arm_wakeup(PM_STANDBY_MIN_MS);
+    __HAL_PWR_CLEAR_FLAG(PWR_FLAG_WU);
+    HAL_PWR_EnterSTANDBYMode();            /* does not return: wake is a reset */
+  }
+
+  uint32_t t0 = pm_rtc_ms();
+  pm.entries[PM_STOP]++;
+  pm_arm_wakeup(budget == PM_NO_DEADLINE ? PM_STANDBY_MIN_MS : budget);
+  HAL_SuspendTick();
+  HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+  pm_clock_restore();
+  HAL_ResumeTick();
+  pm_account_wake();
+  HAL_RTCEx_DeactivateWakeUpTimer(&hrtc);
+  pm_rtc_resync();                         /* else the read below returns the time of t0 */
+
+  uint32_t slept = pm_rtc_elapsed(t0);
+  uwTick += slept;                         /* SysTick was stopped */
+  pm.ms[PM_STOP] += slept;
+}
+
+/* After reset: count a STANDBY wake and its duration from the backup registers */
+static void pm_boot(void)
+{
+  if (__HAL_PWR_GET_FLAG(PWR_FLAG_SB)) {
+    __HAL_PWR_CLEAR_FLAG(PWR_FLAG_SB);
+    pm_rtc_resync();
+    pm.ms[PM_STANDBY] = pm_rtc_elapsed(HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR0));
+  }
+  pm.entries[PM_STANDBY] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR1);
+  pm.since = HAL_GetTick();
+}
+
+/* Prints the window since the previous report, then starts a new one */
+void pm_report(void)
+{
+  uint32_t now = HAL_GetTick();
+  uint32_t total = now - pm.since;
+  uint32_t low = pm.ms[PM_SLEEP] + pm.ms[PM_STOP];
+  pm.ms[PM_RUN] = total > low ? total - low : 0u;
+
+  printf("PM build %s %s, %lu ms\r\n", __DATE__, __TIME__, (unsigned long)total);
+  for (uint32_t s = 0; s < PM_STATES; ++s) {
+    printf("  %-7s %6lu x %8lu ms\r\n", pm_state_name[s], (unsigned long)pm.entries[s], (unsigned long)pm.ms[s]);
+  }
+  for (uint32_t w = 0; w < PM_WAKE_SOURCES; ++w) {
+    if (!pm.wakes[w]) continue;
+    printf("  wake %-6s %6lu x, latency avg %lu us max %lu us\r\n", pm_wake_name[w], (unsigned long)pm.wakes[w],
+           (unsigned long)(pm.lat_sum_us[w] / pm.wakes[w]), (unsigned long)pm.lat_max_us[w]);
+  }
+  if (total) {
+    uint64_t q = (uint64_t)pm.ms[PM_RUN] * PM_I_RUN_UA + (uint64_t)pm.ms[PM_SLEEP] * PM_I_SLEEP_UA
+               + (uint64_t)pm.ms[PM_STOP] * PM_I_STOP_UA;
+    printf("  est. average %lu uA, clock fallbacks %lu\r\n", (unsigned long)(q / total), (unsigned long)pm.clk_fallbacks);
+  }
+  memset(&pm, 0, sizeof pm);
+  pm.since = now;
+}
+
+/* The IRQ handlers below stamp on entry; the callbacks cover a project whose
+ * handlers live in the generated stm32xx_it.c */
+void HAL_RTCEx_WakeUpTimerEventCallback(RTC_HandleTypeDef *h){ (void)h; pm_wake_isr(PM_WAKE_RTC); }
+void HAL_GPIO_EXTI_Callback(uint16_t pin){ if (pin == GPIO_PIN_0) pm_wake_isr(PM_WAKE_BUTTON); }
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_complete(); }
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_error(); }
+void DMA1_Stream6_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_usart2_tx); }
+void USART2_IRQHandler(void){ HAL_UART_IRQHandler(&huart2); }
+void RTC_WKUP_IRQHandler(void){ pm_wake_isr(PM_WAKE_RTC); HAL_RTCEx_WakeUpTimerIRQHandler(&hrtc); }
+void EXTI0_IRQHandler(void){ pm_wake_isr(PM_WAKE_BUTTON); HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_0); }
+
+static void MX_RTC_Init(void)
+{
+  __HAL_RCC_RTC_ENABLE();
+  hrtc.Instance = RTC;
+  hrtc.Init.HourFormat = RTC_HOURFORMAT_24;
+  hrtc.Init.AsynchPrediv = 127;            // LSE 32768 Hz -> 1 Hz
+  hrtc.Init.SynchPrediv = 255;
+  hrtc.Init.OutPut = RTC_OUTPUT_DISABLE;
+  HAL_RTC_Init(&hrtc);
+  HAL_NVIC_SetPriority(RTC_WKUP_IRQn, 2, 0);
+  HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
+}
+
+static void MX_USART2_UART_Init(void)
+{
+  __HAL_RCC_USART2_CLK_ENABLE();
+  huart2.Instance = USART2;
+  huart2.Init.BaudRate = 115200;
+  huart2.Init.WordLength = UART_WORDLENGTH_8B;
+  huart2.Init.StopBits = UART_STOPBITS_1;
+  huart2.Init.Parity = UART_PARITY_NONE;
+  huart2.Init.Mode = UART_MODE_TX_RX;
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
+  HAL_UART_Init(&huart2);
+
+  // log TX by DMA (21_uart_log.c); example (F4): USART2_TX = DMA1 stream 6 ch 4
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_usart2_tx.Instance = DMA1_Stream6;
+  hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+  hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+  hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+  HAL_DMA_Init(&hdma_usart2_tx);
+  __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);   // TC after the last byte: HAL_UART_TxCpltCallback
+  HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+static void MX_GPIO_Init(void);
+
+int main(void)
+{
+  HAL_Init();
+  SystemClock_Config();
+  pm_clock_capture();
+  MX_GPIO_Init();
+  MX_USART2_UART_Init();
+  uart_log_init(&huart2);
+  MX_RTC_Init();
+  pm_boot();
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  uint32_t next_blink = HAL_GetTick(), next_report = HAL_GetTick() + 10000u;
+  while (1) {
+    uint32_t now = HAL_GetTick();
+    if ((int32_t)(now - next_blink) >= 0) {
+      HAL_GPIO_TogglePin(GPIOA, GPIO_PIN_5);
+      next_blink += 1000u;
+    }
+    if ((int32_t)(now - next_report) >= 0) {
+      pm_report();
+      next_report += 10000u;
+    }
+    uint32_t next = (int32_t)(next_blink - next_report) < 0 ? next_blink : next_report;
+    pm_idle(next);
+  }
+}
+
+static void MX_GPIO_Init(void)
+{
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  GPIO_InitTypeDef g = {0};
+  g.Pin = GPIO_PIN_5; g.Mode = GPIO_MODE_OUTPUT_PP; g.Pull = GPIO_NOPULL; g.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOA, &g);
+
+  g.Pin = GPIO_PIN_0; g.Mode = GPIO_MODE_IT_FALLING; g.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(GPIOA, &g);
+  HAL_NVIC_SetPriority(EXTI0_IRQn, 2, 0);
+  HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+}
+
+void SystemClock_Config(void){ /* device specific */ }
@@ -0,0 +1,165 @@
+/* STM32 HAL template: deferred-formatting binary log
+ * Practice: format strings interned by the linker, raw argument records, COBS framing.
+ *
+ *   BLOG("T1=%d.%02u C T2=%d.%02u C", t1 / 100, t1 % 100, t2 / 100, t2 % 100);
+ *
+ * The format string goes into the "binlog" section, which the linker script keeps
+ * out of flash and places at address 0, so the address of a string is its 16-bit
+ * id. Only the id, a timestamp and the arguments are sent, as LEB128 varints
+ * (signed types zigzag encoded, floats as their 32-bit pattern):
+ *   id u16 | signed u8 | time varint | n x arg varint | checksum u8 (sum of the bytes before)
+ * Bit i of "signed" is set when argument i was zigzag encoded, which follows the
+ * C type of the argument; the decoder undoes it and then formats the 32-bit
+ * value by the conversion, so a value printed with the "wrong" sign comes out
+ * as printf would print it. The record is COBS encoded and sent between two
+ * 0x00, so it can be mixed with printf text from the same port: the leading
+ * 0x00 ends any text before it. tools/binlog_decode.py reads the strings back
+ * from the ELF of the same build and prints the formatted lines.
+ *
+ * Linker script (.ld), after the last output section:
+ *   binlog 0 (INFO) : { KEEP(*(binlog)) }
+ *
+ * Arguments: up to BLOG_MAX_ARGS integers (%d %i %u %x %X %o, 32 bit; %c from a char)
+ * or floats (%f %e %g, sent as float). No %s / %p: the decoder only has the ELF.
+ * The format is checked like printf's.
+ * Output goes through __io_putchar (21_uart_log.c); like printf, call it from one
+ * context only. Host builds set BLOG_BASE to the section start and BLOG_TIME().
+ */
+#include <stdint.h>
+#include <string.h>
+#include "stm32xx_hal.h" // replace with your series header
+
+#ifndef BLOG_TIME
+#define BLOG_TIME() HAL_GetTick()   /* e.g. now_us() from 26_timing.c */
+#endif
+#ifndef BLOG_BASE
+#define BLOG_BASE 0u                /* section linked at address 0 */
+#endif
+
+#define BLOG_MAX_ARGS  6u
+#define BLOG_REC_MAX   (3u + 5u * (1u + BLOG_MAX_ARGS) + 1u)
+
+int __io_putchar(int ch);
+void blog_write(uint16_t id, uint8_t sign, const uint32_t *args, uint32_t n);
+void blog_format_check(const char *fmt, ...) __attribute__((format(printf, 1, 2)));   /* never defined */
+
+static inline uint32_t blog_word(uint32_t v) { return v; }
+static inline uint32_t blog_signed(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline uint32_t blog_float(float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof v);
+    return v;
+}
+
+#define BLOG_W(x) _Generic((x), float: blog_float, double: blog_float,                \
+                           char: blog_signed, signed char: blog_signed, short: blog_signed, int: blog_signed, \
+                           long: blog_signed, long long: blog_signed, default: blog_word)(x)
+#define BLOG_S(x) _Generic((x), char: 1u, signed char: 1u, short: 1u, int: 1u, long: 1u, long long: 1u, \
+                           default: 0u)
+
+#define BLOG_N(...)  BLOG_N_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define BLOG_N_(z, a, b, c, d, e, f, n, ...) n
+#define BLOG_CAT(a, b)   BLOG_CAT_(a, b)
+#define BLOG_CAT_(a, b)  a##b
+#define BLOG_ARGS_0()
+#define BLOG_ARGS_1(a)                 BLOG_W(a)
+#define BLOG_ARGS_2(a, b)              BLOG_W(a), BLOG_W(b)
+#define BLOG_ARGS_3(a, b, c)           BLOG_ARGS_2(a, b), BLOG_W(c)
+#define BLOG_ARGS_4(a, b, c, d)        BLOG_ARGS_3(a, b, c), BLOG_W(d)
+#define BLOG_ARGS_5(a, b, c, d, e)     BLOG_ARGS_4(a, b, c, d), BLOG_W(e)
+#define BLOG_ARGS_6(a, b, c, d, e, f)  BLOG_ARGS_5(a, b, c, d, e), BLOG_W(f)
+#define BLOG_SIGN_0()                  0u
+#define BLOG_SIGN_1(a)                 BLOG_S(a)
+#define BLOG_SIGN_2(a, b)              BLOG_SIGN_1(a) | BLOG_S(b) << 1
+#define BLOG_SIGN_3(a, b, c)           BLOG_SIGN_2(a, b) | BLOG_S(c) << 2
+#define BLOG_SIGN_4(a, b, c, d)        BLOG_SIGN_3(a, b, c) | BLOG_S(d) << 3
+#define BLOG_SIGN_5(a, b, c, d, e)     BLOG_SIGN_4(a, b, c, d) | BLOG_S(e) << 4
+#define BLOG_SIGN_6(a, b, c, d, e, f)  BLOG_SIGN_5(a, b, c, d, e) | BLOG_S(f) << 5
+
+#define BLOG(fmt, ...) do {                                                          \
+        if (0) blog_format_check(fmt, ##__VA_ARGS__);                                 \
+        static const char blog_fmt_[] __attribute__((section("binlog"), used)) = fmt; \
+        const uint32_t blog_args_[] = { 0u, BLOG_CAT(BLOG_ARGS_, BLOG_N(__VA_ARGS__))(__VA_ARGS__) }; \
+        blog_write((uint16_t)((uintptr_t)blog_fmt_ - BLOG_BASE),                      \
+                   (uint8_t)(BLOG_CAT(BLOG_SIGN_, BLOG_N(__VA_ARGS__))(__VA_ARGS__)),  \
+                   blog_args_ + 1, sizeof blog_args_ / sizeof blog_args_[0] - 1u);     \
+    } while (0)
+
+/* COBS: every 0x00 replaced by the distance to the next one; out needs n + n/254 + 1 */
+uint32_t blog_cobs_encode(const uint8_t *in, uint32_t n, uint8_t *out)
+{
+    uint32_t code_at = 0, o = 1;
+    uint8_t code = 1;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (in[i] != 0u) {
+            out[o++] = in[i];
+            code++;
+        }
+        if (in[i] == 0u || code == 0xFFu) {
+            out[code_at] = code;
+            code_at = o++;
+            code = 1;
+        }
+    }
+    out[code_at] = code;
+    return o;
+}
+
+/* Inverse of blog_cobs_encode for one frame without the 0x00, out needs n bytes;
+ * 0 on a broken frame */
+uint32_t blog_cobs_decode(const uint8_t *in, uint32_t n, uint8_t *out)
+{
+    uint32_t i = 0, o = 0;
+    while (i < n) {
+        uint8_t code = in[i++];
+        if (code == 0u || i + code - 1u > n) return 0;
+        for (uint8_t k = 1; k < code; ++k) out[o++] = in[i++];
+        if (code != 0xFFu && i < n) out[o++] = 0u;
+    }
+    return o;
+}
+
+static uint32_t blog_varint(uint8_t *p, uint32_t v)
+{
+    uint32_t n = 0;
+    while (v >= 0x80u) {
+        p[n++] = (uint8_t)(v | 0x80u);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/* Record for id/args into out (0x00 + COBS + 0x00); returns the frame length */
+uint32_t blog_encode(uint16_t id, uint8_t sign, uint32_t time, const uint32_t *args, uint32_t n, uint8_t *out)
+{
+    uint8_t rec[BLOG_REC_MAX];
+    if (n > BLOG_MAX_ARGS) n = BLOG_MAX_ARGS;
+    rec[0] = (uint8_t)id;
+    rec[1] = (uint8_t)(id >> 8);
+    rec[2] = (uint8_t)(sign & ((1u << n) - 1u));
+    uint32_t len = 3u + blog_varint(&rec[3], time);
+    for (uint32_t i = 0; i < n; ++i) len += blog_varint(&rec[len], args[i]);
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < len; ++i) sum = (uint8_t)(sum + rec[i]);
+    rec[len++] = sum;
+
+    out[0] = 0u;                           /* ends printf text sent before */
+    uint32_t f = 1u + blog_cobs_encode(rec, len, &out[1]);
+    out[f++] = 0u;
+    return f;
+}
+
+void blog_write(uint16_t id, uint8_t sign, const uint32_t *args, uint32_t n)
+{
+    uint8_t frame[BLOG_REC_MAX + BLOG_REC_MAX / 254u + 3u];
+    uint32_t f = blog_encode(id, sign, BLOG_TIME(), args, n, frame);
+    for (uint32_t i = 0; i < f; ++i) __io_putchar(frame[i]);
+}
+
+/* Examples:
+ *   Print_Time():            BLOG("D:%02u%02u%02u_%02u%02u%02u;", t.hour, t.min, t.sec, t.mday, t.mon, t.year);
+ *   measure_temperatures():  BLOG("sensor %u: %f C", addr, temp);
+ * Host:  python tools/binlog_decode.py build/firmware.elf capture.bin
+ */
@@ -0,0 +1,256 @@
+/* Binary telemetry frames with CRC-16
+ * Purpose: compact, versioned encoding of the temperature report and the Z frame,
+ *          with JSON (20_json_telemetry.c / 16_parse_z_frame.c) as the fallback.
+ *
+ *   0xA5 | version | type | len | payload[len] | crc16 (LE)
+ *
+ * CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over version..payload, one table
+ * lookup per byte. All fields little endian and fixed point:
+ *   TLM_TYPE_TEMP:  tick u32 | n u8 | n x { addr u8, raw i16 (1/16 degC) }
+ *   TLM_TYPE_Z:     position_um i32 | flags u8 (TLM_Z_*) | speed u8
+ * A device talks JSON after reset; the host switches to frames with
+ * tlm_negotiate(TLM_VERSION), e.g. from a command handler. Received Z data can be
+ * either: a frame starts with 0xA5, a JSON document with '{'. Payload and CRC
+ * bytes can take any value, '#' and '}' included, so a delimiter scan must not
+ * cut a frame: 17_uart_rx_ring.c takes it by its length byte.
+ * tools/tlm_decode.py decodes captured frames on the host.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Placeholders you should adapt to your project */
+// TempSnapshot_t / TEMP_ACQ_MAX from 19_temp_acquisition.c
+// RemoteState_t / remoteState / Z_POSITION_TEXT from 16_parse_z_frame.c
+
+#define TLM_SYNC         0xA5u
+#define TLM_VERSION      1u
+#define TLM_HDR_LEN      4u
+#define TLM_MAX_PAYLOAD  64u
+#define TLM_FRAME_MAX    (TLM_HDR_LEN + TLM_MAX_PAYLOAD + 2u)
+
+#define TLM_TYPE_TEMP    1u
+#define TLM_TYPE_Z       2u
+
+#define TLM_Z_REFERENCED  0x01u
+#define TLM_Z_BUSY        0x02u
+#define TLM_Z_BACK        0x04u
+#define TLM_Z_FRONT       0x08u
+#define TLM_Z_POSITION_OK 0x10u
+
+typedef enum { TLM_FMT_JSON, TLM_FMT_BINARY } TlmFormat_t;
+typedef enum { TLM_FRAME_OK, TLM_NEED_MORE, TLM_BAD } TlmParse_t;
+
+typedef struct {
+    uint8_t        type;
+    uint8_t        len;
+    const uint8_t *payload;   /* points into the parsed buffer */
+} TlmFrame_t;
+
+static TlmFormat_t tlm_fmt = TLM_FMT_JSON;
+
+/* Host asks for frames of 'version'; anything we do not speak keeps JSON */
+TlmFormat_t tlm_negotiate(uint32_t version)
+{
+    tlm_fmt = (version == TLM_VERSION) ? TLM_FMT_BINARY : TLM_FMT_JSON;
+    return tlm_fmt;
+}
+
+TlmFormat_t tlm_format(void)
+{
+    return tlm_fmt;
+}
+
+static const uint16_t tlm_crc_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+uint16_t tlm_crc16(const uint8_t *p, size_t n)
+{
+    uint16_t crc = 0xFFFFu;
+    while (n--) crc = (uint16_t)(crc << 8) ^ tlm_crc_table[(uint8_t)(crc >> 8) ^ *p++];
+    return crc;
+}
+
+static inline uint8_t *tlm_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t *tlm_put32(uint8_t *p, uint32_t v)
+{
+    p = tlm_put16(p, (uint16_t)v);
+    return tlm_put16(p, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t tlm_get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t tlm_get32(const uint8_t *p)
+{
+    return tlm_get16(p) | ((uint32_t)tlm_get16(p + 2) << 16);
+}
+
+/* Header and CRC around the payload already written at out + TLM_HDR_LEN */
+static size_t tlm_seal(uint8_t *out, uint8_t type, size_t len)
+{
+    out[0] = TLM_SYNC;
+    out[1] = TLM_VERSION;
+    out[2] = type;
+    out[3] = (uint8_t)len;
+    tlm_put16(out + TLM_HDR_LEN + len, tlm_crc16(out + 1, 3u + len));
+    return TLM_HDR_LEN + len + 2u;
+}
+
+/* Valid sensors of the snapshot; returns the frame length, 0 if cap is too small */
+size_t tlm_frame_temperatures(uint8_t *out, size_t cap, const TempSnapshot_t *s)
+{
+    uint8_t n = 0;
+    for (uint8_t j = 0; j < s->count; ++j) n += (s->valid >> j) & 1u;
+    size_t len = 5u + 3u * n;
+    if (len > TLM_MAX_PAYLOAD || cap < TLM_HDR_LEN + len + 2u) return 0;
+
+    uint8_t *p = tlm_put32(out + TLM_HDR_LEN, s->tick);
+    *p++ = n;
+    for (uint8_t j = 0; j < s->count; ++j) {
+        if (!(s->valid & (1u << j))) continue;
+        *p++ = s->addr[j];
+        p = tlm_put16(p, (uint16_t)s->raw[j]);
+    }
+    return tlm_seal(out, TLM_TYPE_TEMP, len);
+}
+
+size_t tlm_frame_z(uint8_t *out, size_t cap, const RemoteState_t *st)
+{
+    if (cap < TLM_HDR_LEN + 6u + 2u) return 0;
+    uint8_t *p = tlm_put32(out + TLM_HDR_LEN, (uint32_t)st->position_um);
+    *p++ = (uint8_t)((st->referenced ? TLM_Z_REFERENCED : 0u) | (st->busy ? TLM_Z_BUSY : 0u)
+                   | (st->back ? TLM_Z_BACK : 0u) | (st->front ? TLM_Z_FRONT : 0u)
+                   | (st->position_ok ? TLM_Z_POSITION_OK : 0u));
+    *p = st->speed;
+    return tlm_seal(out, TLM_TYPE_Z, 6u);
+}
+
+/* First frame in buf[0..n). *used is how far the caller may discard: past the
+ * frame on TLM_FRAME_OK, past garbage or a broken frame on TLM_BAD, up to the
+ * start of an incomplete frame on TLM_NEED_MORE. */
+TlmParse_t tlm_parse(const uint8_t *buf, size_t n, TlmFrame_t *f, size_t *used)
+{
+    size_t i = 0;
+    while (i < n && buf[i] != TLM_SYNC) ++i;
+    *used = i;
+    if (n - i < TLM_HDR_LEN) return i ? TLM_BAD : TLM_NEED_MORE;
+
+    const uint8_t *h = buf + i;
+    if (h[1] != TLM_VERSION || h[3] > TLM_MAX_PAYLOAD) {
+        *used = i + 1u;                  /* not a header: resync on the next 0xA5 */
+        return TLM_BAD;
+    }
+    size_t total = TLM_HDR_LEN + h[3] + 2u;
+    if (n - i < total) return i ? TLM_BAD : TLM_NEED_MORE;
+    if (tlm_crc16(h + 1, 3u + h[3]) != tlm_get16(h + TLM_HDR_LEN + h[3])) {
+        *used = i + 1u;
+        return TLM_BAD;
+    }
+    f->type = h[2];
+    f->len = h[3];
+    f->payload = h + TLM_HDR_LEN;
+    *used = i + total;
+    return TLM_FRAME_OK;
+}
+
+bool tlm_decode_temperatures(const TlmFrame_t *f, TempSnapshot_t *s)
+{
+    const uint8_t *p = f->payload;
+    if (f->type != TLM_TYPE_TEMP || f->len < 5u) return false;
+    uint8_t n = p[4];
+    if (n > TEMP_ACQ_MAX || f->len != 5u + 3u * n) return false;
+
+    s->tick = tlm_get32(p);
+    s->count = n;
+    s->valid = (uint8_t)((1u << n) - 1u);
+    for (uint8_t j = 0; j < n; ++j) {
+        s->addr[j] = p[5u + 3u * j];
+        s->raw[j] = (int16_t)tlm_get16(p + 6u + 3u * j);
+    }
+    return true;
+}
+
+/* Binary counterpart of parse_z_frame(): same atomic update of remoteState */
+bool tlm_decode_z(const TlmFrame_t *f)
+{
+    const uint8_t *p = f->payload;
+    if (f->type != TLM_TYPE_Z || f->len != 6u) return false;
+
+    RemoteState_t tmp = {0};
+    tmp.position_um = (int32_t)tlm_get32(p);
+    tmp.position_ok = (p[4] & TLM_Z_POSITION_OK) != 0;
+    tmp.referenced = (p[4] & TLM_Z_REFERENCED) != 0;
+    tmp.busy = (p[4] & TLM_Z_BUSY) != 0;
+    tmp.back = (p[4] & TLM_Z_BACK) != 0;
+    tmp.front = (p[4] & TLM_Z_FRONT) != 0;
+    tmp.speed = p[5];
+#if Z_POSITION_TEXT
+    /* keep the text field filled for code that still reads it: "-12.500" */
+    uint32_t um = tmp.position_um < 0 ? 0u - (uint32_t)tmp.position_um : (uint32_t)tmp.position_um;
+    char rev[12];
+    size_t k = 0, n = 0;
+    uint32_t mm = um / 1000u, frac = um % 1000u;
+    for (int d = 0; d < 3; ++d, frac /= 10u) rev[k++] = (char)('0' + frac % 10u);
+    rev[k++] = '.';
+    do { rev[k++] = (char)('0' + mm % 10u); mm /= 10u; } while (mm);
+    if (tmp.position_um < 0) tmp.position[n++] = '-';
+    while (k) tmp.position[n++] = rev[--k];
+    tmp.position[n] = '\0';
+#endif
+
+    __disable_irq();
+    remoteState = tmp;
+    __enable_irq();
+    return true;
+}
+
+/* Example: rx_poll() in 17_uart_rx_ring.c gets one whole frame per RX_FRAME_BIN
+ * view and calls tlm_parse() + tlm_decode_z() on it. For a plain byte stream
+ * (buf/len, e.g. a capture):
+ *   TlmFrame_t f; size_t used; TlmParse_t r;
+ *   for (; (r = tlm_parse(buf, len, &f, &used)) != TLM_NEED_MORE; buf += used, len -= used) {
+ *       if (r == TLM_FRAME_OK) tlm_decode_z(&f);
+ *   }
+ * tlm_parse() consumes at least one byte unless it needs more data.
+ */
@@ -0,0 +1,226 @@
+/* STM32 HAL template: debounced button events
+ * Practice: EXTI masked after the first edge, timer-confirmed state, lock-free event queue.
+ *
+ * 02_gpio_exti.c acts on every edge, so one bouncing press is a burst of EXTI
+ * interrupts and toggles. Here the first edge masks its EXTI line and the 1 ms
+ * SysTick samples the pin until it has been stable for INPUT_DEBOUNCE_MS; the
+ * sampling rides on an interrupt that runs anyway, so a press costs one EXTI
+ * interrupt and no timer of its own. Press, release and long-press events,
+ * stamped with the first edge of the press or release, go into a
+ * single-producer/single-consumer ring that the main loop drains with
+ * input_poll(). Once a button is released and stable its line is unmasked
+ * again; with no button busy input_tick() returns at the first test. A short
+ * dropout while a button is held never becomes an event and does not move the
+ * press time.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32xx_hal.h"
+#include "uart_log.h" // __io_putchar from 21_uart_log.c
+
+#define INPUT_DEBOUNCE_MS  20u
+#define INPUT_LONG_MS      800u
+#define INPUT_QLEN         16u     /* power of two */
+
+typedef enum { INPUT_PRESS, INPUT_RELEASE, INPUT_LONG } InputEventType_t;
+
+typedef struct {
+  uint32_t t_ms;                   /* HAL_GetTick() of the first edge; INPUT_LONG: of the press */
+  uint8_t  button;                 /* index into input_buttons[] */
+  uint8_t  type;                   /* InputEventType_t */
+} InputEvent_t;
+
+typedef struct {
+  GPIO_TypeDef *port;
+  uint16_t      pin;               /* also the EXTI line mask */
+  uint8_t       active_low;
+} InputButton_t;
+
+static const InputButton_t input_buttons[] = {
+  { GPIOA, GPIO_PIN_0, 1 },        // user button, pull-up
+};
+#define INPUT_COUNT (sizeof input_buttons / sizeof input_buttons[0])
+
+typedef struct {
+  uint8_t  busy;                   /* line masked, sampled by the tick */
+  uint8_t  pressed;                /* debounced state */
+  uint8_t  level;                  /* last sample */
+  uint8_t  long_sent;
+  uint16_t stable_ms;
+  uint32_t t_edge;                 /* first edge of the debounced state */
+  uint32_t t_change;               /* first edge away from it, until the change is debounced */
+} InputState_t;
+
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef  hdma_usart2_tx;
+
+static InputState_t      input_st[INPUT_COUNT];
+static InputEvent_t      input_q[INPUT_QLEN];
+static volatile uint32_t input_q_head;     /* tick ISR only */
+static volatile uint32_t input_q_tail;     /* main loop only */
+static volatile uint32_t input_busy_mask;
+static volatile uint32_t input_dropped;
+static volatile uint32_t input_exti_irqs, input_samples;
+
+static inline uint8_t input_read(const InputButton_t *b)
+{
+  uint8_t v = HAL_GPIO_ReadPin(b->port, b->pin) == GPIO_PIN_SET;
+  return v ^ b->active_low;
+}
+
+static void input_push(uint8_t button, InputEventType_t type, uint32_t t)
+{
+  uint32_t h = input_q_head;
+  if (h - input_q_tail >= INPUT_QLEN) {
+    input_dropped++;
+    return;
+  }
+  input_q[h & (INPUT_QLEN - 1u)] = (InputEvent_t){ t, button, (uint8_t)type };
+  __DMB();                         /* event visible before the new head */
+  input_q_head = h + 1u;
+}
+
+/* Main loop: next event, false when the queue is empty */
+bool input_poll(InputEvent_t *ev)
+{
+  uint32_t t = input_q_tail;
+  if (t == input_q_head) return false;
+  __DMB();
+  *ev = input_q[t & (INPUT_QLEN - 1u)];
+  input_q_tail = t + 1u;
+  return true;
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t pin)
+{
+  for (uint32_t i = 0; i < INPUT_COUNT; ++i) {
+    if (input_buttons[i].pin != pin || input_st[i].busy) continue;
+    input_exti_irqs++;
+    EXTI->IMR &= ~(uint32_t)pin;   /* no more edges until it settled */
+    input_st[i].busy = 1;
+    input_st[i].stable_ms = 0;
+    input_st[i].level = !input_st[i].pressed;
+    input_st[i].t_change = HAL_GetTick();
+    input_busy_mask |= 1UL << i;
+  }
+}
+
+/* From SysTick_Handler, after HAL_IncTick() */
+void input_tick(void)
+{
+  if (input_busy_mask == 0) return;
+  uint32_t now = HAL_GetTick();
+  for (uint32_t i = 0; i < INPUT_COUNT; ++i) {
+    InputState_t *s = &input_st[i];
+    if (!s->busy) continue;
+
+    uint8_t v = input_read(&input_buttons[i]);
+    input_samples++;
+    if (v != s->level) {           /* still bouncing: restart the window */
+      if (s->level == s->pressed && s->stable_ms == INPUT_DEBOUNCE_MS) s->t_change = now;   /* left a settled state */
+      s->level = v;
+      s->stable_ms = 0;
+      continue;
+    }
+    if (s->stable_ms < INPUT_DEBOUNCE_MS) s->stable_ms++;
+    if (s->stable_ms == INPUT_DEBOUNCE_MS && v != s->pressed) {
+      s->pressed = v;
+      s->long_sent = 0;
+      s->t_edge = s->t_change;     /* a dropout that bounced back never gets here */
+      input_push((uint8_t)i, v ? INPUT_PRESS : INPUT_RELEASE, s->t_edge);
+    }
+    if (s->pressed && !s->long_sent && now - s->t_edge >= INPUT_LONG_MS) {
+      s->long_sent = 1;
+      input_push((uint8_t)i, INPUT_LONG, s->t_edge);
+    }
+    if (!s->pressed && s->stable_ms == INPUT_DEBOUNCE_MS) {
+      s->busy = 0;                 /* released and quiet: back to EXTI */
+      input_busy_mask &= ~(1UL << i);
+      __HAL_GPIO_EXTI_CLEAR_IT(input_buttons[i].pin);
+      EXTI->IMR |= input_buttons[i].pin;
+    }
+  }
+}
+
+void SysTick_Handler(void){ HAL_IncTick(); input_tick(); }
+void EXTI0_IRQHandler(void){ HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_0); }
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_complete(); }
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){ if (huart == &huart2) uart_log_tx_error(); }
+void DMA1_Stream6_IRQHandler(void){ HAL_DMA_IRQHandler(&hdma_usart2_tx); }
+void USART2_IRQHandler(void){ HAL_UART_IRQHandler(&huart2); }
+
+static void MX_USART2_UART_Init(void)
+{
+  __HAL_RCC_USART2_CLK_ENABLE();
+  huart2.Instance = USART2;
+  huart2.Init.BaudRate = 115200;
+  huart2.Init.WordLength = UART_WORDLENGTH_8B;
+  huart2.Init.StopBits = UART_STOPBITS_1;
+  huart2.Init.Parity = UART_PARITY_NONE;
+  huart2.Init.Mode = UART_MODE_TX_RX;
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
+  HAL_UART_Init(&huart2);
+
+  // log TX by DMA (21_uart_log.c); example (F4): USART2_TX = DMA1 stream 6 ch 4
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_usart2_tx.Instance = DMA1_Stream6;
+  hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+  hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+  hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+  HAL_DMA_Init(&hdma_usart2_tx);
+  __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);   // TC after the last byte: HAL_UART_TxCpltCallback
+  HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+void SystemClock_Config(void);
+static void MX_GPIO_Init(void);
+
+int main(void)
+{
+  HAL_Init();
+  SystemClock_Config();
+  MX_GPIO_Init();
+  MX_USART2_UART_Init();
+  uart_log_init(&huart2);
+
+  static const char *const names[] = { "press", "release", "long" };
+  while (1) {
+    InputEvent_t ev;
+    while (input_poll(&ev)) {
+      if (ev.type == INPUT_PRESS) HAL_GPIO_TogglePin(GPIOA, GPIO_PIN_5);
+      printf("%lu ms: button %u %s (exti irqs %lu, samples %lu, dropped %lu)\r\n",
+             (unsigned long)ev.t_ms, ev.button, names[ev.type], (unsigned long)input_exti_irqs,
+             (unsigned long)input_samples, (unsigned long)input_dropped);
+    }
+    __WFI();
+  }
+}
+
+static void MX_GPIO_Init(void)
+{
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_SYSCFG_CLK_ENABLE();
+
+  GPIO_InitTypeDef g = {0};
+  g.Pin = GPIO_PIN_5; g.Mode = GPIO_MODE_OUTPUT_PP; g.Pull = GPIO_NOPULL; g.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOA, &g);
+
+  g.Pin = GPIO_PIN_0; g.Mode = GPIO_MODE_IT_RISING_FALLING; g.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(GPIOA, &g);
+
+  HAL_NVIC_SetPriority(EXTI0_IRQn, TICK_INT_PRIORITY, 0);   // same as SysTick: never nest
+  HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+}
+
+void SystemClock_Config(void) { /* device specific */ }
@@ -0,0 +1,242 @@
+/* STM32 HAL template: cached RTC timebase
+ * Practice: 1 Hz RTC square wave as seconds tick, DWT sub-second interpolation,
+ *           seqlock snapshot, civil date conversion without a bus access.
+ *
+ * Print_Time() reads the DS3231 over I2C for every timestamp and 09_rtc_time.c
+ * calls HAL_RTC_GetTime/GetDate in every loop. Here the RTC is read at start and
+ * every TB_RESYNC_S seconds; in between, the DS3231 SQW output (1 Hz, falling
+ * edge = seconds register update) on an EXTI pin advances a seconds counter and
+ * the core cycles since that edge give the sub-second part. Every edge also
+ * measures the cycles per RTC second, so a core clock that is some ppm off does
+ * not accumulate inside the second. tb_now_us() is a few loads, one multiply and
+ * a shift. Within a second it stops at .999999 if the next edge is late, however
+ * late, and a resync never publishes a second below the current one, so the
+ * result never goes backwards. When an edge is more than 1.5 % overdue,
+ * tb_service() steps the second on the core clock instead; an edge that still
+ * arrives afterwards is then too close to count again.
+ * Without the SQW line (TB_SQW 0) tb_service() reads the RTC only shortly before
+ * the expected second boundary and takes the change it sees as the edge; the
+ * window narrows to 1/256 s while the changes keep landing inside it. The phase
+ * error is then the tb_service() call interval.
+ *
+ * timebase.h:
+ *   void     tb_init(void);
+ *   void     tb_on_second(void);          // SQW falling edge (EXTI callback)
+ *   void     tb_service(void);            // main loop: resync / polling
+ *   uint64_t tb_now_us(void);             // us since 2000-01-01 00:00:00
+ *   uint32_t tb_now_s(void);
+ *   void     tb_to_civil(uint32_t s, TbCivil_t *t);
+ *
+ * Host tests: define TB_CYCLES() to read a variable and TB_NOMINAL_CPS.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32xx_hal.h" // replace with your series header
+
+#ifndef TB_SQW
+#define TB_SQW 1                  /* 1: DS3231 SQW on EXTI, 0: poll the RTC */
+#endif
+#ifndef TB_CYCLES
+#define TB_CYCLES() (DWT->CYCCNT)
+#define TB_USE_DWT  1
+#endif
+#ifndef TB_NOMINAL_CPS
+#define TB_NOMINAL_CPS SystemCoreClock
+#endif
+#define TB_RESYNC_S  3600u        /* compare the counted seconds with the RTC */
+
+typedef struct {
+    uint16_t year;                /* 2000..2099 */
+    uint8_t  mon, mday, hour, min, sec;
+} TbCivil_t;
+
+/* Placeholder you should adapt to your project, e.g. for the DS3231:
+ *   bool tb_rtc_read(TbCivil_t *t)
+ *   {
+ *       DS_TIME d; DS3231_get(&d);
+ *       *t = (TbCivil_t){ 2000u + d.year, d.mon, d.mday, d.hour, d.min, d.sec };
+ *       return true;
+ *   }
+ */
+bool tb_rtc_read(TbCivil_t *t);
+
+static struct {
+    volatile uint32_t seq;        /* odd while an update is in progress */
+    uint32_t sec;                 /* seconds since 2000 at the last edge */
+    uint32_t cyc;                 /* TB_CYCLES() at the last edge */
+    uint32_t scale;               /* microseconds per cycle, Q32 */
+    uint32_t cps;                 /* cycles per RTC second */
+} tb;
+static volatile uint8_t tb_resync;
+static uint8_t tb_locked;         /* an edge was seen: phase known */
+static uint32_t tb_flywheel;      /* seconds stepped without an edge, 0 once one comes */
+static uint32_t tb_resync_at;
+static uint32_t tb_rtc_behind;    /* RTC reads below the published second, not applied */
+
+/* Days since 2000-01-01, valid 2000..2099 */
+static uint32_t tb_days(uint32_t y, uint32_t m, uint32_t d)
+{
+    if (m < 3u) { y--; m += 12u; }                  /* year starts in March */
+    return 365u * y + y / 4u - y / 100u + y / 400u + (153u * (m - 3u) + 2u) / 5u + d - 730426u;
+}
+
+static uint32_t tb_from_civil(const TbCivil_t *t)
+{
+    return tb_days(t->year, t->mon, t->mday) * 86400u + t->hour * 3600u + t->min * 60u + t->sec;
+}
+
+void tb_to_civil(uint32_t s, TbCivil_t *t)
+{
+    uint32_t days = s / 86400u, rem = s % 86400u;
+    t->hour = (uint8_t)(rem / 3600u);
+    t->min = (uint8_t)(rem / 60u % 60u);
+    t->sec = (uint8_t)(rem % 60u);
+
+    uint32_t z = days + 730425u;                    /* days since 0000-03-01 */
+    uint32_t era = z / 146097u, doe = z % 146097u;
+    uint32_t yoe = (doe - doe / 1460u + doe / 36524u - doe / 146096u) / 365u;
+    uint32_t doy = doe - (365u * yoe + yoe / 4u - yoe / 100u);
+    uint32_t mp = (5u * doy + 2u) / 153u;
+    t->mday = (uint8_t)(doy - (153u * mp + 2u) / 5u + 1u);
+    t->mon = (uint8_t)(mp < 10u ? mp + 3u : mp - 9u);
+    t->year = (uint16_t)(era * 400u + yoe + (t->mon <= 2u));
+}
+
+/* IRQs off: publish a new second boundary */
+static void tb_publish(uint32_t sec, uint32_t cyc, uint32_t cps)
+{
+    tb.seq++;
+    __DMB();
+    tb.sec = sec;
+    tb.cyc = cyc;
+    if (cps != tb.cps) {
+        tb.cps = cps;
+        tb.scale = (uint32_t)((1000000ULL << 32) / cps);
+    }
+    __DMB();
+    tb.seq++;
+}
+
+uint64_t tb_now_us(void)
+{
+    uint32_t q, s, c, k;
+    do {
+        q = tb.seq;
+        __DMB();
+        s = tb.sec;
+        c = tb.cyc;
+        k = tb.scale;
+        __DMB();
+    } while ((q & 1u) || q != tb.seq);
+    uint32_t d = TB_CYCLES() - c;                   /* c is never ahead: unsigned up to 2^32 */
+    uint32_t sub = (uint32_t)(((uint64_t)d * k) >> 32);
+    if (sub > 999999u) sub = 999999u;               /* edge late: hold, never go back */
+    return (uint64_t)s * 1000000u + sub;
+}
+
+uint32_t tb_now_s(void)
+{
+    return tb.sec;
+}
+
+void tb_init(void)
+{
+    TbCivil_t t;
+#ifdef TB_USE_DWT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    uint32_t s = tb_rtc_read(&t) ? tb_from_civil(&t) : 0u;
+    __disable_irq();
+    tb_publish(s, TB_CYCLES(), TB_NOMINAL_CPS);     /* phase unknown until the first edge */
+    tb_locked = 0;
+    __enable_irq();
+    tb_resync = 1;                                   /* confirm right after that edge */
+    tb_resync_at = s + TB_RESYNC_S;
+}
+
+/* One RTC second elapsed; ignores glitches, recalibrates on plausible periods */
+void tb_on_second(void)
+{
+    uint32_t now = TB_CYCLES();
+    uint32_t d = now - tb.cyc;
+    uint32_t nominal = TB_NOMINAL_CPS;
+    if (tb_locked && d < nominal / 2u) return;      /* noise on the SQW line */
+
+    uint32_t pm = __get_PRIMASK();
+    __disable_irq();
+    uint32_t cps = tb.cps;
+    uint32_t sec = tb.sec + 1u;
+    if (!tb_locked) {
+        tb_locked = 1;                              /* d is only part of a second */
+    } else if (d > nominal - nominal / 64u && d < nominal + nominal / 64u) {
+        cps = d;                                    /* within 1.5 %: measured period */
+    } else if (d > nominal + nominal / 2u) {
+        sec = tb.sec + (d + cps / 2u) / cps;        /* missed edges */
+        tb_resync = 1;
+    }
+    tb_publish(sec, now, cps);
+    tb_flywheel = 0;
+    __set_PRIMASK(pm);
+    if (sec >= tb_resync_at) tb_resync = 1;
+}
+
+/* Main loop: RTC read for resync (SQW) or boundary detection (polling) */
+void tb_service(void)
+{
+    TbCivil_t t;
+#if TB_SQW
+    if (!tb_locked) return;
+    uint32_t q = tb.seq;
+    uint32_t cyc = tb.cyc;
+    if (TB_CYCLES() - cyc > tb.cps + tb.cps / 64u) { /* edge overdue: step on the core clock */
+        __disable_irq();
+        if (tb.seq == q) {
+            tb_publish(tb.sec + 1u, cyc + tb.cps, tb.cps);
+            if (tb_flywheel++ == 0u) tb_resync = 1;  /* check once per outage */
+        }
+        __enable_irq();
+        return;
+    }
+    if (!tb_resync) return;
+    if (TB_CYCLES() - cyc > tb.cps / 2u) return;    /* read early in a second only */
+    if (!tb_rtc_read(&t)) return;
+    uint32_t s = tb_from_civil(&t);
+    __disable_irq();
+    if (tb.seq == q) {                              /* no edge during the read */
+        if (s > tb.sec) tb_publish(s, cyc, tb.cps);
+        else if (s < tb.sec) tb_rtc_behind++;       /* keep counting, the time never steps back */
+        tb_resync = 0;
+        tb_resync_at = s + TB_RESYNC_S;
+    }
+    __enable_irq();
+#else
+    static uint32_t lead;         /* poll from this many cycles before the expected edge */
+    static bool waited;           /* read the old second in this window */
+    if (!tb_locked) {
+        lead = tb.cps;            /* phase unknown: poll all the time */
+        tb_locked = 1;
+    }
+    uint32_t cyc = TB_CYCLES();
+    if (cyc - tb.cyc < tb.cps - lead) return;
+    if (!tb_rtc_read(&t)) return;
+    uint32_t s = tb_from_civil(&t);
+    if (s <= tb.sec) {
+        if (s < tb.sec) tb_rtc_behind++;            /* RTC set back: hold until it catches up */
+        waited = true;
+        return;
+    }
+    if (waited) lead = lead / 2u > tb.cps / 256u ? lead / 2u : tb.cps / 256u;
+    else lead = lead < tb.cps / 2u ? lead * 2u : tb.cps;   /* change came before the window */
+    waited = false;
+    __disable_irq();
+    tb_publish(s, cyc, tb.cps);
+    __enable_irq();
+#endif
+}
+
+/* Examples:
+ *   void HAL_GPIO_EXTI_Callback(uint16_t pin){ if (pin == GPIO_PIN_1) tb_on_second(); }
+ *   Print_Time():  TbCivil_t t; tb_to_civil(tb_now_s(), &t);   -- instead of DS3231_get()
+ *   09_rtc_time.c: print when tb_now_s() changes instead of HAL_RTC_GetTime() + HAL_Delay()
+ */
@@ -0,0 +1,10 @@
+/* Host stand-in for the DS3231 driver header; the test defines DS3231_get() */
+#ifndef DS3231_H
+#define DS3231_H
+
+#include <stdint.h>
+
+typedef struct { uint8_t hour, min, sec, mday, mon, year; } DS_TIME;
+void DS3231_get(DS_TIME *t);
+
+#endif /* DS3231_H */
@@ -0,0 +1,70 @@
+/* Defaults behind stm32xx_hal.h, linked into every host test. All of them are
+ * weak: a test that needs a different clock or a different __WFI() defines its
+ * own. The tick only moves when the test (or HAL_Delay/__WFI) moves it. Setup
+ * calls succeed and do nothing, so do the HAL IRQ handlers: tests raise the
+ * callbacks directly.
+ */
+#include "stm32xx_hal.h"
+
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+uint32_t           host_primask;
+uint32_t           SystemCoreClock = 168000000u;
+volatile uint32_t  uwTick;
+USART_TypeDef      host_usart[7];
+I2C_TypeDef        host_i2c[4];
+GPIO_TypeDef       host_gpio[3];
+EXTI_TypeDef       host_exti;
+DMA_Stream_TypeDef host_dma_stream[16];
+ADC_TypeDef        host_adc[2];
+SPI_TypeDef        host_spi[2];
+TIM_TypeDef        host_tim[15];
+RTC_TypeDef        host_rtc;
+RCC_TypeDef        host_rcc;
+PWR_TypeDef        host_pwr;
+DWT_Type           host_dwt;
+CoreDebug_Type     host_coredebug;
+
+__attribute__((weak)) uint32_t HAL_GetTick(void) { return uwTick; }
+__attribute__((weak)) void HAL_Delay(uint32_t ms) { uwTick += ms; }
+__attribute__((weak)) void __WFI(void) { uwTick++; }
+
+__attribute__((weak)) uint32_t host_cyccnt(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+__attribute__((weak)) void host_rcc_access(void) { }
+
+__attribute__((weak)) void HAL_IncTick(void) { uwTick++; }
+__attribute__((weak)) void HAL_SuspendTick(void) { }
+__attribute__((weak)) void HAL_ResumeTick(void) { }
+
+#define HOST_SETUP(decl) __attribute__((weak)) HAL_StatusTypeDef decl { return HAL_OK; }
+HOST_SETUP(HAL_Init(void))
+HOST_SETUP(HAL_DMA_Init(DMA_HandleTypeDef *h))
+HOST_SETUP(HAL_UART_Init(UART_HandleTypeDef *h))
+HOST_SETUP(HAL_I2C_Init(I2C_HandleTypeDef *h))
+HOST_SETUP(HAL_ADC_Init(ADC_HandleTypeDef *h))
+HOST_SETUP(HAL_SPI_Init(SPI_HandleTypeDef *h))
+HOST_SETUP(HAL_TIM_Base_Init(TIM_HandleTypeDef *h))
+HOST_SETUP(HAL_TIM_Base_Start(TIM_HandleTypeDef *h))
+HOST_SETUP(HAL_TIM_PWM_Init(TIM_HandleTypeDef *h))
+HOST_SETUP(HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *h, TIM_OC_InitTypeDef *c, uint32_t ch))
+HOST_SETUP(HAL_TIM_PWM_Start(TIM_HandleTypeDef *h, uint32_t ch))
+HOST_SETUP(HAL_RTC_Init(RTC_HandleTypeDef *h))
+HOST_SETUP(HAL_RTC_WaitForSynchro(RTC_HandleTypeDef *h))
+HOST_SETUP(HAL_ADC_ConfigChannel(ADC_HandleTypeDef *h, ADC_ChannelConfTypeDef *c))
+
+__attribute__((weak)) void HAL_DMA_IRQHandler(DMA_HandleTypeDef *h) { }
+__attribute__((weak)) void HAL_UART_IRQHandler(UART_HandleTypeDef *h) { }
+
+__attribute__((weak)) void HAL_NVIC_SetPriority(IRQn_Type irq, uint32_t pre, uint32_t sub) { }
+__attribute__((weak)) void HAL_NVIC_EnableIRQ(IRQn_Type irq) { }
+__attribute__((weak)) void HAL_NVIC_DisableIRQ(IRQn_Type irq) { }
+__attribute__((weak)) void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init) { }
+__attribute__((weak)) void HAL_PWR_EnableBkUpAccess(void) { }
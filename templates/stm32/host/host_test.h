@@ -0,0 +1,85 @@
+/* Check and timing helpers for the host tests. A test is one C file that
+ * includes the template under test and returns host_result() from main().
+ * With --bench it also prints its measurements; tools/host_tests.py builds
+ * that run with -O2 and without sanitizers.
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static int host_failures;
+
+#define CHECK(c)                                                                   \
+    do {                                                                           \
+        if (!(c)) {                                                                \
+            if (host_failures++ < 20)                                              \
+                fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #c); \
+        }                                                                          \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                             \
+    do {                                                                           \
+        long long a_ = (long long)(a), b_ = (long long)(b);                        \
+        if (a_ != b_) {                                                            \
+            if (host_failures++ < 20)                                              \
+                fprintf(stderr, "%s:%d: %s == %lld, expected %s == %lld\n",        \
+                        __FILE__, __LINE__, #a, a_, #b, b_);                       \
+        }                                                                          \
+    } while (0)
+
+/* --bench on the command line */
+static inline bool host_bench(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i)
+        if (strcmp(argv[i], "--bench") == 0) return true;
+    return false;
+}
+
+static inline uint64_t host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Time stamp counter where there is one, else ns */
+static inline uint64_t host_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return host_ns();
+#endif
+}
+
+/* xorshift32: same sequence on every run */
+static uint32_t host_rng = 2463534242u;
+static inline uint32_t host_rand(void)
+{
+    host_rng ^= host_rng << 13;
+    host_rng ^= host_rng >> 17;
+    host_rng ^= host_rng << 5;
+    return host_rng;
+}
+
+/* Keeps benchmark results alive */
+static volatile uint32_t host_sink;
+
+static inline int host_result(const char *name)
+{
+    if (host_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, host_failures);
+        return 1;
+    }
+    return 0;
+}
+
+#endif /* HOST_TEST_H */
@@ -0,0 +1,7 @@
+/* Host stand-in for the CubeMX main.h that help_functions.c includes */
+#ifndef MAIN_H
+#define MAIN_H
+
+#include "stm32xx_hal.h"
+
+#endif /* MAIN_H */
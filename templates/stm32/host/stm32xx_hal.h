@@ -0,0 +1,458 @@
+/* Host stand-in for the STM32 series header, for the tests in this folder.
+ * Types and macros only: every HAL function a template calls is declared here
+ * and defined by the test that includes the template, so each test decides
+ * what the "hardware" does. Setup calls (HAL_Init, the *_Init functions, NVIC,
+ * clocks) have no-op weak defaults in hal_stub.c. Interrupt masking becomes a
+ * PRIMASK flag, barriers become compiler/CPU fences.
+ */
+#ifndef STM32XX_HAL_HOST_H
+#define STM32XX_HAL_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define __IO volatile
+
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+#define HAL_MAX_DELAY 0xFFFFFFFFu
+
+/* Core --------------------------------------------------------------------- */
+extern uint32_t host_primask;     /* 1: interrupts masked */
+static inline uint32_t __get_PRIMASK(void) { return host_primask; }
+static inline void __set_PRIMASK(uint32_t m) { host_primask = m; }
+static inline void __disable_irq(void) { host_primask = 1; }
+static inline void __enable_irq(void) { host_primask = 0; }
+static inline void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __ISB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __NOP(void) { }
+void __WFI(void);                 /* the test advances time / raises interrupts */
+
+/* DWT cycle counter: every DWT-> access refreshes CYCCNT from host_cyccnt(),
+ * rdtsc by default, a virtual clock in tests that define their own */
+typedef struct { __IO uint32_t CTRL, CYCCNT; } DWT_Type;
+typedef struct { __IO uint32_t DEMCR; } CoreDebug_Type;
+#define DWT_CTRL_CYCCNTENA_Msk       0x00000001u
+#define CoreDebug_DEMCR_TRCENA_Msk   0x01000000u
+extern DWT_Type       host_dwt;
+extern CoreDebug_Type host_coredebug;
+uint32_t host_cyccnt(void);
+static inline DWT_Type *host_dwt_read(void)
+{
+    host_dwt.CYCCNT = host_cyccnt();
+    return &host_dwt;
+}
+#define DWT       (host_dwt_read())
+#define CoreDebug (&host_coredebug)
+
+extern uint32_t SystemCoreClock;
+extern volatile uint32_t uwTick;
+HAL_StatusTypeDef HAL_Init(void);
+void HAL_IncTick(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t ms);
+void HAL_SuspendTick(void);
+void HAL_ResumeTick(void);
+
+typedef enum {
+    EXTI0_IRQn = 6, I2C1_EV_IRQn = 31, I2C1_ER_IRQn = 32, SPI1_IRQn = 35, USART2_IRQn = 38,
+    EXTI15_10_IRQn = 40, RTC_WKUP_IRQn = 3, DMA1_Stream5_IRQn = 16, DMA1_Stream6_IRQn = 17, DMA2_Stream0_IRQn = 56,
+    DMA2_Stream1_IRQn = 57, DMA2_Stream2_IRQn = 58, DMA2_Stream3_IRQn = 59, DMA2_Stream7_IRQn = 70,
+} IRQn_Type;
+void HAL_NVIC_SetPriority(IRQn_Type irq, uint32_t pre, uint32_t sub);
+void HAL_NVIC_EnableIRQ(IRQn_Type irq);
+void HAL_NVIC_DisableIRQ(IRQn_Type irq);
+#define TICK_INT_PRIORITY 15u
+
+/* Clock enables do nothing on the host */
+#define __HAL_RCC_GPIOA_CLK_ENABLE()  ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()  ((void)0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()  ((void)0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_DMA2_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_ADC1_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_USART2_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_I2C1_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_SPI1_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_TIM2_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_TIM3_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_SYSCFG_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_PWR_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_RTC_ENABLE()        ((void)0)
+
+/* RCC registers for the clock restore after STOP: every RCC-> access calls
+ * host_rcc_access(), where a test lets the oscillators come up and time pass */
+typedef struct { __IO uint32_t CR, PLLCFGR, CFGR; } RCC_TypeDef;
+extern RCC_TypeDef host_rcc;
+void host_rcc_access(void);
+static inline RCC_TypeDef *host_rcc_read(void)
+{
+    host_rcc_access();
+    return &host_rcc;
+}
+#define RCC (host_rcc_read())
+#define HSI_VALUE         16000000u
+#define RCC_CR_HSEON      0x00010000u
+#define RCC_CR_HSERDY     0x00020000u
+#define RCC_CR_PLLON      0x01000000u
+#define RCC_CR_PLLRDY     0x02000000u
+#define RCC_CFGR_SW_PLL   0x00000002u
+#define RCC_CFGR_SWS      0x0000000Cu
+#define RCC_CFGR_SWS_PLL  0x00000008u
+
+/* PWR: the low-power entries are the test's, the flags live in host_pwr */
+typedef struct { __IO uint32_t CR, CSR; } PWR_TypeDef;
+extern PWR_TypeDef host_pwr;
+#define PWR (&host_pwr)
+#define PWR_FLAG_WU               0x00000001u
+#define PWR_FLAG_SB               0x00000002u
+#define PWR_MAINREGULATOR_ON      0x00000000u
+#define PWR_LOWPOWERREGULATOR_ON  0x00000001u
+#define PWR_SLEEPENTRY_WFI        0x01u
+#define PWR_STOPENTRY_WFI         0x01u
+#define __HAL_PWR_GET_FLAG(f)     ((PWR->CSR & (f)) == (f))
+#define __HAL_PWR_CLEAR_FLAG(f)   (PWR->CSR &= ~(uint32_t)(f))
+
+void HAL_PWR_EnterSLEEPMode(uint32_t regulator, uint8_t entry);
+void HAL_PWR_EnterSTOPMode(uint32_t regulator, uint8_t entry);
+void HAL_PWR_EnterSTANDBYMode(void);
+void HAL_PWR_EnableBkUpAccess(void);
+
+/* GPIO --------------------------------------------------------------------- */
+typedef struct { __IO uint32_t IDR, ODR; } GPIO_TypeDef;
+extern GPIO_TypeDef host_gpio[3];
+#define GPIOA (&host_gpio[0])
+#define GPIOB (&host_gpio[1])
+#define GPIOC (&host_gpio[2])
+
+typedef struct { uint32_t Pin, Mode, Pull, Speed, Alternate; } GPIO_InitTypeDef;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+
+#define GPIO_PIN_0  0x0001u
+#define GPIO_PIN_1  0x0002u
+#define GPIO_PIN_4  0x0010u
+#define GPIO_PIN_5  0x0020u
+#define GPIO_PIN_6  0x0040u
+#define GPIO_PIN_7  0x0080u
+#define GPIO_PIN_13 0x2000u
+#define GPIO_MODE_INPUT             0x00000000u
+#define GPIO_MODE_OUTPUT_PP         0x00000001u
+#define GPIO_MODE_AF_PP             0x00000002u
+#define GPIO_MODE_AF_OD             0x00000012u
+#define GPIO_MODE_ANALOG            0x00000003u
+#define GPIO_MODE_IT_RISING         0x10110000u
+#define GPIO_MODE_IT_FALLING        0x10210000u
+#define GPIO_MODE_IT_RISING_FALLING 0x10310000u
+#define GPIO_NOPULL                 0u
+#define GPIO_PULLUP                 1u
+#define GPIO_SPEED_FREQ_LOW         0u
+#define GPIO_SPEED_FREQ_HIGH        2u
+#define GPIO_SPEED_FREQ_VERY_HIGH   3u
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init);
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *port, uint16_t pin);
+void HAL_GPIO_EXTI_IRQHandler(uint16_t pin);
+void HAL_GPIO_EXTI_Callback(uint16_t pin);
+#define __HAL_GPIO_EXTI_CLEAR_IT(pin) ((void)(pin))
+
+/* EXTI: IMR gates the test's edges, nothing else is modelled */
+typedef struct { __IO uint32_t IMR, EMR, RTSR, FTSR, SWIER, PR; } EXTI_TypeDef;
+extern EXTI_TypeDef host_exti;
+#define EXTI (&host_exti)
+
+/* DMA ---------------------------------------------------------------------- */
+typedef struct {
+    __IO uint32_t CR;
+    __IO uint32_t NDTR;           /* items left; the test counts it down */
+} DMA_Stream_TypeDef;
+
+extern DMA_Stream_TypeDef host_dma_stream[16];
+#define DMA1_Stream2 (&host_dma_stream[2])
+#define DMA1_Stream5 (&host_dma_stream[5])
+#define DMA1_Stream6 (&host_dma_stream[6])
+#define DMA2_Stream0 (&host_dma_stream[8])
+#define DMA2_Stream1 (&host_dma_stream[9])
+#define DMA2_Stream2 (&host_dma_stream[10])
+#define DMA2_Stream3 (&host_dma_stream[11])
+#define DMA2_Stream7 (&host_dma_stream[15])
+
+typedef struct {
+    uint32_t Channel, Direction, PeriphInc, MemInc, PeriphDataAlignment, MemDataAlignment, Mode, Priority,
+             FIFOMode;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_Stream_TypeDef *Instance;
+    void *Parent;
+    DMA_InitTypeDef Init;
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef *h);
+    void (*XferErrorCallback)(struct __DMA_HandleTypeDef *h);
+} DMA_HandleTypeDef;
+
+#define DMA_CHANNEL_0           0x00000000u
+#define DMA_CHANNEL_3           0x06000000u
+#define DMA_CHANNEL_4           0x08000000u
+#define DMA_CHANNEL_5           0x0A000000u
+#define DMA_PERIPH_TO_MEMORY    0x00000000u
+#define DMA_MEMORY_TO_PERIPH    0x00000040u
+#define DMA_MEMORY_TO_MEMORY    0x00000080u
+#define DMA_PINC_ENABLE         0x00000200u
+#define DMA_PINC_DISABLE        0x00000000u
+#define DMA_MINC_ENABLE         0x00000400u
+#define DMA_PDATAALIGN_BYTE     0x00000000u
+#define DMA_PDATAALIGN_HALFWORD 0x00000800u
+#define DMA_PDATAALIGN_WORD     0x00001000u
+#define DMA_MDATAALIGN_BYTE     0x00000000u
+#define DMA_MDATAALIGN_HALFWORD 0x00002000u
+#define DMA_MDATAALIGN_WORD     0x00004000u
+#define DMA_NORMAL              0x00000000u
+#define DMA_CIRCULAR            0x00000100u
+#define DMA_PRIORITY_LOW        0x00000000u
+#define DMA_PRIORITY_HIGH       0x00020000u
+#define DMA_FIFOMODE_DISABLE    0x00000000u
+#define HAL_DMA_FULL_TRANSFER   0x00u
+
+#define __HAL_DMA_GET_COUNTER(h) ((h)->Instance->NDTR)
+#define __HAL_LINKDMA(h, field, dma) \
+    do {                             \
+        (h)->field = &(dma);         \
+        (dma).Parent = (h);          \
+    } while (0)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *h);
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *h, uint32_t src, uint32_t dst, uint32_t n);
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *h, uint32_t src, uint32_t dst, uint32_t n);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *h);
+HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *h, uint32_t level, uint32_t timeout);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *h);
+
+/* UART --------------------------------------------------------------------- */
+typedef struct { uint32_t id; } USART_TypeDef;
+extern USART_TypeDef host_usart[7];
+#define USART1 (&host_usart[1])
+#define USART2 (&host_usart[2])
+#define USART6 (&host_usart[6])
+
+typedef enum {
+    HAL_UART_STATE_RESET = 0x00u,
+    HAL_UART_STATE_READY = 0x20u,
+    HAL_UART_STATE_BUSY_TX = 0x21u,
+} HAL_UART_StateTypeDef;
+
+typedef struct {
+    uint32_t BaudRate, WordLength, StopBits, Parity, Mode, HwFlowCtl, OverSampling;
+} UART_InitTypeDef;
+
+typedef struct __UART_HandleTypeDef {
+    USART_TypeDef *Instance;
+    UART_InitTypeDef Init;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+    __IO HAL_UART_StateTypeDef gState;
+} UART_HandleTypeDef;
+
+#define UART_WORDLENGTH_8B    0x00000000u
+#define UART_STOPBITS_1       0x00000000u
+#define UART_PARITY_NONE      0x00000000u
+#define UART_MODE_TX_RX       0x0000000Cu
+#define UART_HWCONTROL_NONE   0x00000000u
+#define UART_OVERSAMPLING_16  0x00000000u
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size);
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart);
+
+/* I2C ---------------------------------------------------------------------- */
+typedef struct { uint32_t id; } I2C_TypeDef;
+extern I2C_TypeDef host_i2c[4];
+#define I2C1 (&host_i2c[1])
+
+typedef struct {
+    uint32_t ClockSpeed, DutyCycle, Timing, OwnAddress1, AddressingMode, DualAddressMode, OwnAddress2,
+             GeneralCallMode, NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef struct __I2C_HandleTypeDef {
+    I2C_TypeDef *Instance;
+    I2C_InitTypeDef Init;
+    __IO uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+#define I2C_MEMADD_SIZE_8BIT   0x00000001u
+#define I2C_ADDRESSINGMODE_7BIT 0x00004000u
+#define I2C_DUALADDRESS_DISABLE 0x00000000u
+#define I2C_GENERALCALL_DISABLE 0x00000000u
+#define I2C_NOSTRETCH_DISABLE   0x00000000u
+#define HAL_I2C_ERROR_AF       0x00000004u
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef *hi2c, uint16_t addr, uint32_t trials, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef *hi2c, uint16_t addr);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t mem, uint16_t mem_size,
+                                      uint8_t *data, uint16_t size);
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_AbortCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef *hi2c);
+
+/* TIM ---------------------------------------------------------------------- */
+typedef struct { __IO uint32_t CNT, ARR, CCR1, CCR2, CCR3, CCR4, DIER; } TIM_TypeDef;
+extern TIM_TypeDef host_tim[15];
+#define TIM2 (&host_tim[2])
+#define TIM3 (&host_tim[3])
+#define TIM9 (&host_tim[9])
+
+typedef struct {
+    uint32_t Prescaler, CounterMode, Period, ClockDivision, RepetitionCounter, AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct { uint32_t OCMode, Pulse, OCPolarity, OCNPolarity, OCFastMode, OCIdleState, OCNIdleState; } TIM_OC_InitTypeDef;
+
+#define TIM_DMA_ID_UPDATE 0u
+typedef struct __TIM_HandleTypeDef {
+    TIM_TypeDef *Instance;
+    TIM_Base_InitTypeDef Init;
+    DMA_HandleTypeDef *hdma[7];
+} TIM_HandleTypeDef;
+
+#define TIM_COUNTERMODE_UP             0x00000000u
+#define TIM_CLOCKDIVISION_DIV1         0x00000000u
+#define TIM_AUTORELOAD_PRELOAD_ENABLE  0x00000080u
+#define TIM_OCMODE_PWM1                0x00000060u
+#define TIM_OCPOLARITY_HIGH            0x00000000u
+#define TIM_OCFAST_DISABLE             0x00000000u
+#define TIM_CHANNEL_1                  0x00000000u
+#define TIM_DMA_UPDATE                 0x00000100u
+
+#define __HAL_TIM_GET_COUNTER(h)          ((h)->Instance->CNT)
+#define __HAL_TIM_SET_COMPARE(h, ch, v)   ((void)(ch), (h)->Instance->CCR1 = (v))
+#define __HAL_TIM_ENABLE_DMA(h, src)      ((h)->Instance->DIER |= (src))
+#define __HAL_TIM_DISABLE_DMA(h, src)     ((h)->Instance->DIER &= ~(uint32_t)(src))
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *c, uint32_t ch);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t ch);
+
+/* SPI ---------------------------------------------------------------------- */
+typedef struct { uint32_t id; } SPI_TypeDef;
+extern SPI_TypeDef host_spi[2];
+#define SPI1 (&host_spi[1])
+
+typedef struct {
+    uint32_t Mode, Direction, DataSize, CLKPolarity, CLKPhase, NSS, BaudRatePrescaler, FirstBit, TIMode,
+             CRCCalculation, CRCPolynomial;
+} SPI_InitTypeDef;
+
+typedef struct __SPI_HandleTypeDef {
+    SPI_TypeDef *Instance;
+    SPI_InitTypeDef Init;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+} SPI_HandleTypeDef;
+
+#define SPI_MODE_MASTER             0x00000104u
+#define SPI_DIRECTION_2LINES        0x00000000u
+#define SPI_DATASIZE_8BIT           0x00000000u
+#define SPI_POLARITY_LOW            0x00000000u
+#define SPI_PHASE_1EDGE             0x00000000u
+#define SPI_NSS_SOFT                0x00000200u
+#define SPI_BAUDRATEPRESCALER_16    0x00000018u
+#define SPI_FIRSTBIT_MSB            0x00000000u
+#define SPI_TIMODE_DISABLE          0x00000000u
+#define SPI_CRCCALCULATION_DISABLE  0x00000000u
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *tx, uint8_t *rx, uint16_t n,
+                                          uint32_t timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef *hspi, uint8_t *tx, uint8_t *rx, uint16_t n);
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi);
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi);
+
+/* ADC ---------------------------------------------------------------------- */
+typedef struct { uint32_t id; } ADC_TypeDef;
+extern ADC_TypeDef host_adc[2];
+#define ADC1 (&host_adc[1])
+
+typedef struct {
+    uint32_t ClockPrescaler, Resolution, DataAlign, ScanConvMode, ContinuousConvMode, DiscontinuousConvMode,
+             NbrOfConversion, ExternalTrigConv, ExternalTrigConvEdge, DMAContinuousRequests, EOCSelection;
+} ADC_InitTypeDef;
+
+typedef struct __ADC_HandleTypeDef {
+    ADC_TypeDef *Instance;
+    ADC_InitTypeDef Init;
+    DMA_HandleTypeDef *DMA_Handle;
+} ADC_HandleTypeDef;
+
+typedef struct { uint32_t Channel, Rank, SamplingTime; } ADC_ChannelConfTypeDef;
+
+#define ENABLE  1u
+#define DISABLE 0u
+#define ADC_CHANNEL_0           0u
+#define ADC_CHANNEL_1           1u
+#define ADC_CHANNEL_4           4u
+#define ADC_CHANNEL_8           8u
+#define ADC_RESOLUTION_12B      0x00000000u
+#define ADC_DATAALIGN_RIGHT     0x00000000u
+#define ADC_SCAN_ENABLE         0x00000001u
+#define ADC_EOC_SEQ_CONV        0x00000000u
+#define ADC_SAMPLETIME_84CYCLES 0x00000005u
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *c);
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *buf, uint32_t n);
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc);
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc);
+
+/* RTC ---------------------------------------------------------------------- */
+typedef struct { uint32_t id; } RTC_TypeDef;
+extern RTC_TypeDef host_rtc;
+#define RTC (&host_rtc)
+
+typedef struct { uint32_t HourFormat, AsynchPrediv, SynchPrediv, OutPut, OutPutPolarity, OutPutType; } RTC_InitTypeDef;
+
+typedef struct __RTC_HandleTypeDef {
+    RTC_TypeDef *Instance;
+    RTC_InitTypeDef Init;
+} RTC_HandleTypeDef;
+
+typedef struct { uint8_t Hours, Minutes, Seconds; uint32_t SubSeconds, SecondFraction; } RTC_TimeTypeDef;
+typedef struct { uint8_t WeekDay, Month, Date, Year; } RTC_DateTypeDef;
+
+#define RTC_HOURFORMAT_24   0x00000000u
+#define RTC_OUTPUT_DISABLE  0x00000000u
+#define RTC_FORMAT_BIN      0x00000000u
+
+HAL_StatusTypeDef HAL_RTC_Init(RTC_HandleTypeDef *hrtc);
+HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *t, uint32_t format);
+HAL_StatusTypeDef HAL_RTC_GetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *d, uint32_t format);
+HAL_StatusTypeDef HAL_RTC_WaitForSynchro(RTC_HandleTypeDef *hrtc);
+#define __HAL_RTC_WRITEPROTECTION_DISABLE(h) ((void)(h))
+#define __HAL_RTC_WRITEPROTECTION_ENABLE(h)  ((void)(h))
+
+/* Wakeup timer and backup registers (RTCEx) */
+#define RTC_WAKEUPCLOCK_RTCCLK_DIV16    0x00000000u
+#define RTC_WAKEUPCLOCK_CK_SPRE_16BITS  0x00000004u
+#define RTC_BKP_DR0                     0x00000000u
+#define RTC_BKP_DR1                     0x00000001u
+
+HAL_StatusTypeDef HAL_RTCEx_SetWakeUpTimer_IT(RTC_HandleTypeDef *hrtc, uint32_t counter, uint32_t clock);
+HAL_StatusTypeDef HAL_RTCEx_DeactivateWakeUpTimer(RTC_HandleTypeDef *hrtc);
+void HAL_RTCEx_WakeUpTimerIRQHandler(RTC_HandleTypeDef *hrtc);
+void HAL_RTCEx_WakeUpTimerEventCallback(RTC_HandleTypeDef *hrtc);
+uint32_t HAL_RTCEx_BKUPRead(RTC_HandleTypeDef *hrtc, uint32_t reg);
+void HAL_RTCEx_BKUPWrite(RTC_HandleTypeDef *hrtc, uint32_t reg, uint32_t data);
+
+#endif /* STM32XX_HAL_HOST_H */
@@ -0,0 +1,82 @@
+/* Host test for 13_print_time.c: every field value 0..255 in every position
+ * against snprintf("%02u") (values above 99 must read 99), the fixed 16-byte
+ * layout and the hand-off to the logger. --bench times Print_Time() against
+ * the former snprintf formatting, in ns and TSC cycles per timestamp.
+ */
+#include <stdio.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+typedef struct { uint8_t hour, min, sec, mday, mon, year; } DS_TIME;
+static DS_TIME rtc;
+void DS3231_get(DS_TIME *t) { *t = rtc; }
+
+static char     sent[64];
+static uint32_t sent_len, sends;
+bool uart_log_write(const void *data, uint32_t n)
+{
+    memcpy(sent, data, n);
+    sent_len = n;
+    sends++;
+    return true;
+}
+
+#include "../13_print_time.c"
+
+static void expect(const DS_TIME *t)
+{
+    unsigned f[6] = { t->hour, t->min, t->sec, t->mday, t->mon, t->year };
+    for (int i = 0; i < 6; ++i) f[i] = f[i] > 99u ? 99u : f[i];
+    char want[32];
+    snprintf(want, sizeof want, "D:%02u%02u%02u_%02u%02u%02u;", f[0], f[1], f[2], f[3], f[4], f[5]);
+    CHECK_EQ(sent_len, TIME_STAMP_LEN);
+    CHECK(memcmp(sent, want, TIME_STAMP_LEN) == 0);
+}
+
+static void bench(void)
+{
+    enum { N = 2000000 };
+    char buf[32];
+    uint64_t t0 = host_ns(), c0 = host_cycles();
+    for (int i = 0; i < N; ++i) {
+        rtc.sec = (uint8_t)(i % 60);
+        Print_Time();
+        host_sink += (uint8_t)sent[7];
+    }
+    uint64_t c1 = host_cycles(), t1 = host_ns();
+    for (int i = 0; i < N; ++i) {
+        rtc.sec = (uint8_t)(i % 60);
+        DS_TIME t;
+        DS3231_get(&t);
+        snprintf(buf, sizeof buf, "D:%02u%02u%02u_%02u%02u%02u;", t.hour, t.min, t.sec, t.mday, t.mon, t.year);
+        uart_log_write(buf, TIME_STAMP_LEN);
+        host_sink += (uint8_t)sent[7];
+    }
+    uint64_t c2 = host_cycles(), t2 = host_ns();
+    printf("two-digit table: %6.1f ns, %6.1f cycles per timestamp\n", (double)(t1 - t0) / N,
+           (double)(c1 - c0) / N);
+    printf("snprintf:        %6.1f ns, %6.1f cycles per timestamp\n", (double)(t2 - t1) / N,
+           (double)(c2 - c1) / N);
+}
+
+int main(int argc, char **argv)
+{
+    for (unsigned v = 0; v < 256; ++v) {
+        for (int field = 0; field < 6; ++field) {
+            rtc = (DS_TIME){ 12, 34, 56, 7, 8, 25 };
+            ((uint8_t *)&rtc)[field] = (uint8_t)v;
+            Print_Time();
+            expect(&rtc);
+        }
+    }
+    rtc = (DS_TIME){ 23, 59, 59, 31, 12, 99 };
+    Print_Time();
+    CHECK(memcmp(sent, "D:235959_311299;", TIME_STAMP_LEN) == 0);
+    CHECK_EQ(sends, 256u * 6u + 1u);
+
+    if (host_bench(argc, argv)) {
+        rtc = (DS_TIME){ 12, 34, 0, 7, 8, 25 };
+        bench();
+    }
+    return host_result("test_13_print_time");
+}
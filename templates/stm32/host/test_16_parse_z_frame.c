@@ -0,0 +1,146 @@
+/* Host test for 16_parse_z_frame.c: the single-pass parser against the former
+ * six-strstr() version on generated frames, plus fixed cases for what only the
+ * new one does (first key wins, micrometre position). --bench compares both.
+ */
+#include <stdlib.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+#define Z_POSITION_TEXT 1
+typedef struct {
+    char     position[32];
+    int32_t  position_um;
+    uint8_t  position_ok;
+    uint8_t  referenced;
+    uint8_t  busy;
+    uint8_t  back;
+    uint8_t  front;
+    uint8_t  speed;
+} RemoteState_t;
+RemoteState_t remoteState;
+
+#include "../16_parse_z_frame.c"
+
+/* The parser before user-051, writing into st instead of remoteState */
+static void parse_z_frame_strstr(const char *frame, RemoteState_t *st)
+{
+    RemoteState_t tmp = {0};
+    const char *tag = strstr(frame, "\"p\":");
+    if (tag) {
+        tag += 3;
+        while (*tag == ' ' || *tag == ':') ++tag;
+        size_t n = 0;
+        while (*tag && *tag != ',' && *tag != '}' && n < sizeof tmp.position - 1) tmp.position[n++] = *tag++;
+        tmp.position[n] = '\0';
+    }
+    if ((tag = strstr(frame, "\"r\":"))) { tag += 3; while (*tag == ' ' || *tag == ':') ++tag; tmp.referenced = (*tag == '1'); }
+    if ((tag = strstr(frame, "\"b\":"))) { tag += 3; while (*tag == ' ' || *tag == ':') ++tag; tmp.busy = (*tag == '1'); }
+    if ((tag = strstr(frame, "\"o\":"))) { tag += 3; while (*tag == ' ' || *tag == ':') ++tag; tmp.back = (*tag == '1'); }
+    if ((tag = strstr(frame, "\"u\":"))) { tag += 3; while (*tag == ' ' || *tag == ':') ++tag; tmp.front = (*tag == '1'); }
+    if ((tag = strstr(frame, "\"v\":"))) { tag += 3; while (*tag == ' ' || *tag == ':') ++tag; tmp.speed = (uint8_t)strtoul(tag, NULL, 10); }
+    __disable_irq();
+    *st = tmp;
+    __enable_irq();
+}
+
+/* Frame with each key at most once, in random order, some keys missing */
+static void gen_frame(char *out, size_t size)
+{
+    static const char keys[] = "prbouvxq";
+    char order[sizeof keys - 1];
+    memcpy(order, keys, sizeof order);
+    for (size_t i = sizeof order - 1; i > 0; --i) {
+        size_t j = host_rand() % (i + 1);
+        char t = order[i]; order[i] = order[j]; order[j] = t;
+    }
+    size_t n = 0;
+    out[n++] = '{';
+    for (size_t i = 0; i < sizeof order; ++i) {
+        if (host_rand() % 5 == 0) continue;
+        if (n > 1) out[n++] = ',';
+        const char *sp = (host_rand() % 4 == 0) ? " " : "";
+        char k = order[i];
+        if (k == 'p')
+            n += (size_t)snprintf(out + n, size - n, "\"p\":%s%s%u.%03u", sp, host_rand() % 3 ? "" : "-",
+                                  host_rand() % 1000, host_rand() % 1000);
+        else if (k == 'v')
+            n += (size_t)snprintf(out + n, size - n, "\"v\":%s%u", sp, host_rand() % 400);
+        else
+            n += (size_t)snprintf(out + n, size - n, "\"%c\":%s%u", k, sp, host_rand() % 2);
+    }
+    out[n++] = '}';
+    out[n] = '\0';
+}
+
+static void check_case(const char *frame, const RemoteState_t *want)
+{
+    parse_z_frame(frame);
+    CHECK_EQ(remoteState.position_ok, want->position_ok);
+    if (want->position_ok) CHECK_EQ(remoteState.position_um, want->position_um);
+    CHECK(strcmp(remoteState.position, want->position) == 0);
+    CHECK_EQ(remoteState.referenced, want->referenced);
+    CHECK_EQ(remoteState.busy, want->busy);
+    CHECK_EQ(remoteState.back, want->back);
+    CHECK_EQ(remoteState.front, want->front);
+    CHECK_EQ(remoteState.speed, want->speed);
+    CHECK_EQ(host_primask, 0);
+}
+
+static void bench(void)
+{
+    enum { FRAMES = 1024, ROUNDS = 2000 };
+    static char frames[FRAMES][96];
+    size_t bytes = 0;
+    for (int i = 0; i < FRAMES; ++i) {
+        snprintf(frames[i], sizeof frames[i], "{\"p\":%u.%03u,\"r\":1,\"b\":%u,\"o\":0,\"u\":1,\"v\":%u}",
+                 host_rand() % 1000, host_rand() % 1000, host_rand() % 2, host_rand() % 256);
+        bytes += strlen(frames[i]);
+    }
+    RemoteState_t st;
+    for (int pass = 0; pass < 2; ++pass) {
+        uint64_t t0 = host_ns(), c0 = host_cycles();
+        for (int r = 0; r < ROUNDS; ++r)
+            for (int i = 0; i < FRAMES; ++i) {
+                if (pass) parse_z_frame(frames[i]);
+                else parse_z_frame_strstr(frames[i], &st);
+            }
+        uint64_t ns = host_ns() - t0, cyc = host_cycles() - c0;
+        double n = (double)FRAMES * ROUNDS;
+        printf("%-22s %6.1f ns/frame %7.1f cycles/frame %6.0f MB/s\n", pass ? "single pass" : "strstr x6 (before)",
+               ns / n, cyc / n, bytes * (double)ROUNDS * 1e3 / ns);
+    }
+    host_sink = remoteState.speed + st.speed;
+}
+
+int main(int argc, char **argv)
+{
+    /* Same result as the former parser for unique keys */
+    for (int i = 0; i < 200000; ++i) {
+        char frame[160];
+        RemoteState_t want;
+        gen_frame(frame, sizeof frame);
+        parse_z_frame_strstr(frame, &want);
+        parse_z_frame(frame);
+        CHECK(strcmp(remoteState.position, want.position) == 0);
+        CHECK_EQ(remoteState.referenced, want.referenced);
+        CHECK_EQ(remoteState.busy, want.busy);
+        CHECK_EQ(remoteState.back, want.back);
+        CHECK_EQ(remoteState.front, want.front);
+        CHECK_EQ(remoteState.speed, want.speed);
+        CHECK_EQ(remoteState.position_ok, strstr(frame, "\"p\":") != NULL);
+    }
+
+    /* Fixed cases */
+    check_case("{\"p\":12.500,\"r\":1,\"b\":0,\"o\":0,\"u\":1,\"v\":40}",
+               &(RemoteState_t){ "12.500", 12500, 1, 1, 0, 0, 1, 40 });
+    check_case("{\"r\":1,\"r\":0,\"v\":7,\"v\":9}", &(RemoteState_t){ "", 0, 0, 1, 0, 0, 0, 7 });
+    check_case("{\"p\":-0.001}", &(RemoteState_t){ "-0.001", -1, 1, 0, 0, 0, 0, 0 });
+    check_case("{\"p\":abc,\"b\":1}", &(RemoteState_t){ "abc", 0, 0, 0, 1, 0, 0, 0 });
+    check_case("{\"zz\":1,\"q\":1,\"u\":1}", &(RemoteState_t){ "", 0, 0, 0, 0, 0, 1, 0 });
+    check_case("{\"v\":300}", &(RemoteState_t){ "", 0, 0, 0, 0, 0, 0, 44 });   /* 8-bit like strtoul cast */
+    check_case("{\"p", &(RemoteState_t){ "", 0, 0, 0, 0, 0, 0, 0 });           /* cut inside a tag */
+    check_case("", &(RemoteState_t){ "", 0, 0, 0, 0, 0, 0, 0 });
+
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_16_parse_z_frame");
+}
@@ -0,0 +1,142 @@
+/* Exhaustive round trip of the Z-frame position in 16_parse_z_frame.c: every
+ * micrometre from Z_POS_MIN_UM - 2 mm to Z_POS_MAX_UM + 2 mm is formatted the
+ * way the controller sends it ("%ld.%03ld") and decoded again; inside the
+ * limits it must come back unchanged, outside it must be refused. Random
+ * values also go through whole frames (with the text copy), through shortened
+ * decimals, a '+' sign and a rounded 4th decimal. test_16_z_roundtrip_narrow.c
+ * repeats it with limits overridden to an axis travel. --bench compares the
+ * decoder with strtod().
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+#define Z_POSITION_TEXT 1
+typedef struct {
+    char     position[32];
+    int32_t  position_um;
+    uint8_t  position_ok;
+    uint8_t  referenced;
+    uint8_t  busy;
+    uint8_t  back;
+    uint8_t  front;
+    uint8_t  speed;
+} RemoteState_t;
+RemoteState_t remoteState;
+
+#include "../16_parse_z_frame.c"
+
+#ifndef TEST_NAME
+#define TEST_NAME "test_16_z_roundtrip"
+#endif
+
+/* "[-]mm.ddd" without printf: the exhaustive loop formats 2e8 values */
+static size_t format_um(int64_t um, char *out)
+{
+    char tmp[24];
+    size_t n = 0, k = 0;
+    uint64_t a = um < 0 ? (uint64_t)-um : (uint64_t)um;
+    for (int i = 0; i < 3; ++i, a /= 10) tmp[k++] = (char)('0' + a % 10);
+    tmp[k++] = '.';
+    do { tmp[k++] = (char)('0' + a % 10); a /= 10; } while (a);
+    if (um < 0) out[n++] = '-';
+    while (k) out[n++] = tmp[--k];
+    out[n] = '\0';
+    return n;
+}
+
+static void check_exhaustive(void)
+{
+    char buf[32];
+    uint32_t bad = 0;
+    for (int64_t um = (int64_t)Z_POS_MIN_UM - 2000; um <= (int64_t)Z_POS_MAX_UM + 2000; ++um) {
+        format_um(um, buf);
+        int32_t got = INT32_MIN;
+        const char *end = z_decode_um(buf, &got);
+        bool in = um >= Z_POS_MIN_UM && um <= Z_POS_MAX_UM;
+        if (in ? (!end || *end || got != um) : end != NULL) {
+            if (bad++ < 5) fprintf(stderr, "%s -> %s %ld\n", buf, end ? "ok" : "refused", (long)got);
+        }
+    }
+    CHECK_EQ(bad, 0);
+}
+
+static int64_t rand_um(void)
+{
+    int64_t span = (int64_t)Z_POS_MAX_UM - Z_POS_MIN_UM + 1;
+    return Z_POS_MIN_UM + (int64_t)(((uint64_t)host_rand() << 32 | host_rand()) % (uint64_t)span);
+}
+
+static void check_variants(void)
+{
+    char buf[48], frame[96];
+    for (int r = 0; r < 200000; ++r) {
+        int64_t um = rand_um();
+        int32_t got;
+
+        /* Whole frame: value and text */
+        format_um(um, buf);
+        snprintf(frame, sizeof frame, "{\"r\":1,\"p\":%s,\"v\":40}", buf);
+        parse_z_frame(frame);
+        CHECK_EQ(remoteState.position_ok, 1);
+        CHECK_EQ(remoteState.position_um, um);
+        CHECK(strcmp(remoteState.position, buf) == 0);
+        CHECK_EQ(remoteState.speed, 40);
+
+        /* Trailing zeros dropped, down to no decimals */
+        size_t n = strlen(buf);
+        while (buf[n - 1] == '0' && buf[n - 2] != '.') buf[--n] = '\0';
+        if (buf[n - 1] == '0' && buf[n - 2] == '.') buf[n - 2] = '\0';
+        CHECK(z_decode_um(buf, &got) && got == um);
+
+        /* Explicit '+' */
+        if (um >= 0) {
+            snprintf(frame, sizeof frame, "+%s", buf);
+            CHECK(z_decode_um(frame, &got) && got == um);
+        }
+
+        /* 4th decimal rounds half away from zero, further ones are ignored */
+        int64_t tenth = um * 10 + (um < 0 ? -1 : 1) * (int64_t)(host_rand() % 10u);
+        int64_t d4 = (tenth < 0 ? -tenth : tenth) % 10;
+        int64_t want = um + (d4 >= 5 ? (tenth < 0 ? -1 : 1) : 0);
+        int64_t a = tenth < 0 ? -tenth : tenth;
+        snprintf(buf, sizeof buf, "%s%lld.%04lld%u", tenth < 0 ? "-" : "", (long long)(a / 10000),
+                 (long long)(a % 10000), host_rand() % 10u);
+        const char *end = z_decode_um(buf, &got);
+        if (want >= Z_POS_MIN_UM && want <= Z_POS_MAX_UM) CHECK(end && *end == '\0' && got == want);
+        else CHECK(end == NULL);
+    }
+
+    static const char *refused[] = { "", "-", "+", ".", "-.", "abc", "e3" };
+    int32_t got;
+    for (size_t i = 0; i < sizeof refused / sizeof refused[0]; ++i) CHECK(z_decode_um(refused[i], &got) == NULL);
+    CHECK(z_decode_um("99999999999999999999999999", &got) == NULL);
+}
+
+static void bench(void)
+{
+    enum { N = 1 << 16, ROUNDS = 100 };
+    static char text[N][24];
+    for (int i = 0; i < N; ++i) format_um(rand_um(), text[i]);
+    for (int pass = 0; pass < 2; ++pass) {
+        uint64_t t0 = host_ns();
+        for (int r = 0; r < ROUNDS; ++r)
+            for (int i = 0; i < N; ++i) {
+                int32_t um = 0;
+                if (pass) z_decode_um(text[i], &um);
+                else um = (int32_t)llround(strtod(text[i], NULL) * 1000.0);
+                host_sink += (uint32_t)um;
+            }
+        printf("%-18s %5.1f ns per position on the host\n", pass ? "z_decode_um" : "strtod + llround",
+               (double)(host_ns() - t0) / ((double)N * ROUNDS));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    check_exhaustive();
+    check_variants();
+    if (host_bench(argc, argv)) bench();
+    return host_result(TEST_NAME);
+}
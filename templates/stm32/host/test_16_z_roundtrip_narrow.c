@@ -0,0 +1,5 @@
+/* test_16_z_roundtrip.c with the limits narrowed to an axis travel */
+#define Z_POS_MIN_UM (-50000L)
+#define Z_POS_MAX_UM 350000L
+#define TEST_NAME    "test_16_z_roundtrip_narrow"
+#include "test_16_z_roundtrip.c"
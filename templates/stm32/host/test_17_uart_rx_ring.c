@@ -0,0 +1,292 @@
+/* Host test for 17_uart_rx_ring.c.
+ * Stress: one thread plays DMA plus RX event callback (writes bytes, counts NDTR
+ * down, calls the callback at half, full and sometimes idle), the other is the
+ * main loop (peek, copy, sometimes stall, release). Every frame released as
+ * intact must equal what was sent, and sent = delivered + overruns + lapped.
+ * A quarter of the frames are binary telemetry frames (33_telemetry_frame.c)
+ * whose payload is full of '#', '}', 0xA5 and 0x00.
+ * Then rx_poll() on one thread: normalize + dispatch, Z frames, too-long frames,
+ * binary Z frames between text, split by idle events, wrapping the ring end,
+ * with a bad CRC or a bad length byte.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+typedef enum { CMD_OK = 0, CMD_ERR_FORMAT } CmdStatus_t;
+void parse_z_frame(const char *frame);
+CmdStatus_t cmd_dispatch(const char *cmd, size_t len);
+
+#define TEMP_ACQ_MAX 8u
+typedef struct {
+    uint32_t tick;
+    uint8_t  count, valid, addr[TEMP_ACQ_MAX];
+    int16_t  raw[TEMP_ACQ_MAX];
+} TempSnapshot_t;
+#define Z_POSITION_TEXT 1
+typedef struct {
+    char     position[32];
+    int32_t  position_um;
+    uint8_t  position_ok, referenced, busy, back, front, speed;
+} RemoteState_t;
+RemoteState_t remoteState;
+
+#include "../33_telemetry_frame.c"
+#include "../17_uart_rx_ring.c"
+#include "../18_normalize_command.c"
+
+static DMA_Stream_TypeDef dma_stream;
+static DMA_HandleTypeDef  hdma_rx = { .Instance = &dma_stream };
+UART_HandleTypeDef        huart6 = { .Instance = USART6, .hdmarx = &hdma_rx };
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size)
+{
+    (void)huart; (void)data;
+    dma_stream.NDTR = size;
+    return HAL_OK;
+}
+
+/* DMA: write one byte, then count NDTR down; callbacks at half and full */
+static uint32_t dma_pos;
+static void dma_put(uint8_t c)
+{
+    rx.buf[dma_pos] = c;
+    dma_pos = (dma_pos + 1u) & (RX_RING_SIZE - 1u);
+    __DMB();
+    dma_stream.NDTR = RX_RING_SIZE - dma_pos;
+    if (dma_pos == RX_RING_SIZE / 2) HAL_UARTEx_RxEventCallback(&huart6, RX_RING_SIZE / 2);
+    if (dma_pos == 0) HAL_UARTEx_RxEventCallback(&huart6, RX_RING_SIZE);
+}
+
+static void dma_idle(void)
+{
+    if (dma_pos) HAL_UARTEx_RxEventCallback(&huart6, (uint16_t)dma_pos);
+}
+
+/* Binary frame for a sequence number: the payload starts with seq (LE), then
+ * bytes a delimiter scan would trip over */
+static size_t make_bin_frame(uint32_t seq, uint32_t r, char *out)
+{
+    static const uint8_t tricky[] = { '#', '}', 0xA5, 0x00, '{', '>', 0x7D, 0x23 };
+    uint8_t *p = (uint8_t *)out;
+    size_t len = 4u + (r >> 12) % (TLM_MAX_PAYLOAD - 3u);
+    tlm_put32(p + TLM_HDR_LEN, seq);
+    for (size_t i = 4; i < len; ++i)
+        p[TLM_HDR_LEN + i] = (r >> (i % 24u)) & 1u ? tricky[(r + i) % sizeof tricky] : (uint8_t)(r * i >> 7);
+    return tlm_seal(p, (uint8_t)(r >> 20), len);
+}
+
+/* Frame for a sequence number: '>' or '{', 8 hex digits, letters, '#' or '}';
+ * one in four is binary. Roughly one in 400 is longer than the ring. */
+static size_t make_frame(uint32_t seq, char *out)
+{
+    uint32_t r = seq * 2654435761u;
+    if ((r >> 4) % 4u == 0) return make_bin_frame(seq, r, out);
+    size_t pad = (r >> 8) % 400u == 0 ? 300u : (r >> 16) % 40u;
+    bool z = r & 1u;
+    size_t n = 0;
+    out[n++] = z ? '{' : '>';
+    n += (size_t)sprintf(out + n, "%08X", seq);
+    for (size_t i = 0; i < pad; ++i) out[n++] = (char)('A' + (r + i) % 26u);
+    out[n++] = z ? '}' : '#';
+    return n;
+}
+
+enum { STRESS_FRAMES = 300000 };
+static volatile bool producer_done;
+
+static void *producer(void *arg)
+{
+    (void)arg;
+    char frame[400];
+    for (uint32_t seq = 0; seq < STRESS_FRAMES; ++seq) {
+        size_t n = make_frame(seq, frame);
+        for (size_t i = 0; i < n; ++i) dma_put((uint8_t)frame[i]);
+        if (host_rand() % 4 == 0) dma_idle();
+        if (host_rand() % 8u) sched_yield();          /* line rate: let the main loop run */
+    }
+    dma_idle();
+    __DMB();
+    producer_done = true;
+    return NULL;
+}
+
+static void stress(void)
+{
+    uint32_t delivered = 0, bad = 0, last = 0;
+    bool any = false;
+    uint32_t rng = 12345u;
+    pthread_t t;
+    pthread_create(&t, NULL, producer, NULL);
+    for (;;) {
+        bool done = producer_done;
+        RxView_t v;
+        if (!rx_ring_peek(&v)) {
+            if (done && rx.q_tail == rx.q_head) break;
+            sched_yield();
+            continue;
+        }
+        char got[RX_RING_SIZE + 1], want[400];
+        size_t n = rx_view_copy(&v, got, sizeof got);
+        rng = rng * 1664525u + 1013904223u;
+        if ((rng >> 24) < 8) sched_yield();                 /* main loop busy elsewhere */
+        if (!rx_ring_release(&v)) continue;                  /* counted in lapped */
+        uint32_t seq = 0;
+        bool bin = (uint8_t)got[0] == TLM_SYNC;
+        if (bin) seq = tlm_get32((const uint8_t *)got + TLM_HDR_LEN);
+        else sscanf(got + 1, "%8X", &seq);
+        size_t wn = make_frame(seq, want);
+        if (n != wn || memcmp(got, want, n) != 0 || (any && seq <= last)) bad++;
+        if (v.type != (bin ? RX_FRAME_BIN : (RxFrameType_t)got[n - 1])) bad++;
+        last = seq;
+        any = true;
+        delivered++;
+    }
+    pthread_join(t, NULL);
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(delivered + rx.overruns + rx.lapped, STRESS_FRAMES);
+    CHECK(delivered > STRESS_FRAMES / 2);
+    printf("stress: %u frames, %u delivered, %u overruns, %u lapped\n", STRESS_FRAMES, delivered,
+           (unsigned)rx.overruns, (unsigned)rx.lapped);
+}
+
+/* rx_poll() sinks */
+static char   z_seen[RX_RING_SIZE];
+static char   cmd_seen[RX_CMD_MAX];
+static size_t cmd_len;
+static int    z_calls, cmd_calls;
+
+void parse_z_frame(const char *frame)
+{
+    snprintf(z_seen, sizeof z_seen, "%s", frame);
+    z_calls++;
+}
+
+CmdStatus_t cmd_dispatch(const char *cmd, size_t len)
+{
+    memcpy(cmd_seen, cmd, len + 1);
+    cmd_len = len;
+    cmd_calls++;
+    return CMD_OK;
+}
+
+static void feed(const char *s)
+{
+    while (*s) dma_put((uint8_t)*s++);
+    dma_idle();
+}
+
+static void feed_bytes(const uint8_t *p, size_t n)
+{
+    while (n--) dma_put(*p++);
+    dma_idle();
+}
+
+/* Binary Z frames: payload bytes '#' and '}' do not split them */
+static void bin_cases(void)
+{
+    RemoteState_t st = { .position_um = 0x7D23A523, .referenced = 1, .busy = 1, .speed = '}' };
+    uint8_t f[TLM_FRAME_MAX];
+    size_t n = tlm_frame_z(f, sizeof f, &st);
+    CHECK(memchr(f + 1, '#', n - 1) && memchr(f + 1, '}', n - 1));
+
+    int z0 = z_calls, c0 = cmd_calls;
+    feed(">TST#\r\n");
+    feed_bytes(f, n);
+    feed("{\"p\":2.0}>TRF#");
+    rx_poll();
+    CHECK_EQ(remoteState.position_um, 0x7D23A523);
+    CHECK_EQ(remoteState.speed, '}');
+    CHECK(remoteState.referenced && remoteState.busy && !remoteState.position_ok);
+    CHECK_EQ(z_calls, z0 + 1);
+    CHECK_EQ(cmd_calls, c0 + 2);
+    CHECK(strcmp(cmd_seen, ">RF#") == 0);
+    CHECK_EQ(rx.bin_errors, 0);
+
+    /* Split by idle events, and at every position of the ring */
+    for (int r = 0; r < 3 * (int)RX_RING_SIZE; ++r) {
+        st.position_um = (int32_t)host_rand();
+        st.speed = (uint8_t)host_rand();
+        st.front = r & 1;
+        n = tlm_frame_z(f, sizeof f, &st);
+        size_t cut = host_rand() % n;
+        feed_bytes(f, cut);
+        feed_bytes(f + cut, n - cut);
+        if (r % 3 == 0) feed("\r\n");                   /* undelimited text between frames */
+        rx_poll();
+        CHECK_EQ(remoteState.position_um, st.position_um);
+        CHECK_EQ(remoteState.speed, st.speed);
+        CHECK_EQ(remoteState.front, st.front);
+    }
+    CHECK_EQ(rx.bin_errors, 0);
+
+    /* Bad CRC: refused, the next command still arrives */
+    f[n - 1] ^= 0x40u;
+    c0 = cmd_calls;
+    feed_bytes(f, n);
+    feed(">TZ#");
+    rx_poll();
+    CHECK_EQ(rx.bin_errors, 1);
+    CHECK_EQ(cmd_calls, c0 + 1);
+
+    /* Length byte above TLM_MAX_PAYLOAD: the frame ends after the header */
+    static const uint8_t bad_len[] = { TLM_SYNC, TLM_VERSION, TLM_TYPE_Z, 0xFF };
+    feed_bytes(bad_len, sizeof bad_len);
+    feed(">TEN#");
+    rx_poll();
+    CHECK_EQ(rx.bin_errors, 2);
+    CHECK_EQ(cmd_calls, c0 + 2);
+    CHECK(strcmp(cmd_seen, ">EN#") == 0);
+}
+
+static void poll_cases(void)
+{
+    feed("\r\n>TMA090.000#");
+    rx_poll();
+    CHECK_EQ(cmd_calls, 1);
+    CHECK(strcmp(cmd_seen, ">MA090.000#") == 0);
+    CHECK_EQ(cmd_len, 11);
+
+    feed("{\"p\":1.5,\"r\":1}");
+    rx_poll();
+    CHECK_EQ(z_calls, 1);
+    CHECK(strcmp(z_seen, "{\"p\":1.5,\"r\":1}") == 0);
+
+    /* Longer than the buffers: reported, never acted on */
+    char big[200];
+    memset(big, 'x', sizeof big);
+    big[0] = '{';
+    big[sizeof big - 1] = '\0';
+    feed(big);
+    feed("}");
+    feed(">MA0000000000000000000000000000000001#");
+    rx_poll();
+    CHECK_EQ(rx.too_long, 2);
+    CHECK_EQ(z_calls, 1);
+    CHECK_EQ(cmd_calls, 1);
+
+    /* Overwritten while held: release says so */
+    RxView_t v;
+    feed(">ST#");
+    CHECK(rx_ring_peek(&v));
+    for (uint32_t i = 0; i < RX_RING_SIZE; ++i) dma_put('.');
+    CHECK(!rx_ring_release(&v));
+    CHECK_EQ(rx.lapped, 1);
+    CHECK(!rx_ring_peek(&v));
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    rx_ring_start(&huart6);
+    poll_cases();
+    dma_pos = 0;
+    rx_ring_start(&huart6);
+    bin_cases();
+
+    dma_pos = 0;
+    rx_ring_start(&huart6);
+    stress();
+    return host_result("test_17_uart_rx_ring");
+}
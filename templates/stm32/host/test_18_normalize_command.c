@@ -0,0 +1,99 @@
+/* Host test for 18_normalize_command.c, differential:
+ * - normalize_command() against sanitize_command() + strip_T_after_chevron()
+ *   (templates 12 and 11) for every string up to 6 bytes over the bytes that
+ *   matter, in exact-size heap buffers so ASan sees any read past buf_size;
+ * - normalize_command_from_view() against copy + normalize_command() for the
+ *   same strings split into two segments at every position.
+ */
+#include <stdlib.h>
+#include "host_test.h"
+
+typedef enum { RX_FRAME_CMD = '#', RX_FRAME_Z = '}' } RxFrameType_t;
+typedef struct {
+    const uint8_t *seg[2];
+    uint16_t       len[2];
+    RxFrameType_t  type;
+    uint32_t       start;
+} RxView_t;
+
+#include "../11_strip_T_after_chevron.c"
+#include "../12_sanitize_command.c"
+#include "../18_normalize_command.c"
+
+static const char alphabet[] = "\r\n>TZ#M";
+enum { ALPHA = sizeof alphabet - 1, MAX_LEN = 6 };
+
+static void check_string(const char *s, size_t len)
+{
+    for (size_t extra = 1; extra <= 3; ++extra) {
+        size_t size = len + extra;
+        char  *a = malloc(size), *b = malloc(size);
+        memcpy(a, s, len);
+        memset(a + len, 0, extra);
+        memcpy(b, a, size);
+
+        sanitize_command(a, size);
+        strip_T_after_chevron(a, size);
+        size_t n = normalize_command(b, size);
+        CHECK(strcmp(a, b) == 0);
+        CHECK_EQ(n, strlen(b));
+        free(a);
+        free(b);
+    }
+
+    /* From a view, split at every position, into outputs of several sizes */
+    for (size_t out_size = 1; out_size <= len + 2; ++out_size) {
+        char *flat = malloc(out_size), *out = malloc(out_size);
+        size_t m = len < out_size - 1 ? len : out_size - 1;
+        memcpy(flat, s, m);
+        flat[m] = '\0';
+        size_t want = normalize_command(flat, out_size);
+        for (size_t cut = 0; cut <= len; ++cut) {
+            uint8_t *seg0 = malloc(cut + 1), *seg1 = malloc(len - cut + 1);
+            memcpy(seg0, s, cut);
+            memcpy(seg1, s + cut, len - cut);
+            RxView_t v = { { seg0, seg1 }, { (uint16_t)cut, (uint16_t)(len - cut) }, RX_FRAME_CMD, 0 };
+            size_t got = normalize_command_from_view(&v, out, out_size);
+            CHECK_EQ(got, want);
+            CHECK(strcmp(out, flat) == 0);
+            free(seg0);
+            free(seg1);
+        }
+        free(flat);
+        free(out);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    char s[MAX_LEN];
+    unsigned long count = 0;
+    for (size_t len = 0; len <= MAX_LEN; ++len) {
+        unsigned long total = 1;
+        for (size_t i = 0; i < len; ++i) total *= ALPHA;
+        for (unsigned long k = 0; k < total; ++k, ++count) {
+            unsigned long x = k;
+            for (size_t i = 0; i < len; ++i, x /= ALPHA) s[i] = alphabet[x % ALPHA];
+            check_string(s, len);
+        }
+    }
+
+    /* Real commands */
+    const char *cases[][2] = {
+        { "\r\n>TMA090.000#", ">MA090.000#" },
+        { "TZ#", ">Z#" },
+        { "\nZ#", ">Z#" },
+        { ">TTZ#", ">TZ#" },
+        { ">Z#", ">Z#" },
+        { "\r\r\n", "" },
+    };
+    for (size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+        char buf[32];
+        snprintf(buf, sizeof buf, "%s", cases[i][0]);
+        normalize_command(buf, sizeof buf);
+        CHECK(strcmp(buf, cases[i][1]) == 0);
+    }
+    printf("%lu strings compared\n", count);
+    return host_result("test_18_normalize_command");
+}
@@ -0,0 +1,157 @@
+/* Host test for 19_temp_acquisition.c with a timed I2C mock: each read takes
+ * 1 ms, one address never answers, one read is refused as bus busy. Checks the
+ * order of reads, the 10 ms gap, the 250 ms period, the published values and
+ * that temp_acq_poll() never waits; then measure_temperatures_cached() text,
+ * including a buffer that is too small. --bench times the cached JSON.
+ */
+#include "host_test.h"
+#include "stm32xx_hal.h"
+#include "../19_temp_acquisition.c"
+
+typedef enum { TLM_FMT_JSON, TLM_FMT_BINARY } TlmFormat_t;
+TlmFormat_t tlm_format(void) { return TLM_FMT_JSON; }
+size_t tlm_frame_temperatures(uint8_t *out, size_t cap, const TempSnapshot_t *s)
+{
+    (void)out; (void)cap; (void)s;
+    return 0;
+}
+bool uart_log_write(const void *data, uint32_t n) { (void)data; (void)n; return true; }
+#include "../20_json_telemetry.c"
+
+static I2C_HandleTypeDef hi2c1 = { .Instance = I2C1 };
+
+/* Mock bus: one transfer at a time, completes 1 ms after it started */
+#define NACK_ADDR 0x4Du
+static bool     bus_busy;
+static uint32_t bus_done_at, bus_addr, reads, refuse_next, delays;
+static uint8_t *bus_dst;
+static uint32_t round_no;
+static uint32_t last_end, last_start_of_round = UINT32_MAX;
+static uint8_t  expect_idx;
+
+static const uint8_t addrs[] = { 73, 72, NACK_ADDR, 75, 79 };
+
+static int16_t sensor_raw(uint8_t addr, uint32_t round) { return (int16_t)(addr * 4 + round % 64) - 300; }
+
+void HAL_Delay(uint32_t ms) { (void)ms; delays++; }
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t mem, uint16_t mem_size,
+                                      uint8_t *data, uint16_t size)
+{
+    (void)hi2c; (void)mem_size;
+    CHECK(!bus_busy);
+    CHECK_EQ(mem, TMP1075_REG_TEMP);
+    CHECK_EQ(size, 2);
+    uint8_t a = (uint8_t)(addr >> 1);
+    CHECK_EQ(a, tacq.addr[expect_idx]);                       /* address order */
+    if (expect_idx == 0) {
+        if (last_start_of_round != UINT32_MAX) CHECK_EQ(uwTick - last_start_of_round, TEMP_ACQ_PERIOD_MS);
+        last_start_of_round = uwTick;
+    } else {
+        CHECK(uwTick - last_end >= TEMP_ACQ_GAP_MS);          /* gap after the previous read */
+        CHECK(uwTick - last_end <= TEMP_ACQ_GAP_MS + 1);
+    }
+    if (refuse_next) {                                         /* handled like a failed read */
+        refuse_next = 0;
+        last_end = uwTick;
+        expect_idx = (uint8_t)((expect_idx + 1u) % sizeof addrs);
+        return HAL_BUSY;
+    }
+    bus_busy = true;
+    bus_addr = a;
+    bus_dst = data;
+    bus_done_at = uwTick + 1;
+    reads++;
+    return HAL_OK;
+}
+
+static void bus_service(void)
+{
+    if (!bus_busy || uwTick < bus_done_at) return;
+    bus_busy = false;
+    last_end = uwTick;
+    expect_idx = (uint8_t)((expect_idx + 1u) % sizeof addrs);
+    if (bus_addr == NACK_ADDR) {
+        HAL_I2C_ErrorCallback(&hi2c1);
+        return;
+    }
+    uint16_t reg = (uint16_t)((uint16_t)sensor_raw((uint8_t)bus_addr, round_no) << 4);
+    bus_dst[0] = (uint8_t)(reg >> 8);
+    bus_dst[1] = (uint8_t)reg;
+    HAL_I2C_MemRxCpltCallback(&hi2c1);
+}
+
+static void check_snapshot(uint32_t round)
+{
+    TempSnapshot_t s;
+    CHECK(temp_acq_latest(&s));
+    CHECK_EQ(s.count, sizeof addrs);
+    for (uint8_t i = 0; i < s.count; ++i) {
+        CHECK_EQ(s.addr[i], addrs[i]);
+        if (addrs[i] == NACK_ADDR) {
+            CHECK(!(s.valid & (1u << i)));
+        } else {
+            CHECK(s.valid & (1u << i));
+            CHECK_EQ(s.raw[i], sensor_raw(addrs[i], round));
+        }
+    }
+}
+
+static void bench(void)
+{
+    char json[128];
+    enum { N = 1000000 };
+    size_t n = 0;
+    uint64_t t0 = host_ns();
+    for (int i = 0; i < N; ++i) n = measure_temperatures_cached(json, sizeof json);
+    printf("measure_temperatures_cached: %.1f ns per document (%.*s)\n", (double)(host_ns() - t0) / N,
+           (int)(n - 2), json);
+    printf("main loop blocked per round: 0 ms, was %u x (read + HAL_Delay(10)) = %u ms and more\n",
+           (unsigned)sizeof addrs, (unsigned)(sizeof addrs * 10u));
+}
+
+int main(int argc, char **argv)
+{
+    char json[128];
+    uwTick = 1000;
+    temp_acq_init(&hi2c1, addrs, sizeof addrs);
+    CHECK_EQ(measure_temperatures_cached(json, sizeof json), 0);   /* nothing published */
+    CHECK_EQ(json[0], '\0');
+
+    uint32_t rounds_seen = 0, published = 0;
+    for (; uwTick < 1000 + 20 * TEMP_ACQ_PERIOD_MS; ++uwTick) {
+        if (uwTick == 3000) refuse_next = 1;                   /* bus busy once */
+        bus_service();
+        if (tacq.seq != published) {
+            published = tacq.seq;
+            /* the refused read counts as failed: not checked in that round */
+            if (uwTick < 3000 || uwTick > 3000 + TEMP_ACQ_PERIOD_MS) check_snapshot(round_no);
+            round_no++;
+            rounds_seen++;
+            TempSnapshot_t s;
+            temp_acq_latest(&s);
+            CHECK_EQ(s.tick, uwTick);
+        }
+        temp_acq_poll();
+    }
+    CHECK_EQ(delays, 0);
+    CHECK(rounds_seen >= 19);
+
+    /* Cached JSON from a known round */
+    round_no = 0;
+    tacq.snap[tacq.seq & 1u].raw[0] = 392;   /* 24.5 */
+    tacq.snap[tacq.seq & 1u].raw[1] = -9;    /* -0.5625 -> -0.6 */
+    tacq.snap[tacq.seq & 1u].raw[3] = 0;
+    tacq.snap[tacq.seq & 1u].raw[4] = 1601;  /* 100.0625 -> 100.1 */
+    const char *want = "{\"temp_system\":24.5,\"temp_drivers\":-0.6,\"temp_motor_x\":0.0,"
+                       "\"temp_motor_y\":100.1}\r\n";
+    CHECK_EQ(measure_temperatures_cached(json, sizeof json), strlen(want));
+    CHECK(strcmp(json, want) == 0);
+    CHECK_EQ(measure_temperatures_cached(json, strlen(want) + 1), strlen(want));
+    CHECK_EQ(measure_temperatures_cached(json, strlen(want)), 0);   /* one short: nothing, not cut */
+    CHECK_EQ(json[0], '\0');
+    CHECK_EQ(measure_temperatures_cached(json, 1), 0);
+
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_19_temp_acquisition");
+}
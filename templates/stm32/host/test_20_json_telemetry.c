@@ -0,0 +1,183 @@
+/* Host test for 20_json_telemetry.c: number formatting against snprintf, the
+ * 1/16 degC rounding for every raw value, sticky overflow at every buffer
+ * size, unknown sensor keys and measure_temperatures_send(). --bench compares
+ * the encoder with the former float + snprintf + copy path.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+typedef struct {
+    uint32_t tick;
+    uint8_t  count;
+    uint8_t  valid;
+    uint8_t  addr[8];
+    int16_t  raw[8];
+} TempSnapshot_t;
+
+static TempSnapshot_t snap;
+static bool           snap_ok;
+bool temp_acq_latest(TempSnapshot_t *out)
+{
+    *out = snap;
+    return snap_ok;
+}
+
+typedef enum { TLM_FMT_JSON, TLM_FMT_BINARY } TlmFormat_t;
+static TlmFormat_t fmt = TLM_FMT_JSON;
+TlmFormat_t tlm_format(void) { return fmt; }
+size_t tlm_frame_temperatures(uint8_t *out, size_t cap, const TempSnapshot_t *s)
+{
+    (void)s;
+    memset(out, 0xA5, 5);
+    return cap >= 5 ? 5 : 0;
+}
+
+static char   sent[512];
+static size_t sent_len;
+static bool   log_accepts = true;
+bool uart_log_write(const void *data, uint32_t n)
+{
+    if (!log_accepts) return false;
+    memcpy(sent, data, n);
+    sent_len = n;
+    return true;
+}
+
+#include "../20_json_telemetry.c"
+
+static void check_u32(uint32_t v)
+{
+    char buf[16], want[16];
+    JsonWriter_t w;
+    jw_init(&w, buf, sizeof buf);
+    jw_u32(&w, v);
+    snprintf(want, sizeof want, "%u", v);
+    CHECK(w.len == strlen(want) && memcmp(buf, want, w.len) == 0);
+}
+
+static void check_fixed(int32_t v, uint8_t d)
+{
+    static const long long p10[] = { 1, 10, 100, 1000, 10000, 100000 };
+    if (d >= sizeof p10 / sizeof p10[0]) return;    /* also bounds the %0*lld width */
+    char buf[24], want[24];
+    JsonWriter_t w;
+    jw_init(&w, buf, sizeof buf);
+    jw_fixed(&w, v, d);
+    long long mag = v < 0 ? -(long long)v : v;
+    if (d) snprintf(want, sizeof want, "%s%lld.%0*lld", v < 0 ? "-" : "", mag / p10[d], d, mag % p10[d]);
+    else snprintf(want, sizeof want, "%d", v);
+    CHECK(w.len == strlen(want) && memcmp(buf, want, w.len) == 0);
+}
+
+/* Former measure_temperatures() body on a snapshot: float + snprintf + copy */
+static size_t encode_snprintf(const TempSnapshot_t *s, char *json_out, size_t out_size)
+{
+    char json_output[256];
+    int offset = snprintf(json_output, sizeof json_output, "{");
+    for (uint8_t j = 0; j < s->count; ++j) {
+        if (!(s->valid & (1u << j))) continue;
+        static char id_str[4];
+        const char *key;
+        switch (s->addr[j]) {
+            case 73: key = "temp_system"; break;
+            case 72: key = "temp_drivers"; break;
+            case 75: key = "temp_motor_x"; break;
+            case 79: key = "temp_motor_y"; break;
+            default: snprintf(id_str, sizeof id_str, "%u", s->addr[j]); key = id_str; break;
+        }
+        char val_str[16];
+        snprintf(val_str, sizeof val_str, "%3.1f", s->raw[j] / 16.0f);   /* print_number_or_float(3, 1) */
+        offset += snprintf(json_output + offset, sizeof json_output - offset, "\"%s\":%s,", key, val_str);
+    }
+    if (offset > 1 && json_output[offset - 1] == ',') json_output[offset - 1] = '}';
+    else offset += snprintf(json_output + offset, sizeof json_output - offset, "}");
+    offset += snprintf(json_output + offset, sizeof json_output - offset, "\r\n");
+    size_t n = (size_t)offset < sizeof json_output ? (size_t)offset : sizeof json_output - 1;
+    if (n >= out_size) n = out_size - 1;
+    memcpy(json_out, json_output, n);
+    json_out[n] = '\0';
+    return n;
+}
+
+static void bench(void)
+{
+    enum { N = 1000000 };
+    char out[256];
+    size_t n = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        uint64_t t0 = host_ns();
+        for (int i = 0; i < N; ++i) {
+            snap.raw[i & 3] = (int16_t)(i & 0x7FF);
+            if (pass) {
+                JsonWriter_t w;
+                jw_init(&w, out, sizeof out);
+                n = tlm_encode_temperatures(&w, &snap);
+            } else {
+                n = encode_snprintf(&snap, out, sizeof out);
+            }
+            host_sink += (uint32_t)n;
+        }
+        printf("%-28s %6.1f ns per document, %zu bytes\n", pass ? "fixed-point writer" : "float + snprintf + copy",
+               (double)(host_ns() - t0) / N, n);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t u[] = { 0, 1, 9, 10, 99, 100, 4294967295u, 1000000000u, 999999999u };
+    for (size_t i = 0; i < sizeof u / sizeof u[0]; ++i) check_u32(u[i]);
+    for (int i = 0; i < 100000; ++i) check_u32(host_rand() >> (host_rand() % 32));
+
+    static const int32_t f[] = { 0, 5, -5, 55, -55, INT32_MAX, INT32_MIN, -1, 100000, -99999 };
+    for (size_t i = 0; i < sizeof f / sizeof f[0]; ++i)
+        for (uint8_t d = 0; d <= 5; ++d) check_fixed(f[i], d);
+    for (int i = 0; i < 100000; ++i) check_fixed((int32_t)host_rand(), (uint8_t)(host_rand() % 6u));
+
+    /* 1/16 degC -> tenths, half away from zero, for every raw value */
+    for (int32_t raw = -2048; raw <= 2047; ++raw) {
+        int32_t t20 = raw * 20, want = (t20 >= 0 ? t20 + 16 : t20 - 16) / 32;   /* round(raw*10/16) */
+        CHECK_EQ(tlm_raw16_to_tenths((int16_t)raw), want);
+    }
+
+    /* Document, unknown address, invalid sensor skipped */
+    snap = (TempSnapshot_t){ 0, 5, 0x1B, { 73, 72, 75, 79, 77 }, { 392, -9, 0, 1601, 16 } };
+    snap.valid = 0x1B;   /* sensor 2 (75) did not answer */
+    const char *want = "{\"temp_system\":24.5,\"temp_drivers\":-0.6,\"temp_motor_y\":100.1,\"77\":1.0}\r\n";
+    char buf[128];
+    JsonWriter_t w;
+    jw_init(&w, buf, sizeof buf);
+    CHECK_EQ(tlm_encode_temperatures(&w, &snap), strlen(want));
+    CHECK(memcmp(buf, want, strlen(want)) == 0);
+
+    /* Every size below the document overflows, sticky, nothing past cap */
+    for (size_t cap = 0; cap < strlen(want); ++cap) {
+        char *b = malloc(cap ? cap : 1);
+        jw_init(&w, b, cap);
+        CHECK_EQ(tlm_encode_temperatures(&w, &snap), 0);
+        CHECK(w.overflow);
+        CHECK(w.len <= cap);
+        free(b);
+    }
+
+    /* Sending */
+    CHECK(!measure_temperatures_send());              /* nothing published */
+    snap_ok = true;
+    CHECK(measure_temperatures_send());
+    CHECK(sent_len == strlen(want) && memcmp(sent, want, sent_len) == 0);
+    fmt = TLM_FMT_BINARY;
+    CHECK(measure_temperatures_send());
+    CHECK_EQ(sent_len, 5);
+    fmt = TLM_FMT_JSON;
+    log_accepts = false;
+    CHECK(!measure_temperatures_send());
+    CHECK_EQ(tlm_dropped, 1);                        /* not published is not a drop */
+
+    if (host_bench(argc, argv)) {
+        snap = (TempSnapshot_t){ 0, 4, 0x0F, { 73, 72, 75, 79 }, { 392, -9, 0, 1601 } };
+        bench();
+    }
+    return host_result("test_20_json_telemetry");
+}
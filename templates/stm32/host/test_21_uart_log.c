@@ -0,0 +1,119 @@
+/* Host test for 21_uart_log.c: random printf lines, binary blocks, TX
+ * completions, TX errors and flushes against a mock UART DMA. Some completions
+ * let a "higher-priority ISR" log between HAL setting gState READY and
+ * HAL_UART_TxCpltCallback. Everything accepted must reach the DMA exactly once,
+ * in order, blocks unsplit; no in-flight buffer may change and no transfer may
+ * be started while the logger's own one is still running.
+ */
+#include <stdlib.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+#include "../21_uart_log.c"
+
+static UART_HandleTypeDef huart2 = { .Instance = USART2, .gState = HAL_UART_STATE_READY };
+
+enum { STREAM_MAX = 1 << 22 };
+static uint8_t  accepted[STREAM_MAX];     /* what the logger took, in order */
+static size_t   n_accepted;
+static uint8_t  handed[STREAM_MAX];       /* what went through the DMA */
+static size_t   n_handed;
+static size_t   block_start[1 << 16], block_end[1 << 16];
+static size_t   n_blocks;
+static size_t   cut[1 << 16];             /* stream offsets where a transfer ended */
+static size_t   n_cuts;
+
+static const uint8_t *tx_ptr;
+static uint16_t       tx_n;
+static uint8_t        tx_copy[UART_LOG_BUF_SIZE];
+static unsigned       refused, nested;
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size)
+{
+    if (huart->gState != HAL_UART_STATE_READY) {
+        refused++;
+        return HAL_BUSY;
+    }
+    CHECK(size > 0 && size <= UART_LOG_BUF_SIZE);
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    tx_ptr = data;
+    tx_n = size;
+    memcpy(tx_copy, data, size);
+    return HAL_OK;
+}
+
+static void log_block(uint32_t n)
+{
+    uint8_t b[200];
+    for (uint32_t i = 0; i < n; ++i) b[i] = (uint8_t)host_rand();
+    if (uart_log_write(b, n)) {
+        block_start[n_blocks] = n_accepted;
+        memcpy(accepted + n_accepted, b, n);
+        n_accepted += n;
+        block_end[n_blocks++] = n_accepted;
+    }
+}
+
+static void log_line(void)
+{
+    uint32_t n = 1 + host_rand() % 80u;
+    for (uint32_t i = 0; i < n; ++i) {
+        int c = i + 1 == n ? '\n' : 'a' + (int)(host_rand() % 26u);
+        uint32_t d = log_dropped;
+        __io_putchar(c);
+        if (log_dropped == d) accepted[n_accepted++] = (uint8_t)c;
+    }
+}
+
+/* End of the running transfer: HAL sets READY first, then calls back */
+static void dma_end(bool error)
+{
+    if (!tx_ptr) return;
+    CHECK(memcmp(tx_ptr, tx_copy, tx_n) == 0);      /* nobody wrote into it */
+    memcpy(handed + n_handed, tx_copy, tx_n);
+    n_handed += tx_n;
+    cut[n_cuts++] = n_handed;
+    tx_ptr = NULL;
+    huart2.gState = HAL_UART_STATE_READY;
+    if (host_rand() % 4u == 0) {                      /* higher-priority ISR logs here */
+        nested++;
+        log_block(1 + host_rand() % 16u);
+    }
+    if (error) uart_log_tx_error();
+    else uart_log_tx_complete();
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    uart_log_init(&huart2);
+    CHECK(uart_log_idle());
+
+    for (int step = 0; step < 20000; ++step) {
+        uint32_t r = host_rand() % 100u;
+        if (r < 40) log_line();
+        else if (r < 65) log_block(1 + host_rand() % 199u);
+        else if (r < 90) dma_end(false);
+        else if (r < 95) dma_end(true);
+        else uart_log_flush();
+    }
+    /* Drain */
+    for (int i = 0; i < 8 && !uart_log_idle(); ++i) {
+        uart_log_flush();
+        dma_end(false);
+    }
+    CHECK(uart_log_idle());
+    CHECK(!uart_log_write(accepted, UART_LOG_BUF_SIZE + 1u));
+
+    CHECK_EQ(n_handed, n_accepted);
+    CHECK(memcmp(handed, accepted, n_accepted) == 0);
+    size_t split = 0, c = 0;
+    for (size_t b = 0; b < n_blocks; ++b) {
+        while (c < n_cuts && cut[c] <= block_start[b]) ++c;
+        if (c < n_cuts && cut[c] < block_end[b]) split++;
+    }
+    CHECK_EQ(split, 0);
+    CHECK_EQ(refused, 0);   /* sole owner: a refusal means it lost track of its transfer */
+    printf("%zu bytes, %zu blocks, %zu transfers, %u refused, %u nested logs, %u dropped\n", n_accepted,
+           n_blocks, n_cuts, refused, nested, (unsigned)log_dropped);
+    return host_result("test_21_uart_log");
+}
@@ -0,0 +1,155 @@
+/* Host test for 22_adc_dma_oversample.c. A simulated DMA writes the scan
+ * sequence into the circular buffer sample by sample and raises the half and
+ * full callbacks; every result must equal the per-channel sum >> ADC_OS_SHIFT,
+ * adc_read() must report each result once and count replaced ones. A second
+ * thread plays the ISR while the main loop reads: no read may mix two results.
+ * --bench prints samples/s through the filter and the CPU load that implies at
+ * the template's ADC rate.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+void uart_log_init(UART_HandleTypeDef *huart) { (void)huart; }
+void uart_log_tx_complete(void) { }
+void uart_log_tx_error(void) { }
+
+#define main adc22_main
+#include "../22_adc_dma_oversample.c"
+#undef main
+
+enum { HALF = ADC_OVERSAMPLE * ADC_CHANNELS, TOTAL = 2 * HALF };
+
+static uint16_t *dma_buf;
+static uint32_t  dma_len, dma_pos;
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *buf, uint32_t n)
+{
+    (void)hadc;
+    dma_buf = (uint16_t *)buf;
+    dma_len = n;
+    dma_pos = 0;
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *h) { (void)h; }   /* callbacks are raised directly */
+
+/* One conversion lands; callbacks as the DMA stream raises them */
+static void dma_sample(uint16_t v)
+{
+    dma_buf[dma_pos++] = v;
+    if (dma_pos == dma_len / 2) HAL_ADC_ConvHalfCpltCallback(&hadc1);
+    if (dma_pos == dma_len) {
+        dma_pos = 0;
+        HAL_ADC_ConvCpltCallback(&hadc1);
+    }
+}
+
+static void check_values(void)
+{
+    uint32_t acc[ADC_CHANNELS] = { 0 };
+    uint16_t v[ADC_CHANNELS];
+    uint32_t results = 0;
+    for (uint32_t i = 0; i < 64u * TOTAL; ++i) {
+        uint16_t s = (uint16_t)(host_rand() & 0xFFFu);
+        acc[i % ADC_CHANNELS] += s;
+        dma_sample(s);
+        if ((i + 1) % HALF == 0) {
+            CHECK_EQ(adc_read(v), 1);
+            for (uint32_t ch = 0; ch < ADC_CHANNELS; ++ch) CHECK_EQ(v[ch], acc[ch] >> ADC_OS_SHIFT);
+            CHECK_EQ(adc_read(v), 0);                     /* nothing new */
+            memset(acc, 0, sizeof acc);
+            results++;
+        }
+    }
+    CHECK_EQ(results, 128);
+    CHECK_EQ(adc_overrun, 0);
+
+    /* Full scale stays inside 14 bits */
+    for (uint32_t i = 0; i < HALF; ++i) dma_sample(0xFFFu);
+    CHECK_EQ(adc_read(v), 1);
+    CHECK_EQ(v[0], (0xFFFu * ADC_OVERSAMPLE) >> ADC_OS_SHIFT);
+    CHECK(v[0] < (1u << 14));
+
+    /* Three results without a read: two replaced */
+    for (uint32_t i = 0; i < 3u * HALF; ++i) dma_sample((uint16_t)i);
+    CHECK_EQ(adc_overrun, 2);
+    CHECK_EQ(adc_read(v), 1);
+    CHECK_EQ(adc_read(v), 0);
+}
+
+/* Result k: channel ch = (k + ch) & 0x3FF before the sum, so the set is
+ * recognisable and a torn read shows up as channels from different k */
+enum { STRESS_HALVES = 200000 };
+static volatile bool isr_done;
+
+static void *isr(void *arg)
+{
+    (void)arg;
+    for (uint32_t k = 0; k < STRESS_HALVES; ++k) {
+        uint16_t *half = &adc_dma[(k & 1u) * HALF];
+        for (uint32_t s = 0; s < ADC_OVERSAMPLE; ++s)
+            for (uint32_t ch = 0; ch < ADC_CHANNELS; ++ch) half[s * ADC_CHANNELS + ch] = (uint16_t)((k + ch) & 0x3FFu);
+        adc_decimate(half);
+        if (host_rand() % 4u == 0) sched_yield();
+    }
+    isr_done = true;
+    return NULL;
+}
+
+static void stress(void)
+{
+    enum { SCALE = ADC_OVERSAMPLE >> ADC_OS_SHIFT };
+    uint32_t reads = 0, torn = 0;
+    uint16_t v[ADC_CHANNELS];
+    pthread_t t;
+    adc_overrun = 0;
+    pthread_create(&t, NULL, isr, NULL);
+    while (!isr_done) {
+        if (!adc_read(v)) {
+            sched_yield();                                /* main loop: WFI */
+            continue;
+        }
+        reads++;
+        uint32_t k = v[0] / SCALE;
+        for (uint32_t ch = 1; ch < ADC_CHANNELS; ++ch)
+            if (v[ch] != ((k + ch) & 0x3FFu) * SCALE) torn++;
+    }
+    pthread_join(t, NULL);
+    CHECK_EQ(torn, 0);
+    CHECK(reads > 0);
+    printf("stress: %u results, %u read, %u replaced, %u torn\n", STRESS_HALVES, reads, (unsigned)adc_overrun, torn);
+}
+
+static void bench(void)
+{
+    enum { N = 2000000 };
+    for (uint32_t i = 0; i < TOTAL; ++i) adc_dma[i] = (uint16_t)(host_rand() & 0xFFFu);
+    uint64_t t0 = host_ns(), c0 = host_cycles();
+    for (uint32_t i = 0; i < N; ++i) {
+        adc_decimate(&adc_dma[(i & 1u) * HALF]);
+        host_sink += adc_result[i & (ADC_CHANNELS - 1u)];
+    }
+    double ns = (double)(host_ns() - t0) / N, cyc = (double)(host_cycles() - c0) / N;
+    /* F4: ADCCLK 21 MHz, 84 + 12 cycles per conversion */
+    double sps = 21e6 / 96.0, per_s = sps / HALF;
+    printf("filter: %.1f ns (%.0f TSC cycles) per half of %u samples, %.1f Msamples/s\n", ns, cyc, (unsigned)HALF,
+           HALF / ns * 1e3);
+    printf("at %.0f samples/s: %.0f callbacks/s, host CPU load %.3f %%\n", sps, per_s, ns * per_s * 1e-7);
+}
+
+int main(int argc, char **argv)
+{
+    MX_DMA_Init();
+    MX_ADC1_Init();
+    CHECK(hadc1.DMA_Handle == &hdma_adc1);
+    CHECK_EQ(hdma_adc1.Init.Mode, DMA_CIRCULAR);
+    HAL_ADC_Start_DMA(&hadc1, (uint32_t *)adc_dma, sizeof(adc_dma) / sizeof(adc_dma[0]));
+    CHECK_EQ(dma_len, TOTAL);
+
+    check_values();
+    stress();
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_22_adc_dma_oversample");
+}
@@ -0,0 +1,234 @@
+/* Host test for 23_i2c_scan_async.c with a timed I2C mock in microseconds:
+ * a probe takes I2C_PROBE_US on the bus (100 kHz), a few addresses ACK, one
+ * device holds the bus and never completes. Checks the bitmap, filtered
+ * rescans that keep the other results, one completion callback per scan and
+ * exactly one abort per stuck probe, also when the abort itself is slow or
+ * refused. Prints the scan latencies next to the blocking scan of 06 over the
+ * same bus; --bench adds the CPU time spent in the callbacks.
+ * test_23_i2c_scan_shared.c builds the same with 19_temp_acquisition.c on
+ * hi2c1 (I2C_SCAN_TEMP_ACQ 1): a temperature round, NACK included, completes
+ * through the callbacks of 23 and a scan leaves it alone.
+ */
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+void uart_log_init(UART_HandleTypeDef *huart) { (void)huart; }
+void uart_log_tx_complete(void) { }
+void uart_log_tx_error(void) { }
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef *hi2c) { (void)hi2c; }
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef *hi2c) { (void)hi2c; }
+
+#define main i2c23_main
+#include "../23_i2c_scan_async.c"
+#undef main
+#if I2C_SCAN_TEMP_ACQ
+#include "../19_temp_acquisition.c"
+#endif
+
+#ifndef TEST_NAME
+#define TEST_NAME "test_23_i2c_scan_async"
+#endif
+
+#define I2C_PROBE_US 100u     /* start + address + ack + stop at 100 kHz */
+#define STUCK_ADDR   0x50u
+
+static uint64_t now_us;
+uint32_t HAL_GetTick(void) { return (uint32_t)(now_us / 1000u); }
+
+static const uint8_t present[] = { 0x20, 72, 73, 75, 79 };
+static bool     acks[128];
+static enum { EV_NONE, EV_ACK, EV_NACK, EV_ABORT, EV_READ } ev;
+static uint64_t ev_at;
+static bool     stuck_enabled = true, refuse_abort;
+static uint32_t abort_us = 100, aborts, probes, done_calls;
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size)
+{
+    (void)hi2c; (void)data;
+    CHECK_EQ(size, 0);
+    CHECK(ev == EV_NONE);                              /* one transfer at a time */
+    uint8_t a = (uint8_t)(addr >> 1);
+    probes++;
+    if (a == STUCK_ADDR && stuck_enabled) {
+        ev = EV_NONE;                                  /* never completes */
+        return HAL_OK;
+    }
+    ev = acks[a] ? EV_ACK : EV_NACK;
+    ev_at = now_us + I2C_PROBE_US;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef *hi2c, uint16_t addr)
+{
+    (void)hi2c;
+    CHECK_EQ(addr >> 1, STUCK_ADDR);
+    aborts++;
+    if (refuse_abort) return HAL_ERROR;
+    ev = EV_ABORT;
+    ev_at = now_us + abort_us;
+    return HAL_OK;
+}
+
+#if I2C_SCAN_TEMP_ACQ
+static uint32_t mem_reads;
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t mem, uint16_t mem_size,
+                                      uint8_t *data, uint16_t size)
+{
+    (void)hi2c; (void)mem; (void)mem_size;
+    CHECK_EQ(size, 2);
+    if (ev != EV_NONE) return HAL_BUSY;
+    uint8_t a = (uint8_t)(addr >> 1);
+    mem_reads++;
+    data[0] = a;                                       /* raw = a << 4 */
+    data[1] = 0;
+    ev = acks[a] ? EV_READ : EV_NACK;
+    ev_at = now_us + 3u * I2C_PROBE_US;
+    return HAL_OK;
+}
+#endif
+
+static void bus_service(void)
+{
+    if (ev == EV_NONE || now_us < ev_at) return;
+    int e = ev;
+    ev = EV_NONE;
+    if (e == EV_ACK) HAL_I2C_MasterTxCpltCallback(&hi2c1);
+    else if (e == EV_NACK) HAL_I2C_ErrorCallback(&hi2c1);
+#if I2C_SCAN_TEMP_ACQ
+    else if (e == EV_READ) HAL_I2C_MemRxCpltCallback(&hi2c1);
+#endif
+    else HAL_I2C_AbortCpltCallback(&hi2c1);
+}
+
+static void scan_done(const uint32_t found[4])
+{
+    (void)found;
+    done_calls++;
+}
+
+/* Run until the scan finishes; the main loop polls every 100 us */
+static uint64_t run_scan(const uint32_t *filter)
+{
+    uint64_t t0 = now_us;
+    CHECK(i2c_scan_start(&hi2c1, filter, scan_done));
+    CHECK(!i2c_scan_start(&hi2c1, filter, scan_done));   /* one at a time */
+    while (scan.busy && now_us - t0 < 1000000u) {
+        now_us += 10;
+        bus_service();
+        if (now_us % 100u == 0) i2c_scan_poll();
+    }
+    CHECK(!scan.busy);
+    return now_us - t0;
+}
+
+static void check_found(void)
+{
+    for (uint32_t a = 0; a < 128; ++a) CHECK_EQ(I2C_BIT_GET(scan.found, a), acks[a]);
+}
+
+/* 06_i2c_scan.c: IsDeviceReady(addr, 1 trial, 5 ms) for 1..126 on the same bus */
+static uint64_t blocking_scan_us(void)
+{
+    uint64_t t = 0;
+    for (uint32_t a = 1; a < 127u; ++a) t += (a == STUCK_ADDR) ? 5000u : I2C_PROBE_US;
+    return t;
+}
+
+#if I2C_SCAN_TEMP_ACQ
+/* One round over 73, 0x30 (absent) and 79, then a scan: the NACK reaches the
+ * acquisition, the scan's NACKs do not */
+static void check_shared(void)
+{
+    static const uint8_t sensors[] = { 73, 0x30, 79 };
+    temp_acq_init(&hi2c1, sensors, sizeof sensors);
+    uint64_t t0 = now_us;
+    while (tacq.seq == 0 && now_us - t0 < 1000000u) {
+        now_us += 10;
+        bus_service();
+        temp_acq_poll();
+    }
+    TempSnapshot_t s;
+    CHECK(temp_acq_latest(&s));
+    CHECK_EQ(mem_reads, 3);
+    CHECK_EQ(s.valid, 0x05);
+    CHECK_EQ(s.raw[0], 73 << 4);
+    CHECK_EQ(s.raw[2], 79 << 4);
+    CHECK(!scan.busy);
+
+    uint32_t calls = done_calls;
+    stuck_enabled = false;
+    run_scan(NULL);
+    CHECK_EQ(done_calls, calls + 1u);
+    CHECK_EQ(tacq.seq, 1);
+    CHECK_EQ(tacq.state, TACQ_IDLE);
+    check_found();
+}
+#endif
+
+static void bench(void)
+{
+    enum { N = 20000 };
+    uint32_t callbacks = 0;
+    stuck_enabled = false;
+    uint64_t t0 = host_ns();
+    for (int i = 0; i < N; ++i) {
+        i2c_scan_start(&hi2c1, NULL, NULL);
+        while (scan.busy) {
+            ev = EV_NONE;
+            callbacks++;
+            if (acks[scan.addr]) HAL_I2C_MasterTxCpltCallback(&hi2c1);
+            else HAL_I2C_ErrorCallback(&hi2c1);
+        }
+    }
+    double per_cb = (double)(host_ns() - t0) / callbacks;
+    printf("callback + next probe: %.1f ns on the host; CPU per full scan %.2f us, blocking scan holds it %.1f ms\n",
+           per_cb, per_cb * 126 / 1e3, blocking_scan_us() / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    for (size_t i = 0; i < sizeof present; ++i) acks[present[i]] = true;
+    MX_I2C1_Init();
+
+    /* Full scan: the stuck device is aborted once, after the timeout; the
+     * abort takes 2.5 ms, the main loop polls 25 times meanwhile */
+    abort_us = 2500;
+    uint64_t full = run_scan(NULL);
+    CHECK_EQ(done_calls, 1);
+    CHECK_EQ(aborts, 1);
+    CHECK_EQ(probes, 126);
+    check_found();
+    CHECK_EQ(scan.last_ms, full / 1000u);
+
+    /* Filtered rescan of the TMP1075s: 75 gone, 0x20 untouched */
+    uint32_t filter[4] = { 0 };
+    const uint8_t known[] = { 73, 72, 75, 79 };
+    for (size_t i = 0; i < sizeof known; ++i) I2C_BIT_SET(filter, known[i]);
+    acks[75] = false;
+    probes = 0;
+    uint64_t filtered = run_scan(filter);
+    CHECK_EQ(probes, 4);
+    CHECK_EQ(done_calls, 2);
+    check_found();
+    CHECK(I2C_BIT_GET(scan.found, 0x20));
+
+    /* Abort refused (no transfer running): skipped in the poll, still once */
+    acks[75] = true;
+    refuse_abort = true;
+    aborts = 0;
+    uint64_t refused = run_scan(NULL);
+    CHECK_EQ(aborts, 1);
+    CHECK_EQ(done_calls, 3);
+    check_found();
+
+    printf("full scan %.1f ms (stuck device included), TMP1075 rescan %.2f ms, refused abort %.1f ms;"
+           " blocking 06 scan %.1f ms with the CPU held throughout\n",
+           full / 1e3, filtered / 1e3, refused / 1e3, blocking_scan_us() / 1e3);
+
+#if I2C_SCAN_TEMP_ACQ
+    check_shared();
+#endif
+    if (host_bench(argc, argv)) bench();
+    return host_result(TEST_NAME);
+}
@@ -0,0 +1,6 @@
+/* test_23_i2c_scan_async.c with 19_temp_acquisition.c sharing hi2c1 and the
+ * I2C callbacks of 23_i2c_scan_async.c */
+#define I2C_SCAN_TEMP_ACQ      1
+#define TEMP_ACQ_I2C_CALLBACKS 0
+#define TEST_NAME "test_23_i2c_scan_shared"
+#include "test_23_i2c_scan_async.c"
@@ -0,0 +1,276 @@
+/* Host test for 24_spi_dma_engine.c against a loopback SPI mock on a virtual
+ * clock (SPI1 at 84 MHz / 16, one byte every SPI_BYTE_NS). Checks the
+ * loopback descriptor, FIFO order and back-to-back chaining with one CS low at
+ * a time, a full queue, refused starts and bus errors, the ping-pong stream
+ * with its byte sequence intact, and that stream_blocks_since() never loses a
+ * block while a second thread plays the IRQ. Prints stream throughput in B/s;
+ * --bench compares CPU time per block with the blocking 07 path.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+void uart_log_init(UART_HandleTypeDef *huart) { (void)huart; }
+void uart_log_tx_complete(void) { }
+void uart_log_tx_error(void) { }
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *h) { (void)h; }
+
+#define main spi24_main
+#include "../24_spi_dma_engine.c"
+#undef main
+
+#define SPI_BYTE_NS 1524u     /* 8 bits at 5.25 MHz */
+
+static uint64_t now_ns;
+uint32_t HAL_GetTick(void) { return (uint32_t)(now_ns / 1000000u); }
+
+/* CS lines on GPIOA, active low; every pin starts high */
+static uint32_t cs_low_count;
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+    uint32_t was_low = !(port->ODR & pin);
+    if (state == GPIO_PIN_SET) port->ODR |= pin;
+    else port->ODR &= ~(uint32_t)pin;
+    uint32_t is_low = !(port->ODR & pin);
+    cs_low_count = cs_low_count - was_low + is_low;
+    CHECK(cs_low_count <= 1);                            /* one device at a time */
+}
+
+/* The bus: one DMA transfer, rx = tx when it ends */
+static bool     bus_active, refuse_next;
+static uint64_t bus_done_at, bus_idle_ns, bus_last_end;
+static uint8_t *bus_tx, *bus_rx;
+static uint16_t bus_len;
+static uint32_t starts;
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef *hspi, uint8_t *tx, uint8_t *rx, uint16_t n)
+{
+    (void)hspi;
+    CHECK(!bus_active);
+    CHECK_EQ(cs_low_count, spi_active && spi_active->cs_port ? 1 : 0);   /* CS already asserted */
+    if (refuse_next) {
+        refuse_next = false;
+        return HAL_BUSY;
+    }
+    starts++;
+    if (bus_last_end) bus_idle_ns += now_ns - bus_last_end;
+    bus_active = true;
+    bus_tx = tx;
+    bus_rx = rx;
+    bus_len = n;
+    bus_done_at = now_ns + (uint64_t)n * SPI_BYTE_NS;
+    return HAL_OK;
+}
+
+/* 07_spi_loopback.c: the CPU waits for every byte */
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *tx, uint8_t *rx, uint16_t n,
+                                          uint32_t timeout)
+{
+    (void)hspi; (void)timeout;
+    for (uint16_t i = 0; i < n; ++i) {
+        now_ns += SPI_BYTE_NS;
+        rx[i] = tx[i];
+        host_sink += rx[i];
+    }
+    return HAL_OK;
+}
+
+static void bus_service(void)
+{
+    if (!bus_active || now_ns < bus_done_at) return;
+    now_ns = bus_done_at;
+    memcpy(bus_rx, bus_tx, bus_len);
+    bus_active = false;
+    bus_last_end = now_ns;
+    HAL_SPI_TxRxCpltCallback(&hspi1);
+}
+
+static void run_until_idle(void)
+{
+    while (bus_active) {
+        now_ns = bus_done_at;
+        bus_service();
+    }
+}
+
+static SpiXfer_t *order[16];
+static uint32_t   n_order;
+static void record(SpiXfer_t *x) { order[n_order++] = x; }
+
+static void check_queue(void)
+{
+    static uint8_t tx[10][16], rx[10][16];
+    static SpiXfer_t x[10];
+    n_order = 0;
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 16; ++j) tx[i][j] = (uint8_t)(i * 16 + j);
+        x[i] = (SpiXfer_t){ GPIOA, (uint16_t)(1u << i), tx[i], rx[i], 16, record, SPI_XFER_IDLE };
+    }
+    /* first one starts at once, eight more fit in the queue */
+    for (int i = 0; i < 9; ++i) CHECK(spi_submit(&x[i]));
+    CHECK(!spi_submit(&x[9]));
+    CHECK_EQ(x[0].state, SPI_XFER_ACTIVE);
+    CHECK_EQ(x[1].state, SPI_XFER_QUEUED);
+
+    uint64_t t0 = now_ns;
+    bus_idle_ns = 0;
+    bus_last_end = 0;
+    run_until_idle();
+    CHECK_EQ(n_order, 9);
+    for (uint32_t i = 0; i < n_order; ++i) {
+        CHECK(order[i] == &x[i]);
+        CHECK_EQ(x[i].state, SPI_XFER_DONE);
+        CHECK(memcmp(tx[i], rx[i], 16) == 0);
+    }
+    CHECK_EQ(bus_idle_ns, 0);                              /* chained back-to-back */
+    CHECK_EQ(now_ns - t0, 9u * 16u * SPI_BYTE_NS);
+    CHECK_EQ(cs_low_count, 0);
+    CHECK_EQ(GPIOA->ODR & 0x3FFu, 0x3FFu);
+
+    /* Refused start: reported, CS back up, the next one still runs */
+    n_order = 0;
+    refuse_next = false;
+    CHECK(spi_submit(&x[0]));                              /* occupies the bus */
+    refuse_next = true;
+    CHECK(spi_submit(&x[1]));
+    CHECK(spi_submit(&x[2]));
+    run_until_idle();
+    CHECK_EQ(n_order, 3);
+    CHECK_EQ(x[1].state, SPI_XFER_ERROR);
+    CHECK_EQ(x[2].state, SPI_XFER_DONE);
+    CHECK_EQ(cs_low_count, 0);
+
+    /* Bus error mid-transfer */
+    n_order = 0;
+    CHECK(spi_submit(&x[3]));
+    CHECK(spi_submit(&x[4]));
+    bus_active = false;
+    HAL_SPI_ErrorCallback(&hspi1);
+    CHECK_EQ(x[3].state, SPI_XFER_ERROR);
+    CHECK_EQ(x[4].state, SPI_XFER_ACTIVE);
+    run_until_idle();
+    CHECK_EQ(x[4].state, SPI_XFER_DONE);
+    CHECK_EQ(cs_low_count, 0);
+}
+
+/* The template's streaming loop for 'ms' of virtual time, one pass every
+ * 2 us; the stream is a running byte counter, checked as it comes back */
+static uint8_t  stream_seq, stream_expect;
+static uint32_t stream_bad;
+
+static void check_block(SpiXfer_t *x)
+{
+    for (uint16_t i = 0; i < x->len; ++i)
+        if (x->rx[i] != stream_expect++) stream_bad++;
+    on_block(x);
+}
+
+static uint32_t stream(uint32_t ms)
+{
+    uint32_t reported = 0, prev = stream_blocks, last = HAL_GetTick();
+    uint64_t end = now_ns + (uint64_t)ms * 1000000u;
+    while (now_ns < end) {
+        bus_service();
+        uint8_t *buf = spi_pp_acquire();
+        if (buf) {
+            for (uint32_t i = 0; i < SPI_PP_SIZE; ++i) buf[i] = stream_seq++;
+            CHECK(spi_pp_submit(SPI_PP_SIZE, GPIOA, GPIO_PIN_4, check_block));
+        }
+        if (HAL_GetTick() - last >= 1000u) {
+            last = HAL_GetTick();
+            reported += stream_blocks_since(&prev);
+        }
+        now_ns += 2000;
+    }
+    run_until_idle();
+    return reported + stream_blocks_since(&prev);
+}
+
+/* IRQ thread bumps the counter while the main loop takes deltas */
+static volatile bool irq_done;
+static void *irq(void *arg)
+{
+    SpiXfer_t x = { .state = SPI_XFER_DONE };
+    for (uint32_t i = 0; i < (uint32_t)(uintptr_t)arg; ++i) {
+        on_block(&x);
+        if ((i & 63u) == 0) sched_yield();
+    }
+    irq_done = true;
+    return NULL;
+}
+
+static void check_counter_race(void)
+{
+    enum { N = 200000 };
+    uint32_t base = stream_blocks, prev = base, sum = 0;
+    pthread_t t;
+    pthread_create(&t, NULL, irq, (void *)(uintptr_t)N);
+    while (!irq_done) {
+        sum += stream_blocks_since(&prev);
+        sched_yield();
+    }
+    pthread_join(t, NULL);
+    sum += stream_blocks_since(&prev);
+    CHECK_EQ(sum, N);
+    CHECK_EQ(stream_blocks - base, N);
+}
+
+static void bench(void)
+{
+    enum { N = 200000 };
+    /* DMA path: acquire + submit + completion chain, fill excluded */
+    stream_blocks = 0;
+    uint64_t t0 = host_ns();
+    for (int i = 0; i < N; ++i) {
+        if (spi_pp_acquire()) spi_pp_submit(SPI_PP_SIZE, GPIOA, GPIO_PIN_4, on_block);
+        bus_active = false;
+        HAL_SPI_TxRxCpltCallback(&hspi1);
+    }
+    double dma_ns = (double)(host_ns() - t0) / N;
+    double block_ns = (double)SPI_PP_SIZE * SPI_BYTE_NS;
+    printf("CPU per %u-byte block: DMA engine %.0f ns on the host (%.3f %% of the %.1f us on the bus);"
+           " blocking 07 path holds the CPU for all %.1f us (100 %%)\n",
+           SPI_PP_SIZE, dma_ns, 100.0 * dma_ns / block_ns, block_ns / 1e3, block_ns / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    GPIOA->ODR = 0xFFFFu;                              /* pull-ups: every CS idle high */
+    MX_GPIO_Init();
+    MX_DMA_Init();
+    MX_SPI1_Init();
+    CHECK(hspi1.hdmarx == &hdma_spi1_rx && hspi1.hdmatx == &hdma_spi1_tx);
+    MX_USART2_UART_Init();                               /* log TX DMA, separate controller */
+    CHECK(huart2.hdmatx == &hdma_usart2_tx && hdma_usart2_tx.Parent == &huart2);
+    CHECK(hdma_usart2_tx.Instance == DMA1_Stream6 && hdma_usart2_tx.Init.Direction == DMA_MEMORY_TO_PERIPH);
+
+    /* The loopback descriptor of main() */
+    static uint8_t tx[8] = { 1, 2, 3, 4, 5, 6, 7, 8 }, rx[8];
+    static SpiXfer_t loop = { GPIOA, GPIO_PIN_4, tx, rx, sizeof(tx), NULL, SPI_XFER_IDLE };
+    CHECK(spi_submit(&loop));
+    CHECK(spi_xfer_busy(&loop));
+    run_until_idle();
+    CHECK_EQ(loop.state, SPI_XFER_DONE);
+    CHECK(memcmp(tx, rx, sizeof tx) == 0);
+    CHECK_EQ(cs_low_count, 0);
+
+    check_queue();
+
+    bus_idle_ns = 0;
+    bus_last_end = 0;
+    uint64_t t0 = now_ns;
+    uint32_t blocks = stream(2000);
+    double secs = (double)(now_ns - t0) / 1e9;
+    CHECK_EQ(stream_bad, 0);
+    CHECK_EQ(stream_errors, 0);
+    CHECK_EQ(blocks, stream_blocks);
+    double bps = blocks * SPI_PP_SIZE / secs, line = 1e9 / SPI_BYTE_NS;
+    CHECK(bps > 0.95 * line);
+    printf("stream: %u blocks, %.0f B/s of %.0f B/s line rate, bus idle %.1f us between blocks in total\n", blocks,
+           bps, line, bus_idle_ns / 1e3);
+
+    check_counter_race();
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_24_spi_dma_engine");
+}
@@ -0,0 +1,187 @@
+/* Host test for 25_dma_copy_service.c with a mock DMA: each stream holds one
+ * started chunk until the test delivers its completion, in random stream
+ * order, as the DMA IRQ would. Checks every size/alignment combination against
+ * memcpy with guard bytes around the destination, chunking (at most
+ * COPY_CHUNK_WORDS, disjoint, word aligned), one done() per copy, refused
+ * starts finishing on the CPU and a stream error reported as failed.
+ *
+ * --bench prints the host-simulated matrix: CPU copy cycles against the CPU
+ * cycles the DMA path costs (copy_async plus the completion IRQs; the mock
+ * moves no data), and the threshold that would choose. On-target numbers come
+ * from copy_bench() on hardware and were not measured here.
+ */
+#include <stdlib.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+void uart_log_init(UART_HandleTypeDef *huart) { (void)huart; }
+void uart_log_tx_complete(void) { }
+void uart_log_tx_error(void) { }
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *h) { (void)h; }
+
+#define main copy25_main
+#include "../25_dma_copy_service.c"
+#undef main
+
+static struct {
+    bool     busy;
+    uint32_t src, dst, n;
+} dma[COPY_DMA_CHANNELS];
+static bool     dma_moves_data = true;
+static uint32_t refuse_starts, starts;
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *h, uint32_t src, uint32_t dst, uint32_t n)
+{
+    uint32_t i = (uint32_t)(h - hdma_m2m);
+    CHECK(i < COPY_DMA_CHANNELS);
+    CHECK(!dma[i].busy);
+    if (refuse_starts) {
+        refuse_starts--;
+        return HAL_BUSY;
+    }
+    CHECK(n > 0 && n <= COPY_CHUNK_WORDS);
+    CHECK(((src | dst) & 3u) == 0);
+    dma[i].busy = true;
+    dma[i].src = src;
+    dma[i].dst = dst;
+    dma[i].n = n;
+    starts++;
+    return HAL_OK;
+}
+
+/* Host addresses are 64-bit: rebuild the pointer from the low 32 bits */
+static uint8_t *host_ptr(uint32_t lo, const void *near)
+{
+    return (uint8_t *)((((uintptr_t)near) & ~(uintptr_t)0xFFFFFFFFu) | lo);
+}
+
+static bool deliver(bool error)
+{
+    uint32_t pick = host_rand() % COPY_DMA_CHANNELS;
+    for (uint32_t k = 0; k < COPY_DMA_CHANNELS; ++k) {
+        uint32_t i = (pick + k) % COPY_DMA_CHANNELS;
+        if (!dma[i].busy) continue;
+        dma[i].busy = false;
+        if (dma_moves_data && !error)
+            memcpy(host_ptr(dma[i].dst, cp.dst), host_ptr(dma[i].src, cp.src), dma[i].n * 4u);
+        if (error) hdma_m2m[i].XferErrorCallback(&hdma_m2m[i]);
+        else hdma_m2m[i].XferCpltCallback(&hdma_m2m[i]);
+        return true;
+    }
+    return false;
+}
+
+static uint32_t done_calls, done_ok;
+static void on_done(bool ok)
+{
+    done_calls++;
+    done_ok += ok;
+}
+
+static uint8_t src_buf[3 * COPY_CHUNK_WORDS * 4 + 64], dst_buf[sizeof src_buf + 64];
+
+static void check_copy(size_t len, uint32_t sa, uint32_t da)
+{
+    memset(dst_buf, 0xEE, sizeof dst_buf);
+    for (size_t i = 0; i < len; ++i) src_buf[sa + i] = (uint8_t)host_rand();
+    uint8_t *d = dst_buf + 32 + da;
+    done_calls = done_ok = 0;
+    CHECK(copy_async(d, src_buf + sa, len, on_done));
+    if (copy_busy()) CHECK(!copy_async(d, src_buf + sa, len, on_done));
+    while (deliver(false)) { }
+    CHECK(!copy_busy());
+    CHECK_EQ(done_calls, 1);
+    CHECK_EQ(done_ok, 1);
+    CHECK(memcmp(d, src_buf + sa, len) == 0);
+    for (size_t i = 0; i < 32 + da; ++i) CHECK_EQ(dst_buf[i], 0xEE);
+    for (size_t i = 32 + da + len; i < sizeof dst_buf; ++i) CHECK_EQ(dst_buf[i], 0xEE);
+}
+
+static void check_cases(void)
+{
+    static const size_t sizes[] = { 0, 1, 3, 7, 8, 9, 255, 256, 257, 1000, 4096, 4099, 8192 + 5,
+                                    3 * COPY_CHUNK_WORDS * 4 };
+    for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; ++i)
+        for (uint32_t sa = 0; sa < 4; ++sa)
+            for (uint32_t da = 0; da < 4; ++da) check_copy(sizes[i], sa, da);
+
+    /* 3 chunks over 2 streams: both start at once, the third after one ends */
+    starts = 0;
+    check_copy(3 * COPY_CHUNK_WORDS * 4, 0, 0);
+    CHECK_EQ(starts, 3);
+
+    /* No stream starts: the CPU does the words before returning */
+    refuse_starts = COPY_DMA_CHANNELS;
+    done_calls = 0;
+    CHECK(copy_async(dst_buf, src_buf, 4096, on_done));
+    CHECK(!copy_busy());
+    CHECK_EQ(done_calls, 1);
+    CHECK(memcmp(dst_buf, src_buf, 4096) == 0);
+
+    /* A stream error: reported once, after the other stream has ended */
+    done_calls = done_ok = 0;
+    CHECK(copy_async(dst_buf, src_buf, 3 * COPY_CHUNK_WORDS * 4, on_done));
+    CHECK(deliver(true));
+    CHECK_EQ(done_calls, 0);
+    while (deliver(false)) { }
+    CHECK(!copy_busy());
+    CHECK_EQ(done_calls, 1);
+    CHECK_EQ(done_ok, 0);
+}
+
+static uint64_t best_of(uint64_t (*f)(size_t, uint32_t, uint32_t), size_t n, uint32_t sa, uint32_t da)
+{
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < 200; ++r) {
+        uint64_t c = f(n, sa, da);
+        if (c < best) best = c;
+    }
+    return best;
+}
+
+static uint64_t host_cpu(size_t n, uint32_t sa, uint32_t da)
+{
+    uint64_t t0 = host_cycles();
+    copy_cpu(dst_buf + da, src_buf + sa, n);
+    return host_cycles() - t0;
+}
+
+static uint64_t host_dma(size_t n, uint32_t sa, uint32_t da)
+{
+    uint32_t saved = copy_dma_threshold;
+    copy_dma_threshold = 0;
+    uint64_t t0 = host_cycles();
+    copy_async(dst_buf + da, src_buf + sa, n, NULL);
+    while (deliver(false)) { }
+    uint64_t t = host_cycles() - t0;
+    copy_dma_threshold = saved;
+    return t;
+}
+
+static void bench(void)
+{
+    static const size_t sizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    size_t threshold = 0;
+    dma_moves_data = false;
+    printf("size  cpu(a0) cpu(a1) cpu(a0/1)  dma-cpu(a0)   [host TSC cycles]\n");
+    for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; ++i) {
+        size_t n = sizes[i];
+        uint64_t c0 = best_of(host_cpu, n, 0, 0), c1 = best_of(host_cpu, n, 1, 1);
+        uint64_t cx = best_of(host_cpu, n, 0, 1), dm = best_of(host_dma, n, 0, 0);
+        printf("%4zu %8llu %7llu %9llu %12llu\n", n, (unsigned long long)c0, (unsigned long long)c1,
+               (unsigned long long)cx, (unsigned long long)dm);
+        if (!threshold && dm < c0) threshold = n;
+    }
+    if (threshold) printf("host-simulated threshold: %zu bytes\n", threshold);
+    else printf("host-simulated threshold: none (the host CPU copy is always cheaper)\n");
+    dma_moves_data = true;
+}
+
+int main(int argc, char **argv)
+{
+    MX_DMA_Init();
+    CHECK(hdma_m2m[0].XferCpltCallback == copy_dma_cplt);
+    check_cases();
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_25_dma_copy_service");
+}
@@ -0,0 +1,150 @@
+/* Host test for 26_timing.c with an injectable clock: TIMING_READ_RAW() reads
+ * a 64-bit tick count masked to the counter width, and each read can cost
+ * ticks like a real polling loop. Checks now_us() against the exact count over
+ * random steps up to TIMING_MAX_STEP (many counter wraps and a microsecond
+ * wrap), deadlines and remaining time across the microsecond wrap, spans of 0
+ * and 2^32-1, and busy_wait_us() for waits shorter than, equal to (start ==
+ * end, the delay_us() case) and several times one counter period.
+ *
+ * Built for the DWT at 168 MHz; test_26_timing_tim.c builds it again for the
+ * 16-bit TIM fallback at 1 MHz.
+ */
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+static uint64_t raw_total;        /* ticks since the test started, never wraps */
+static uint32_t raw_base;         /* counter value at raw_total == 0 */
+static uint32_t raw_per_read;     /* ticks that pass per counter read */
+
+static uint32_t host_raw(void)
+{
+    uint32_t r = (uint32_t)(raw_base + raw_total);
+    raw_total += raw_per_read;
+    return r;
+}
+
+#define TIMING_READ_RAW() (host_raw() & TIMING_RAW_MASK)
+#ifndef TIMING_TICKS_PER_US
+#define TIMING_TICKS_PER_US 168u
+#endif
+#if defined(TIMING_SOURCE) && TIMING_SOURCE == 1
+TIM_HandleTypeDef htim9 = { .Instance = TIM9 };
+#define TEST_NAME "test_26_timing_tim"
+#else
+#define TEST_NAME "test_26_timing"
+#endif
+
+#include "../26_timing.c"
+
+/* Restart the microsecond clock at 'us' on the current counter value */
+static uint64_t sync_at(uint32_t us)
+{
+    uint32_t saved = raw_per_read;
+    raw_per_read = 0;
+    tm_last_raw = TIMING_READ_RAW();
+    tm_us = us;
+    tm_frac = 0;
+    raw_per_read = saved;
+    return raw_total;
+}
+
+static void advance_us(uint64_t us)
+{
+    uint64_t ticks = us * TIMING_TICKS_PER_US;
+    while (ticks) {                                   /* SysTick keeps folding */
+        uint64_t step = ticks > TIMING_MAX_STEP ? TIMING_MAX_STEP : ticks;
+        raw_total += step;
+        ticks -= step;
+        (void)now_us();
+    }
+}
+
+static void check_now_us(void)
+{
+    uint32_t u0 = 0xFFFF0000u;                        /* crosses the us wrap too */
+    uint64_t ref = sync_at(u0);
+    uint32_t last = u0;
+    for (int i = 0; i < 200000; ++i) {
+        uint64_t step = ((uint64_t)host_rand() * host_rand()) % ((uint64_t)TIMING_MAX_STEP + 1u);
+        if (i % 1000 == 0) step = TIMING_MAX_STEP;
+        raw_total += step;
+        uint32_t got = now_us();
+        CHECK_EQ(got, (uint32_t)(u0 + (raw_total - ref) / TIMING_TICKS_PER_US));
+        CHECK(got - last <= TIMING_MAX_STEP / TIMING_TICKS_PER_US + 1u);   /* never backwards */
+        last = got;
+    }
+}
+
+static void check_timeouts(void)
+{
+    Timeout_t t;
+    sync_at(0xFFFFFF00u);
+    timeout_start(&t, 1000);
+    advance_us(999);
+    CHECK(!timeout_expired(&t));
+    CHECK_EQ(timeout_remaining(&t), 1);
+    advance_us(1);
+    CHECK(timeout_expired(&t));
+    CHECK_EQ(timeout_remaining(&t), 0);
+    advance_us(5000);
+    CHECK(timeout_expired(&t));
+
+    timeout_start(&t, 0);
+    CHECK(timeout_expired(&t));
+
+    sync_at(0x80000000u);
+    timeout_start(&t, 0xFFFFFFFFu);
+    advance_us(0x80000000u);
+    CHECK(!timeout_expired(&t));
+    advance_us(0x7FFFFFFEu);
+    CHECK(!timeout_expired(&t));
+    CHECK_EQ(timeout_remaining(&t), 1);
+    advance_us(1);
+    CHECK(timeout_expired(&t));
+}
+
+static void check_busy_wait(void)
+{
+    const uint64_t period_us = ((uint64_t)TIMING_RAW_MASK + 1u) / TIMING_TICKS_PER_US;
+    const uint32_t waits[] = { 0, 1, 2, 5, 10, 100, 1000, (uint32_t)(period_us / 2u), (uint32_t)period_us,
+                               (uint32_t)(period_us * 3u), (uint32_t)(period_us * 3u + 7u) };
+    raw_per_read = 7;                                 /* one loop pass */
+    timing_calibrate();
+    CHECK(tm_wait_overhead > 0);
+    uint64_t slack = tm_wait_overhead + 2u * raw_per_read;
+    for (size_t i = 0; i < sizeof waits / sizeof waits[0]; ++i) {
+        for (int phase = 0; phase < 8; ++phase) {
+            raw_base = host_rand();                   /* any start, incl. end == start */
+            if (phase == 0) raw_base = (uint32_t)(TIMING_RAW_MASK - 3u - raw_total);
+            if ((uint64_t)waits[i] * TIMING_TICKS_PER_US > UINT32_MAX && TIMING_RAW_MASK == 0xFFFFFFFFu) continue;
+            uint64_t want = (uint64_t)waits[i] * TIMING_TICKS_PER_US;
+            uint64_t t0 = raw_total;
+            busy_wait_us(waits[i]);
+            uint64_t got = raw_total - t0;
+            CHECK(got + slack >= want);
+            CHECK(got <= want + slack);
+        }
+    }
+    raw_per_read = 0;
+}
+
+static void bench(void)
+{
+    enum { N = 10000000 };
+    raw_per_read = 3;
+    uint64_t t0 = host_ns();
+    for (int i = 0; i < N; ++i) host_sink += now_us();
+    printf("now_us(): %.1f ns per call on the host\n", (double)(host_ns() - t0) / N);
+    raw_per_read = 0;
+}
+
+int main(int argc, char **argv)
+{
+    raw_base = (uint32_t)(TIMING_RAW_MASK - 1000u);   /* first wrap right away */
+    timing_init();
+    check_now_us();
+    check_timeouts();
+    check_busy_wait();
+    if (host_bench(argc, argv)) bench();
+    return host_result(TEST_NAME);
+}
@@ -0,0 +1,4 @@
+/* test_26_timing.c for the TIM fallback: 16-bit counter at 1 MHz */
+#define TIMING_SOURCE       1   /* TIMING_TIM */
+#define TIMING_TICKS_PER_US 1u
+#include "test_26_timing.c"
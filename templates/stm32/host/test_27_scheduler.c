@@ -0,0 +1,249 @@
+/* Host test for 27_scheduler.c on a virtual 168 MHz clock: SCHED_CYCLES()
+ * reads it (each read costs SCHED_READ_CYC), tasks spend a set number of
+ * cycles, __WFI() sleeps to the next millisecond tick and may raise a pending
+ * "interrupt" that posts events. Checks run counts for periods below, at and
+ * above the wheel size across the tick wrap, catch-up latencies, overrun skips
+ * and deadline misses, event dispatch and the WFI race (never sleeps with an
+ * event pending), and that idle + task + overhead accounts for every cycle.
+ * Prints idle % and scheduler cycles per dispatch for the demo task set of
+ * main(); --bench adds host ns per dispatch.
+ */
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+#define CYC_PER_MS     168000u
+#define SCHED_READ_CYC 4u
+
+static uint64_t vcyc, next_tick_at = CYC_PER_MS;
+
+static void advance(uint64_t cyc)
+{
+    vcyc += cyc;
+    while (vcyc >= next_tick_at) {
+        uwTick++;
+        next_tick_at += CYC_PER_MS;
+    }
+}
+
+static uint32_t sched_cycles(void)
+{
+    advance(SCHED_READ_CYC);
+    return (uint32_t)vcyc;
+}
+#define SCHED_CYCLES() sched_cycles()
+
+void uart_log_init(UART_HandleTypeDef *huart) { (void)huart; }
+void uart_log_tx_complete(void) { }
+void uart_log_tx_error(void) { }
+
+#define main sched27_main
+#include "../27_scheduler.c"
+#undef main
+
+/* Interrupt raised during the next WFI */
+static uint32_t wfi_post, wfi_count, wfi_with_event;
+void __WFI(void)
+{
+    CHECK_EQ(host_primask, 1);
+    wfi_count++;
+    if (sched_events) wfi_with_event++;
+    advance(next_tick_at - vcyc);
+    if (wfi_post) {
+        sched_events |= wfi_post;                       /* the ISR, on wakeup */
+        wfi_post = 0;
+    }
+}
+
+static uint32_t rtc_reads, toggles;
+HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *h, RTC_TimeTypeDef *t, uint32_t f)
+{
+    (void)h; (void)f;
+    rtc_reads++;
+    *t = (RTC_TimeTypeDef){ .Hours = 12, .Minutes = 0, .Seconds = (uint8_t)(rtc_reads % 60u) };
+    return HAL_OK;
+}
+HAL_StatusTypeDef HAL_RTC_GetDate(RTC_HandleTypeDef *h, RTC_DateTypeDef *d, uint32_t f)
+{
+    (void)h; (void)f;
+    *d = (RTC_DateTypeDef){ 1, 1, 1, 25 };
+    return HAL_OK;
+}
+void HAL_GPIO_TogglePin(GPIO_TypeDef *port, uint16_t pin) { port->ODR ^= pin; toggles++; }
+void HAL_GPIO_EXTI_IRQHandler(uint16_t pin) { HAL_GPIO_EXTI_Callback(pin); }
+
+static void reset(uint32_t tick)
+{
+    memset(sched_wheel, 0, sizeof sched_wheel);
+    memset(&sched_stats, 0, sizeof sched_stats);
+    sched_tasks = NULL;
+    sched_events = 0;
+    uwTick = tick;
+    next_tick_at = vcyc - vcyc % CYC_PER_MS + CYC_PER_MS;
+    sched_tick = HAL_GetTick();
+}
+
+/* Until 'ms' more ticks have been processed */
+static uint32_t passes;
+static void run_ms(uint32_t ms)
+{
+    uint32_t end = sched_tick + ms;
+    while ((int32_t)(sched_tick - end) < 0) {
+        sched_run_once();
+        passes++;
+    }
+}
+
+static uint32_t task_cost, task_ms;               /* per run: cycles, then whole ms */
+static uint32_t last_ev;
+static void work(uint32_t ev)
+{
+    last_ev = ev;
+    advance(task_cost);
+    for (uint32_t i = 0; i < task_ms; ++i) advance(CYC_PER_MS);
+}
+
+static void check_periods(void)
+{
+    static const uint32_t periods[] = { 1, 7, 31, 32, 33, 50, 64, 1000 };
+    static Task_t t[8];
+    reset(0xFFFFF000u);                                  /* the tick wraps halfway */
+    task_cost = 500;
+    for (int i = 0; i < 8; ++i) {
+        t[i] = (Task_t){ .fn = work, .period = periods[i], .deadline = 1 };
+        sched_add(&t[i], 0);
+    }
+    run_ms(8000);
+    for (int i = 0; i < 8; ++i) {
+        CHECK_EQ(t[i].runs, 7999u / periods[i] + 1u);   /* first run one tick in */
+        CHECK_EQ(t[i].misses, 0);
+        CHECK(t[i].max_latency <= 1);
+    }
+    CHECK_EQ(wfi_with_event, 0);
+}
+
+static void check_catch_up_and_overrun(void)
+{
+    static Task_t fast, slow;
+    reset(100);
+    task_cost = 0;
+    fast = (Task_t){ .fn = work, .period = 1, .deadline = 5 };
+    sched_add(&fast, 0);
+    uwTick += 10;                                        /* ten ticks behind */
+    sched_run_once();
+    CHECK_EQ(fast.runs, 1);                              /* late once, missed periods skipped */
+    CHECK_EQ(fast.max_latency, 9);
+    CHECK_EQ(fast.misses, 1);
+    CHECK_EQ(fast.due, 111);
+
+    /* 120 ms runs every 50 ms: each run skips the periods it overran and
+     * the next one starts late, a deadline miss */
+    reset(0);
+    slow = (Task_t){ .fn = work, .period = 50, .deadline = 10 };
+    sched_add(&slow, 0);
+    task_ms = 120;
+    run_ms(1000);
+    task_ms = 0;
+    CHECK(slow.runs >= 1000u / 120u && slow.runs <= 1000u / 120u + 2u);   /* back to back, no pile-up */
+    CHECK_EQ(slow.misses, slow.runs - 1u);
+    CHECK(slow.max_latency >= 120u - 50u);
+}
+
+static void check_events(void)
+{
+    static Task_t a, b, idle_tick;
+    reset(0);
+    task_cost = 100;
+    a = (Task_t){ .fn = work, .events = 1u };
+    b = (Task_t){ .fn = work, .events = 6u };
+    idle_tick = (Task_t){ .fn = work, .period = 10 };
+    sched_add(&a, 0);
+    sched_add(&b, 0);
+    sched_add(&idle_tick, 0);
+
+    sched_post(4u);
+    CHECK(sched_run_once());
+    CHECK_EQ(b.runs, 1);
+    CHECK_EQ(a.runs, 0);
+    CHECK_EQ(last_ev, 4u);
+
+    /* Posted by an ISR while asleep: dispatched on the next pass */
+    wfi_post = 3u;
+    uint32_t w = wfi_count;
+    while (wfi_count == w) sched_run_once();
+    CHECK(sched_run_once());
+    CHECK_EQ(a.runs, 1);
+    CHECK_EQ(b.runs, 2);
+
+    /* Posted between the event check and the sleep: no WFI on it */
+    for (int i = 0; i < 1000; ++i) {
+        sched_post(1u << (host_rand() % 3u));
+        sched_run_once();
+        sched_run_once();
+    }
+    CHECK_EQ(wfi_with_event, 0);
+    CHECK_EQ(sched_events, 0);
+}
+
+/* Demo tasks of main(): every cycle lands in idle, task or overhead */
+static void check_demo(void)
+{
+    reset(0);
+    MX_GPIO_Init();
+    MX_TIM3_Init();
+    MX_RTC_Init();
+    sched_add(&t_pwm, 0);
+    sched_add(&t_rtc, 0);
+    sched_add(&t_button, 0);
+    uint64_t c0 = vcyc;
+    passes = 0;
+    for (int ms = 0; ms < 3000; ++ms) {
+        if (ms % 700 == 0) EXTI0_IRQHandler();
+        run_ms(1);
+    }
+    CHECK_EQ(t_pwm.runs, 60);
+    CHECK_EQ(htim3.Instance->CCR1, (59u * 50u) % 1000u);
+    CHECK_EQ(t_rtc.runs, 3);
+    CHECK_EQ(rtc_reads, 3);
+    CHECK_EQ(t_button.runs, 5);
+    CHECK_EQ(toggles, 5);
+    CHECK_EQ(t_pwm.misses + t_rtc.misses, 0);
+
+    uint64_t elapsed = vcyc - c0;
+    uint64_t counted = (uint64_t)sched_stats.idle + sched_stats.task + sched_stats.overhead;
+    CHECK_EQ(elapsed - counted, (uint64_t)passes * SCHED_READ_CYC);   /* only the first read of a pass */
+    printf("demo over 3 s: idle %.3f %%, %u dispatches, %.1f scheduler cycles per dispatch"
+           " (virtual clock, %u cycles per SCHED_CYCLES read)\n",
+           100.0 * sched_stats.idle / counted, sched_stats.dispatches,
+           (double)sched_stats.overhead / sched_stats.dispatches, SCHED_READ_CYC);
+}
+
+static void noop(uint32_t ev) { host_sink += ev; }
+
+static void bench(void)
+{
+    enum { TASKS = 64, MS = 20000 };
+    static Task_t t[TASKS];
+    reset(0);
+    for (int i = 0; i < TASKS; ++i) {
+        t[i] = (Task_t){ .fn = noop, .period = 1u + (uint32_t)i % 40u };
+        sched_add(&t[i], 0);
+    }
+    uint64_t t0 = host_ns();
+    for (int ms = 0; ms < MS; ++ms) {
+        uwTick++;
+        sched_run_once();
+    }
+    double ns = (double)(host_ns() - t0);
+    printf("%u dispatches of %d tasks: %.1f ns per dispatch on the host, wheel pass included\n",
+           sched_stats.dispatches, TASKS, ns / sched_stats.dispatches);
+}
+
+int main(int argc, char **argv)
+{
+    check_periods();
+    check_catch_up_and_overrun();
+    check_events();
+    check_demo();
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_27_scheduler");
+}
@@ -0,0 +1,155 @@
+/* Host test for 28_pwm_waveform_dma.c: the table generators against a double
+ * reference for many lengths and ranges (rising and falling), with exact end
+ * points, monotonic ramps and S-curves, and S-curve end steps no larger than
+ * the smoothstep slope allows; then wave_play() on a mock circular DMA that moves one sample into
+ * TIM3->CCR1 per update event, checked sample by sample over table switches.
+ * --bench prints table generation time on the host and the CPU cost per
+ * sample against the 04_timer_pwm.c loop.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+#define main wave28_main
+#include "../28_pwm_waveform_dma.c"
+#undef main
+
+/* Mock circular DMA: memory -> TIM3->CCR1 on every update event. The
+ * 32-bit source address is resolved against the three tables, so the mock
+ * also works where host pointers are 64 bits wide. */
+static const uint16_t *dma_src;
+static uint32_t  dma_dst, dma_n, dma_pos, dma_aborts, dma_starts;
+static bool      dma_running;
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *h)
+{
+    CHECK(h == &hdma_tim3_up);
+    CHECK(!(TIM3->DIER & TIM_DMA_UPDATE));               /* requests off first */
+    dma_running = false;
+    dma_aborts++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *h, uint32_t src, uint32_t dst, uint32_t n)
+{
+    CHECK(h == &hdma_tim3_up);
+    CHECK(!dma_running);
+    const uint16_t *const tabs[] = { wave_ramp, wave_sine, wave_scurve };
+    dma_src = NULL;
+    for (size_t k = 0; k < sizeof tabs / sizeof tabs[0]; ++k)
+        if ((uint32_t)(uintptr_t)tabs[k] == src) dma_src = tabs[k];
+    CHECK(dma_src != NULL);
+    dma_dst = dst;
+    dma_n = n;
+    dma_pos = 0;
+    dma_running = true;
+    dma_starts++;
+    return HAL_OK;
+}
+
+static void update_event(void)
+{
+    if (!(TIM3->DIER & TIM_DMA_UPDATE) || !dma_running || !dma_src) return;
+    CHECK_EQ(dma_dst, (uint32_t)(uintptr_t)&TIM3->CCR1);
+    TIM3->CCR1 = dma_src[dma_pos];
+    dma_pos = (dma_pos + 1u) % dma_n;                    /* DMA_CIRCULAR */
+}
+
+static void check_tables(void)
+{
+    static uint16_t t[4096];
+    static const uint32_t lens[] = { 1, 2, 3, 7, 64, 255, 256, 1000, 4096 };
+    for (size_t k = 0; k < sizeof lens / sizeof lens[0]; ++k) {
+        for (int r = 0; r < 40; ++r) {
+            uint32_t n = lens[k];
+            uint16_t lo = (uint16_t)(host_rand() % 1000u), hi = (uint16_t)(host_rand() % 1000u);
+            if (r == 0) { lo = 0; hi = WAVE_ARR; }
+            if (r == 1) { lo = 65535; hi = 0; }
+            if (r == 2) hi = lo;
+            double span = (double)hi - lo, m = n > 1u ? n - 1.0 : 1.0;
+            int dir = hi >= lo ? 1 : -1;
+
+            wave_gen_ramp(t, n, lo, hi);
+            CHECK_EQ(t[0], lo);
+            if (n > 1u) CHECK_EQ(t[n - 1], hi);
+            for (uint32_t i = 0; i < n; ++i) {
+                CHECK(fabs(t[i] - (lo + span * i / m)) <= 0.5 + 1e-9);
+                if (i) CHECK(dir * ((int)t[i] - (int)t[i - 1]) >= 0);
+            }
+
+            wave_gen_scurve(t, n, lo, hi);
+            CHECK_EQ(t[0], lo);
+            if (n > 1u) CHECK_EQ(t[n - 1], hi);
+            for (uint32_t i = 0; i < n; ++i) {
+                double x = i / m;
+                CHECK(fabs(t[i] - (lo + span * x * x * (3.0 - 2.0 * x))) <= 0.5 + 1e-9);
+                if (i) CHECK(dir * ((int)t[i] - (int)t[i - 1]) >= 0);
+            }
+            if (n >= 64u) {                              /* flat ends: 3 span / m^2, a ramp steps span / m */
+                double flat = 3.0 * fabs(span) / (m * m) + 1.0;
+                CHECK(abs((int)t[1] - (int)t[0]) <= flat);
+                CHECK(abs((int)t[n - 1] - (int)t[n - 2]) <= flat);
+            }
+
+            if (hi < lo) continue;                       /* sine wants lo <= hi */
+            wave_gen_sine(t, n, lo, hi);
+            for (uint32_t i = 0; i < n; ++i) {
+                double v = (lo + hi) / 2.0 + span / 2.0 * sin(2.0 * M_PI * i / n);
+                CHECK(fabs(t[i] - v) <= 0.5 + 0.001 * span + 1e-3);   /* float sinf */
+                CHECK(t[i] >= lo && t[i] <= hi);
+            }
+        }
+    }
+}
+
+static void check_play(void)
+{
+    MX_DMA_Init();
+    MX_TIM3_Init();
+    CHECK(htim3.hdma[TIM_DMA_ID_UPDATE] == &hdma_tim3_up);
+    CHECK(hdma_tim3_up.Parent == &htim3);
+    CHECK_EQ(hdma_tim3_up.Init.Mode, DMA_CIRCULAR);
+    CHECK(hdma_tim3_up.Instance == DMA1_Stream2);
+
+    wave_gen_ramp(wave_ramp, WAVE_LEN, 0, WAVE_ARR);
+    wave_gen_sine(wave_sine, WAVE_LEN, 0, WAVE_ARR);
+    wave_gen_scurve(wave_scurve, WAVE_LEN, 0, WAVE_ARR);
+
+    /* Two passes of each table, switched the way main() does */
+    const uint16_t *tabs[] = { wave_ramp, wave_sine, wave_scurve, wave_ramp };
+    for (int k = 0; k < 4; ++k) {
+        wave_play(tabs[k], WAVE_LEN);
+        CHECK(TIM3->DIER & TIM_DMA_UPDATE);
+        for (uint32_t i = 0; i < 2u * WAVE_LEN; ++i) {
+            update_event();
+            CHECK_EQ(TIM3->CCR1, tabs[k][i % WAVE_LEN]);
+            CHECK(TIM3->CCR1 <= WAVE_ARR);
+        }
+    }
+    CHECK_EQ(dma_starts, 4);
+    CHECK_EQ(dma_aborts, 4);
+}
+
+static void bench(void)
+{
+    enum { N = 20000 };
+    uint64_t t0 = host_ns();
+    for (int i = 0; i < N; ++i) {
+        wave_gen_ramp(wave_ramp, WAVE_LEN, 0, WAVE_ARR);
+        wave_gen_sine(wave_sine, WAVE_LEN, 0, WAVE_ARR);
+        wave_gen_scurve(wave_scurve, WAVE_LEN, 0, WAVE_ARR);
+        host_sink += wave_ramp[1] + wave_sine[1] + wave_scurve[1];
+    }
+    printf("3 tables of %u samples: %.1f us per init on the host; after that 0 CPU cycles per sample"
+           " (DMA), where 04 wakes the loop for every 50 ms step\n",
+           WAVE_LEN, (double)(host_ns() - t0) / N / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    check_tables();
+    check_play();
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_28_pwm_waveform_dma");
+}
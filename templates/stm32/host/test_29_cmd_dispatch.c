@@ -0,0 +1,186 @@
+/* Host test for 29_cmd_dispatch.c: every opcode reaches its handler with the
+ * right argument rule, every other one- and two-letter opcode is unknown (so
+ * the perfect hash has no false hits), frame errors, and the fixed-point
+ * argument against values formatted from known integers, at the int32 limits
+ * and for malformed numbers. --bench compares ns per command with the
+ * strcmp() chain plus strtod() it replaces, on the same command mix.
+ */
+#include <stdlib.h>
+#include "host_test.h"
+
+#include "../29_cmd_dispatch.c"
+
+static int     last_op;
+static int32_t last_arg;
+static bool    last_has;
+
+#define HANDLER(name, id)                      \
+    void name(int32_t arg, bool has_arg)       \
+    {                                          \
+        last_op = (id);                        \
+        last_arg = arg;                        \
+        last_has = has_arg;                    \
+    }
+HANDLER(cmd_move_abs, 1)
+HANDLER(cmd_move_rel, 2)
+HANDLER(cmd_speed, 3)
+HANDLER(cmd_reference, 4)
+HANDLER(cmd_stop, 5)
+HANDLER(cmd_status, 6)
+HANDLER(cmd_enable, 7)
+HANDLER(cmd_disable, 8)
+
+static const struct { const char *op; int id; CmdArg_t args; } ops[] = {
+    { "MA", 1, CMD_ARG_REQUIRED }, { "MR", 2, CMD_ARG_REQUIRED }, { "SP", 3, CMD_ARG_REQUIRED },
+    { "RF", 4, CMD_ARG_NONE },     { "ST", 5, CMD_ARG_NONE },     { "Z", 6, CMD_ARG_NONE },
+    { "EN", 7, CMD_ARG_NONE },     { "DI", 8, CMD_ARG_OPTIONAL },
+};
+#define N_OPS (sizeof ops / sizeof ops[0])
+
+static CmdStatus_t run(const char *s)
+{
+    last_op = 0;
+    return cmd_dispatch(s, strlen(s));
+}
+
+static void check_opcodes(void)
+{
+    char buf[32];
+    for (size_t i = 0; i < N_OPS; ++i) {
+        snprintf(buf, sizeof buf, ">%s#", ops[i].op);
+        CHECK_EQ(run(buf), ops[i].args == CMD_ARG_REQUIRED ? CMD_ERR_ARG : CMD_OK);
+        if (ops[i].args != CMD_ARG_REQUIRED) {
+            CHECK_EQ(last_op, ops[i].id);
+            CHECK(!last_has);
+        }
+        snprintf(buf, sizeof buf, ">%s12.5#", ops[i].op);
+        CHECK_EQ(run(buf), ops[i].args == CMD_ARG_NONE ? CMD_ERR_ARG : CMD_OK);
+        if (ops[i].args != CMD_ARG_NONE) {
+            CHECK_EQ(last_op, ops[i].id);
+            CHECK(last_has);
+            CHECK_EQ(last_arg, 12500);
+        }
+    }
+
+    /* Every other opcode of one or two capitals */
+    for (int a = 'A'; a <= 'Z'; ++a) {
+        for (int b = '@'; b <= 'Z'; ++b) {
+            char op[3] = { (char)a, (char)(b == '@' ? 0 : b), 0 };
+            bool known = false;
+            for (size_t i = 0; i < N_OPS; ++i) known |= strcmp(op, ops[i].op) == 0;
+            if (known) continue;
+            snprintf(buf, sizeof buf, ">%s#", op);
+            CHECK_EQ(run(buf), CMD_ERR_UNKNOWN);
+            CHECK_EQ(last_op, 0);
+        }
+    }
+
+    static const char *bad[] = { "", ">", "#", ">#", "MA1#", ">MA1", ">1#", ">-5#", ">ma1#", ">.#" };
+    for (size_t i = 0; i < sizeof bad / sizeof bad[0]; ++i) {
+        CHECK_EQ(run(bad[i]), CMD_ERR_FORMAT);
+        CHECK_EQ(last_op, 0);
+    }
+    CHECK_EQ(run(">MAX1#"), CMD_ERR_UNKNOWN);
+    CHECK_EQ(run(">ZZZ#"), CMD_ERR_UNKNOWN);
+}
+
+static void check_args(void)
+{
+    char buf[48];
+    /* Formatted from a known value with 0..3 decimals, optional sign and zeros */
+    for (int r = 0; r < 200000; ++r) {
+        int32_t v = (int32_t)(host_rand() % 2147483648u);
+        if (r < 4) v = (int32_t[]){ 0, 1, 2147483647, 999 }[r];
+        uint32_t frac = host_rand() % 4u;
+        static const int32_t pow10[] = { 1000, 100, 10, 1 };
+        v -= v % pow10[frac];                              /* representable with 'frac' decimals */
+        bool neg = host_rand() & 1u;
+        const char *sign = neg ? "-" : (host_rand() & 1u) ? "+" : "";
+        int zeros = (int)(host_rand() % 3u);
+        if (frac == 0)
+            snprintf(buf, sizeof buf, ">MA%s%0*ld#", sign, 1 + zeros, (long)(v / 1000));
+        else
+            snprintf(buf, sizeof buf, ">MA%s%0*ld.%0*ld#", sign, 1 + zeros, (long)(v / 1000), (int)frac,
+                     (long)((v % 1000) / pow10[frac]));
+        CHECK_EQ(run(buf), CMD_OK);
+        CHECK_EQ(last_arg, neg ? -v : v);
+    }
+
+    static const struct { const char *s; CmdStatus_t st; int32_t v; } cases[] = {
+        { ">MA2147483.647#", CMD_OK, 2147483647 },  { ">MA-2147483.647#", CMD_OK, -2147483647 },
+        { ">MA2147483.648#", CMD_ERR_ARG, 0 },      { ">MA-2147483.648#", CMD_ERR_ARG, 0 },
+        { ">MA2147484#", CMD_ERR_ARG, 0 },          { ">MA99999999999999999999#", CMD_ERR_ARG, 0 },
+        { ">MA0000000000000001#", CMD_OK, 1000 },   { ">MA.5#", CMD_OK, 500 },
+        { ">MA5.#", CMD_OK, 5000 },                 { ">MA-0#", CMD_OK, 0 },
+        { ">MA1.2345#", CMD_ERR_ARG, 0 },           { ">MA1..2#", CMD_ERR_ARG, 0 },
+        { ">MA-#", CMD_ERR_ARG, 0 },                { ">MA+-1#", CMD_ERR_ARG, 0 },
+        { ">MA1e3#", CMD_ERR_ARG, 0 },              { ">MA 1#", CMD_ERR_ARG, 0 },
+        { ">MA.#", CMD_ERR_ARG, 0 },                { ">MA1,5#", CMD_ERR_ARG, 0 },
+        { ">DI-3#", CMD_OK, -3000 },                { ">Z0#", CMD_ERR_ARG, 0 },
+    };
+    for (size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+        CHECK_EQ(run(cases[i].s), cases[i].st);
+        if (cases[i].st == CMD_OK) CHECK_EQ(last_arg, cases[i].v);
+        else CHECK_EQ(last_op, 0);
+    }
+
+    /* Random bytes between the frame markers: never crashes, never reads past len */
+    for (int r = 0; r < 200000; ++r) {
+        size_t n = 1 + host_rand() % 16u;
+        char *p = malloc(n);                               /* ASan catches an overread */
+        for (size_t i = 0; i < n; ++i) p[i] = "MAZDIST>#.-+0123456789"[host_rand() % 22u];
+        host_sink += (uint32_t)cmd_dispatch(p, n);
+        free(p);
+    }
+}
+
+/* The dispatcher it replaces: copy the opcode, strcmp() chain, strtod() */
+static CmdStatus_t strcmp_dispatch(const char *cmd, size_t len)
+{
+    char op[3] = { 0 }, arg[32];
+    if (len < 3 || cmd[0] != '>' || cmd[len - 1] != '#') return CMD_ERR_FORMAT;
+    size_t i = 1, n = 0;
+    while (i < len - 1 && cmd[i] >= 'A' && cmd[i] <= 'Z' && n < 2) op[n++] = cmd[i++];
+    size_t alen = len - 1 - i;
+    if (alen >= sizeof arg) return CMD_ERR_ARG;
+    memcpy(arg, cmd + i, alen);
+    arg[alen] = 0;
+    char *end;
+    double d = strtod(arg, &end);
+    bool has = alen != 0;
+    if (has && *end) return CMD_ERR_ARG;
+    int32_t v = (int32_t)(d * 1000.0 + (d < 0 ? -0.5 : 0.5));
+    if (strcmp(op, "MA") == 0) cmd_move_abs(v, has);
+    else if (strcmp(op, "MR") == 0) cmd_move_rel(v, has);
+    else if (strcmp(op, "SP") == 0) cmd_speed(v, has);
+    else if (strcmp(op, "RF") == 0) cmd_reference(v, has);
+    else if (strcmp(op, "ST") == 0) cmd_stop(v, has);
+    else if (strcmp(op, "Z") == 0) cmd_status(v, has);
+    else if (strcmp(op, "EN") == 0) cmd_enable(v, has);
+    else if (strcmp(op, "DI") == 0) cmd_disable(v, has);
+    else return CMD_ERR_UNKNOWN;
+    return CMD_OK;
+}
+
+static void bench(void)
+{
+    static const char *mix[] = { ">MA090.000#", ">MR-12.5#", ">SP1500#", ">Z#", ">ST#", ">DI#", ">EN#", ">RF#" };
+    enum { N = 4000000, M = sizeof mix / sizeof mix[0] };
+    size_t lens[M];
+    for (int i = 0; i < M; ++i) lens[i] = strlen(mix[i]);
+    CmdStatus_t (*fns[])(const char *, size_t) = { cmd_dispatch, strcmp_dispatch };
+    const char *names[] = { "perfect hash + fixed point", "strcmp chain + strtod" };
+    for (int f = 0; f < 2; ++f) {
+        uint64_t t0 = host_ns();
+        for (int i = 0; i < N; ++i) host_sink += (uint32_t)fns[f](mix[i % M], lens[i % M]) + (uint32_t)last_arg;
+        printf("%-28s %6.1f ns per command on the host\n", names[f], (double)(host_ns() - t0) / N);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    check_opcodes();
+    check_args();
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_29_cmd_dispatch");
+}
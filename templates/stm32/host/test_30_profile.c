@@ -0,0 +1,138 @@
+/* Host test for 30_profile.c with PROFILE_CYCLES() on a virtual counter where
+ * every read costs PROF_READ_CYC: checks the calibrated overhead, exact
+ * count/min/max/sum per probe against a reference, that record/reset/dump
+ * leave PRIMASK as they found it (masked inside an ISR stays masked), that the
+ * DWT is not touched when PROFILE_CYCLES() is overridden, and the binary
+ * record byte by byte with its checksum, COBS framed between two 0x00 and
+ * with no 0x00 inside. --bench prints host ns per probe.
+ */
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+#define PROF_READ_CYC 3u
+static uint32_t vcyc;
+static uint32_t prof_read(void) { return vcyc += PROF_READ_CYC; }
+#define PROFILE_CYCLES() prof_read()
+
+static uint8_t out[1024];
+static size_t  out_n;
+int __io_putchar(int ch)
+{
+    if (out_n < sizeof out) out[out_n++] = (uint8_t)ch;
+    return ch;
+}
+
+#include "../30_profile.c"
+
+static struct { uint32_t count, min, max; uint64_t sum; } ref[PROF_COUNT];
+
+static void probe(ProfileId_t id, uint32_t work)
+{
+    switch (id) {                                        /* the macros need a literal id */
+    case PROF_PARSE_Z: { PROFILE_BEGIN(PROF_PARSE_Z); vcyc += work; PROFILE_END(PROF_PARSE_Z); break; }
+    case PROF_MEASURE_TEMP: { PROFILE_BEGIN(PROF_MEASURE_TEMP); vcyc += work; PROFILE_END(PROF_MEASURE_TEMP); break; }
+    case PROF_NORMALIZE_CMD: { PROFILE_BEGIN(PROF_NORMALIZE_CMD); vcyc += work; PROFILE_END(PROF_NORMALIZE_CMD); break; }
+    default: { PROFILE_BEGIN(PROF_UART_RX_CB); vcyc += work; PROFILE_END(PROF_UART_RX_CB); break; }
+    }
+    if (ref[id].count == 0 || work < ref[id].min) ref[id].min = work;
+    if (work > ref[id].max) ref[id].max = work;
+    ref[id].sum += work;
+    ref[id].count++;
+}
+
+static uint32_t get32(const uint8_t *p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+
+/* Reference COBS decoder for one frame without its 0x00; 0 when broken */
+static size_t cobs_decode(const uint8_t *in, size_t n, uint8_t *dst)
+{
+    size_t i = 0, o = 0;
+    while (i < n) {
+        uint8_t code = in[i++];
+        if (code == 0u || i + code - 1u > n) return 0;
+        for (uint8_t k = 1; k < code; ++k) dst[o++] = in[i++];
+        if (code != 0xFFu && i < n) dst[o++] = 0u;
+    }
+    return o;
+}
+
+/* Parse the dump and compare it with ref[] */
+static void check_dump(void)
+{
+    static uint8_t rec[sizeof out];
+    out_n = 0;
+    profile_dump();
+    CHECK(out_n > 9);
+    CHECK(out[0] == 0 && out[out_n - 1] == 0);
+    CHECK(memchr(&out[1], 0, out_n - 2) == NULL);
+    size_t rec_n = cobs_decode(&out[1], out_n - 2, rec);
+    CHECK(rec_n > 7);
+    CHECK(rec[0] == 'P' && rec[1] == 'F' && rec[2] == 2);
+    CHECK_EQ(rec[3] | rec[4] << 8, SystemCoreClock / 1000000u);
+    CHECK_EQ(rec[5], PROF_COUNT);
+    size_t p = 6;
+    for (uint32_t i = 0; i < PROF_COUNT && p < rec_n; ++i) {
+        CHECK_EQ(rec[p], i);
+        uint8_t len = rec[p + 1];
+        CHECK_EQ(len, strlen(prof_names[i]));
+        CHECK(memcmp(&rec[p + 2], prof_names[i], len) == 0);
+        p += 2u + len;
+        CHECK_EQ(get32(&rec[p]), ref[i].count);
+        CHECK_EQ(get32(&rec[p + 4]), ref[i].min);
+        CHECK_EQ(get32(&rec[p + 8]), ref[i].max);
+        CHECK_EQ(get32(&rec[p + 12]) | (uint64_t)get32(&rec[p + 16]) << 32, ref[i].sum);
+        p += 20;
+    }
+    CHECK_EQ(p + 1, rec_n);
+    uint8_t sum = 0;
+    for (size_t i = 0; i + 1 < rec_n; ++i) sum = (uint8_t)(sum + rec[i]);
+    CHECK_EQ(rec[rec_n - 1], sum);
+}
+
+static void check_primask(void)
+{
+    for (uint32_t pm = 0; pm < 2; ++pm) {
+        host_primask = pm;                               /* 1: called from an ISR */
+        probe(PROF_UART_RX_CB, 10);
+        CHECK_EQ(host_primask, pm);
+        check_dump();
+        CHECK_EQ(host_primask, pm);
+        profile_reset();
+        memset(ref, 0, sizeof ref);
+        CHECK_EQ(host_primask, pm);
+    }
+    host_primask = 0;
+}
+
+static void bench(void)
+{
+    enum { N = 10000000 };
+    uint64_t t0 = host_ns();
+    for (int i = 0; i < N; ++i) {
+        PROFILE_BEGIN(PROF_PARSE_Z);
+        host_sink += (uint32_t)i;
+        PROFILE_END(PROF_PARSE_Z);
+    }
+    printf("BEGIN/END pair with profile_record(): %.1f ns on the host\n", (double)(host_ns() - t0) / N);
+}
+
+int main(int argc, char **argv)
+{
+    profile_init();
+    CHECK_EQ(prof_overhead, PROF_READ_CYC);
+    CHECK_EQ(host_coredebug.DEMCR, 0);                  /* PROFILE_CYCLES() overridden */
+    CHECK_EQ(host_dwt.CTRL, 0);
+
+    check_dump();                                        /* empty table */
+    for (int i = 0; i < 100000; ++i) {
+        uint32_t work = host_rand() % 5000u;
+        if (i % 997 == 0) work = 0;
+        probe((ProfileId_t)(host_rand() % PROF_COUNT), work);
+    }
+    probe(PROF_PARSE_Z, 4000000000u);                    /* sum above 32 bits */
+    probe(PROF_PARSE_Z, 4000000000u);
+    check_dump();
+    check_primask();
+
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_30_profile");
+}
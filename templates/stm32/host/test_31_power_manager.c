@@ -0,0 +1,319 @@
+/* Host test for 31_power_manager.c on a virtual core clock and a virtual RTC
+ * counting 1/2048 s. HAL_PWR_EnterSTOPMode() drops the clock tree to HSI, lets
+ * the RTC run to the armed wakeup (or an earlier button edge) and enters the
+ * wake ISR, which then spends more cycles; every RCC access costs 1 us on HSI
+ * and HSE/PLL come up after a set number of polls. Checks:
+ * - SLEEP below PM_STOP_MIN_MS, STOP above, the logger drained before STOP;
+ * - the wakeup never fires after the deadline and HAL_GetTick() is moved on by
+ *   the time slept, to the 1/256 s the RTC resolves;
+ * - the latency runs from the wake ISR entry to the restored clocks, so the ISR
+ *   work after the stamp is in it, and the first source wins;
+ * - the SystemClock_Config() fallback when HSE does not start;
+ * - STANDBY: backup registers written, WU cleared, the wakeup armed; the wake
+ *   is a reset (longjmp) and pm_boot() recovers count and duration, also
+ *   across midnight.
+ * --bench prints host ns per pm_idle() that ends in STOP.
+ */
+#include <setjmp.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+#define RCC_ACCESS_CYC (HSI_VALUE / 1000000u)   /* 1 us per register access on HSI */
+#define ISR_TAIL_CYC   1600u                     /* wake ISR after the stamp, 100 us */
+#define RTC_HZ         2048u
+#define RTC_DAY        (86400ull * RTC_HZ)
+
+static uint32_t vcyc;
+uint32_t host_cyccnt(void) { return vcyc; }
+
+/* Oscillators: ready after this many RCC accesses once switched on */
+static uint32_t hse_polls = 20, pll_polls = 40, hse_left, pll_left, rcc_accesses;
+void host_rcc_access(void)
+{
+    vcyc += RCC_ACCESS_CYC;
+    rcc_accesses++;
+    if ((host_rcc.CR & RCC_CR_HSEON) && !(host_rcc.CR & RCC_CR_HSERDY) && hse_left && --hse_left == 0)
+        host_rcc.CR |= RCC_CR_HSERDY;
+    if ((host_rcc.CR & RCC_CR_PLLON) && !(host_rcc.CR & RCC_CR_PLLRDY) && pll_left && --pll_left == 0)
+        host_rcc.CR |= RCC_CR_PLLRDY;
+    if ((host_rcc.CFGR & 3u) == RCC_CFGR_SW_PLL && (host_rcc.CR & RCC_CR_PLLRDY))
+        host_rcc.CFGR = (host_rcc.CFGR & ~RCC_CFGR_SWS) | RCC_CFGR_SWS_PLL;
+}
+
+static uint32_t log_busy;                        /* flushes until the logger is idle */
+void uart_log_init(UART_HandleTypeDef *huart) { (void)huart; }
+void uart_log_tx_complete(void) { }
+void uart_log_tx_error(void) { }
+void uart_log_flush(void) { if (log_busy) log_busy--; }
+bool uart_log_idle(void) { return log_busy == 0; }
+
+#define main pm31_main
+#include "../31_power_manager.c"
+#undef main
+
+/* RTC */
+static uint64_t rtc_cnt;                         /* 1/2048 s since midnight */
+static uint64_t wake_ticks;
+static bool     wake_armed, tick_suspended, bkup_access;
+static uint32_t bkp[2];
+
+HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *h, RTC_TimeTypeDef *t, uint32_t f)
+{
+    (void)h; (void)f;
+    uint32_t s = (uint32_t)(rtc_cnt / RTC_HZ);
+    *t = (RTC_TimeTypeDef){ .Hours = (uint8_t)(s / 3600u), .Minutes = (uint8_t)(s / 60u % 60u),
+                            .Seconds = (uint8_t)(s % 60u), .SecondFraction = 255u,
+                            .SubSeconds = 255u - (uint32_t)(rtc_cnt % RTC_HZ) / 8u };
+    return HAL_OK;
+}
+HAL_StatusTypeDef HAL_RTC_GetDate(RTC_HandleTypeDef *h, RTC_DateTypeDef *d, uint32_t f)
+{
+    (void)h; (void)f;
+    *d = (RTC_DateTypeDef){ 1, 1, 1, 25 };
+    return HAL_OK;
+}
+HAL_StatusTypeDef HAL_RTCEx_SetWakeUpTimer_IT(RTC_HandleTypeDef *h, uint32_t counter, uint32_t clock)
+{
+    (void)h;
+    CHECK(counter <= 0xFFFFu);
+    wake_ticks = clock == RTC_WAKEUPCLOCK_RTCCLK_DIV16 ? counter + 1u : (counter + 1ull) * RTC_HZ;
+    wake_armed = true;
+    return HAL_OK;
+}
+HAL_StatusTypeDef HAL_RTCEx_DeactivateWakeUpTimer(RTC_HandleTypeDef *h) { (void)h; wake_armed = false; return HAL_OK; }
+uint32_t HAL_RTCEx_BKUPRead(RTC_HandleTypeDef *h, uint32_t reg) { (void)h; return bkp[reg]; }
+void HAL_RTCEx_BKUPWrite(RTC_HandleTypeDef *h, uint32_t reg, uint32_t data)
+{
+    (void)h;
+    CHECK(bkup_access);
+    bkp[reg] = data;
+}
+void HAL_PWR_EnableBkUpAccess(void) { bkup_access = true; }
+void HAL_SuspendTick(void) { tick_suspended = true; }
+
+static uint32_t resume_cyc;
+void HAL_ResumeTick(void)
+{
+    tick_suspended = false;
+    resume_cyc = vcyc;
+}
+
+void HAL_RTCEx_WakeUpTimerIRQHandler(RTC_HandleTypeDef *h)
+{
+    vcyc += ISR_TAIL_CYC;
+    HAL_RTCEx_WakeUpTimerEventCallback(h);
+}
+void HAL_GPIO_EXTI_IRQHandler(uint16_t pin)
+{
+    vcyc += ISR_TAIL_CYC;
+    HAL_GPIO_EXTI_Callback(pin);
+}
+void HAL_GPIO_TogglePin(GPIO_TypeDef *port, uint16_t pin) { port->ODR ^= pin; }
+
+static void rtc_run(uint64_t ticks) { rtc_cnt = (rtc_cnt + ticks) % RTC_DAY; }
+
+/* Low-power entries */
+static uint32_t sleeps, stops;
+static uint64_t button_at;                       /* RTC ticks into the next STOP, 0: none */
+static bool     button_and_rtc;                  /* both pending at the wake */
+static uint32_t isr_entry_cyc;
+static uint64_t slept_ticks;
+
+void HAL_PWR_EnterSLEEPMode(uint32_t reg, uint8_t entry)
+{
+    (void)reg; (void)entry;
+    sleeps++;
+    uwTick++;                                    /* SysTick */
+}
+
+void HAL_PWR_EnterSTOPMode(uint32_t reg, uint8_t entry)
+{
+    (void)entry;
+    CHECK_EQ(reg, PWR_LOWPOWERREGULATOR_ON);
+    CHECK(wake_armed);
+    CHECK(tick_suspended);
+    CHECK(uart_log_idle());                      /* no DMA in flight */
+    stops++;
+    host_rcc.CR &= ~(RCC_CR_HSEON | RCC_CR_HSERDY | RCC_CR_PLLON | RCC_CR_PLLRDY);
+    host_rcc.CFGR &= ~(RCC_CFGR_SWS | 3u);       /* HSI */
+    hse_left = hse_polls;
+    pll_left = pll_polls;
+
+    bool button = button_at && button_at < wake_ticks;
+    slept_ticks = button ? button_at : wake_ticks;
+    rtc_run(slept_ticks);
+    vcyc += 12345u;                              /* CYCCNT runs on HSI from here */
+    isr_entry_cyc = vcyc;
+    if (button) EXTI0_IRQHandler();
+    else RTC_WKUP_IRQHandler();
+    if (button && button_and_rtc) RTC_WKUP_IRQHandler();
+}
+
+static jmp_buf standby_reset;
+static uint32_t standbys;
+void HAL_PWR_EnterSTANDBYMode(void)
+{
+    CHECK(wake_armed);
+    CHECK(!__HAL_PWR_GET_FLAG(PWR_FLAG_WU));
+    CHECK_EQ(bkp[0], pm_rtc_ms());
+    standbys++;
+    rtc_run(wake_ticks);
+    host_pwr.CSR |= PWR_FLAG_SB | PWR_FLAG_WU;
+    longjmp(standby_reset, 1);                   /* the wake is a reset */
+}
+
+/* What survives a reset: RTC, backup registers, PWR flags; RAM does not */
+static void power_up(void)
+{
+    memset(&pm, 0, sizeof pm);
+    memset(&pm_clk, 0, sizeof pm_clk);
+    pm_standby_allowed = false;
+    bkup_access = false;
+    wake_armed = false;
+    host_rcc.CR = RCC_CR_HSEON | RCC_CR_HSERDY | RCC_CR_PLLON | RCC_CR_PLLRDY;
+    host_rcc.CFGR = RCC_CFGR_SW_PLL | RCC_CFGR_SWS_PLL | 0x9400u;
+    host_rcc.PLLCFGR = 0x24003010u;
+    pm_clock_capture();
+    CHECK(pm_clk.valid);
+    pm_boot();
+}
+
+static uint32_t armed_ms(void) { return (uint32_t)(wake_ticks * 1000u / RTC_HZ); }
+
+static void check_sleep_and_stop(void)
+{
+    power_up();
+    uwTick = 0xFFFFF000u;                        /* deadlines across the tick wrap */
+
+    /* Short budget: SLEEP, no RTC wakeup */
+    for (uint32_t b = 1; b < PM_STOP_MIN_MS; ++b) {
+        uint32_t s0 = sleeps, t0 = HAL_GetTick();
+        pm_idle(HAL_GetTick() + b);
+        CHECK_EQ(sleeps, s0 + 1u);
+        CHECK_EQ(HAL_GetTick(), t0 + 1u);
+    }
+    CHECK_EQ(stops, 0);
+    pm_idle(HAL_GetTick());                      /* due now */
+    pm_idle(HAL_GetTick() - 5u);                 /* overdue */
+    CHECK_EQ(sleeps, PM_STOP_MIN_MS - 1u);
+
+    /* STOP up to the deadline, never after it */
+    static const uint32_t budgets[] = { 3, 4, 7, 10, 999, 1000, 31999, 32000, 32001, 45500, 3600000 };
+    for (size_t i = 0; i < sizeof budgets / sizeof budgets[0]; ++i) {
+        uint32_t deadline = HAL_GetTick() + budgets[i], st0 = stops, ms0 = pm.ms[PM_STOP], t0 = HAL_GetTick();
+        pm_idle(deadline);
+        CHECK_EQ(stops, st0 + 1u);
+        CHECK(armed_ms() <= budgets[i]);
+        CHECK(armed_ms() + (budgets[i] > 32000u ? 1000u : 1u) >= budgets[i]);
+        CHECK(!wake_armed);
+        uint32_t slept = HAL_GetTick() - t0;
+        CHECK(abs((int)slept - (int)(slept_ticks * 1000u / RTC_HZ)) <= 4);
+        CHECK_EQ(pm.ms[PM_STOP] - ms0, slept);
+        CHECK((int32_t)(HAL_GetTick() - deadline) <= 3);   /* the RTC reads in 1/256 s */
+        CHECK_EQ(host_rcc.CFGR & RCC_CFGR_SWS, RCC_CFGR_SWS_PLL);
+    }
+    CHECK_EQ(pm.wakes[PM_WAKE_RTC], sizeof budgets / sizeof budgets[0]);
+    CHECK_EQ(pm.clk_fallbacks, 0);
+
+    /* No deadline, STANDBY not allowed: STOP with the 60 s wakeup */
+    pm_idle(PM_NO_DEADLINE);
+    CHECK_EQ(armed_ms(), PM_STANDBY_MIN_MS);
+    CHECK_EQ(standbys, 0);
+
+    /* The logger is drained first; too late for STOP afterwards: SLEEP */
+    uint32_t st0 = stops, s0 = sleeps;
+    log_busy = 4;
+    pm_idle(HAL_GetTick() + 100u);
+    CHECK_EQ(stops, st0 + 1u);
+    log_busy = 4;
+    pm_idle(HAL_GetTick() + 5u);
+    CHECK_EQ(stops, st0 + 1u);
+    CHECK_EQ(sleeps, s0 + 1u);
+    log_busy = 0;
+}
+
+/* Latency = ISR entry -> clocks back, counted on HSI */
+static void check_latency(void)
+{
+    power_up();
+    for (int r = 0; r < 2000; ++r) {
+        hse_polls = 1 + host_rand() % 100u;
+        pll_polls = 1 + host_rand() % 200u;
+        bool button = r & 1;
+        button_at = button ? 1 + host_rand() % 2000u : 0;
+        button_and_rtc = button && (r & 2);
+        uint32_t w_rtc = pm.wakes[PM_WAKE_RTC], w_btn = pm.wakes[PM_WAKE_BUTTON];
+        uint32_t sum0 = pm.lat_sum_us[button ? PM_WAKE_BUTTON : PM_WAKE_RTC];
+        pm_idle(HAL_GetTick() + 1000u + host_rand() % 5000u);
+        uint32_t want = (resume_cyc - isr_entry_cyc) / (HSI_VALUE / 1000000u);
+        CHECK(want >= ISR_TAIL_CYC / RCC_ACCESS_CYC + hse_polls + pll_polls);
+        CHECK_EQ(pm.wakes[PM_WAKE_BUTTON], w_btn + (button ? 1u : 0u));
+        CHECK_EQ(pm.wakes[PM_WAKE_RTC], w_rtc + (button ? 0u : 1u));
+        CHECK_EQ(pm.lat_sum_us[button ? PM_WAKE_BUTTON : PM_WAKE_RTC] - sum0, want);
+    }
+    button_at = 0;
+    button_and_rtc = false;
+    CHECK(pm.lat_max_us[PM_WAKE_RTC] >= pm.lat_sum_us[PM_WAKE_RTC] / pm.wakes[PM_WAKE_RTC]);
+
+    /* HSE does not start: SystemClock_Config() instead, after the poll budget */
+    hse_polls = 0;
+    uint32_t lat0 = pm.lat_sum_us[PM_WAKE_RTC];
+    pm_idle(HAL_GetTick() + 50u);
+    CHECK_EQ(pm.clk_fallbacks, 1);
+    CHECK(pm.lat_sum_us[PM_WAKE_RTC] - lat0 >= PM_CLK_TIMEOUT);
+    hse_polls = 20;
+    pll_polls = 40;
+}
+
+static void check_standby(void)
+{
+    memset(bkp, 0, sizeof bkp);
+    host_pwr.CSR = 0;
+    static const uint64_t start[] = { 3600ull * RTC_HZ + 77u, 12345u, (86400ull - 30u) * RTC_HZ + 1000u };
+    for (volatile uint32_t n = 1; n <= 3; ++n) {   /* live across setjmp() */
+        rtc_cnt = start[n - 1];
+        power_up();
+        CHECK_EQ(pm.entries[PM_STANDBY], n - 1u);
+        pm_allow_standby(true);
+        host_pwr.CSR |= PWR_FLAG_WU;             /* left over from a previous wake */
+        if (setjmp(standby_reset) == 0) {
+            pm_idle(PM_NO_DEADLINE);
+            CHECK(!"pm_idle() returned instead of entering STANDBY");
+            continue;
+        }
+        CHECK_EQ(standbys, n);
+        CHECK_EQ(armed_ms(), PM_STANDBY_MIN_MS);
+        CHECK_EQ(bkp[1], n);
+
+        power_up();                              /* reset after the wake */
+        CHECK(!__HAL_PWR_GET_FLAG(PWR_FLAG_SB));
+        CHECK_EQ(pm.entries[PM_STANDBY], n);
+        CHECK(abs((int)pm.ms[PM_STANDBY] - (int)PM_STANDBY_MIN_MS) <= 4);
+    }
+
+    /* Power-on or pin reset: SB clear, the duration is not made up */
+    power_up();
+    CHECK_EQ(pm.ms[PM_STANDBY], 0);
+    CHECK_EQ(pm.entries[PM_STANDBY], 3);
+}
+
+static void bench(void)
+{
+    enum { N = 1000000 };
+    power_up();
+    hse_polls = 1;
+    pll_polls = 1;
+    uint64_t t0 = host_ns();
+    for (int i = 0; i < N; ++i) pm_idle(HAL_GetTick() + 10u);
+    printf("pm_idle() into STOP and back: %.1f ns on the host (stubbed HAL)\n", (double)(host_ns() - t0) / N);
+}
+
+int main(int argc, char **argv)
+{
+    check_sleep_and_stop();
+    check_latency();
+    check_standby();
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_31_power_manager");
+}
@@ -0,0 +1,195 @@
+/* Host test for 32_binlog.c: COBS round trip with zero runs and 254-byte
+ * blocks, every record starts and ends with 0x00 and has none inside, the
+ * record fields (id, sign bits, time, varints, checksum) read back for random
+ * arguments, and BLOG() takes the sign bits from the C types of its arguments.
+ * The "binlog" section is linked normally here, BLOG_BASE is its start.
+ *
+ * --emit writes printf text and records mixed to stdout and every record as
+ * printf formats it to stderr; tools/test_binlog_decode.py decodes stdout with
+ * this executable as the ELF and compares. --bench compares ns per BLOG() with
+ * snprintf() of the same line.
+ */
+#include <stdlib.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+extern const char __start_binlog[];
+#define BLOG_BASE ((uintptr_t)__start_binlog)
+static uint32_t vtime;
+#define BLOG_TIME() (vtime += 7u)
+
+static uint8_t out[4096];
+static size_t  out_n;
+static bool    emit;
+int __io_putchar(int ch)
+{
+    if (emit) putchar(ch);
+    else if (out_n < sizeof out) out[out_n++] = (uint8_t)ch;
+    return ch;
+}
+
+#include "../32_binlog.c"
+
+static void check_cobs(void)
+{
+    static uint8_t in[700], enc[720], dec[720];
+    for (int r = 0; r < 20000; ++r) {
+        uint32_t n = host_rand() % sizeof in;
+        uint32_t zeros = host_rand() % 4u;               /* 0: none, else 1 in 2^zeros */
+        for (uint32_t i = 0; i < n; ++i)
+            in[i] = zeros && (host_rand() & ((1u << zeros) - 1u)) == 0 ? 0u : (uint8_t)(1u + host_rand() % 255u);
+        uint32_t e = blog_cobs_encode(in, n, enc);
+        CHECK(e <= n + n / 254u + 1u);
+        CHECK(memchr(enc, 0, e) == NULL);
+        CHECK_EQ(blog_cobs_decode(enc, e, dec), n);
+        CHECK(memcmp(in, dec, n) == 0);
+    }
+}
+
+static uint32_t get_varint(const uint8_t *p, uint32_t *pos)
+{
+    uint32_t v = 0;
+    for (uint32_t shift = 0;; shift += 7) {
+        uint8_t b = p[(*pos)++];
+        v |= (uint32_t)(b & 0x7Fu) << shift;
+        if (!(b & 0x80u)) return v;
+    }
+}
+
+/* One frame at out/n: 0x00 | COBS | 0x00, fields as given */
+static void check_frame(const uint8_t *f, uint32_t n, uint16_t id, uint8_t sign, uint32_t time,
+                        const uint32_t *args, uint32_t argc)
+{
+    uint8_t rec[BLOG_REC_MAX];
+    CHECK(n >= 2u && f[0] == 0u && f[n - 1] == 0u);
+    CHECK(memchr(f + 1, 0, n - 2u) == NULL);
+    uint32_t len = blog_cobs_decode(f + 1, n - 2u, rec);
+    CHECK(len >= 5u && len <= sizeof rec);
+    CHECK_EQ(rec[0] | rec[1] << 8, id);
+    CHECK_EQ(rec[2], sign);
+    uint32_t pos = 3;
+    CHECK_EQ(get_varint(rec, &pos), time);
+    for (uint32_t i = 0; i < argc; ++i) CHECK_EQ(get_varint(rec, &pos), args[i]);
+    CHECK_EQ(pos + 1u, len);
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i + 1u < len; ++i) sum = (uint8_t)(sum + rec[i]);
+    CHECK_EQ(rec[len - 1u], sum);
+}
+
+static void check_records(void)
+{
+    uint8_t f[BLOG_REC_MAX + BLOG_REC_MAX / 254u + 3u];
+    uint32_t args[BLOG_MAX_ARGS];
+    for (int r = 0; r < 100000; ++r) {
+        uint32_t argc = host_rand() % (BLOG_MAX_ARGS + 1u);
+        for (uint32_t i = 0; i < argc; ++i) args[i] = host_rand() >> (host_rand() % 32u);
+        uint16_t id = (uint16_t)host_rand();
+        uint32_t time = host_rand() >> (host_rand() % 32u);
+        uint8_t sign = (uint8_t)host_rand();
+        uint32_t n = blog_encode(id, sign, time, args, argc, f);
+        CHECK(n <= sizeof f);
+        check_frame(f, n, id, (uint8_t)(sign & ((1u << argc) - 1u)), time, args, argc);
+    }
+}
+
+static uint32_t fbits(float x) { uint32_t v; memcpy(&v, &x, sizeof v); return v; }
+
+/* Id of a format string: its offset in the section */
+extern const char __stop_binlog[];
+static uint16_t fmt_id(const char *fmt)
+{
+    for (const char *s = __start_binlog; s < __stop_binlog; s += strlen(s) + 1)
+        if (strcmp(s, fmt) == 0) return (uint16_t)(s - __start_binlog);
+    CHECK(!"format not in the binlog section");
+    return 0xFFFFu;
+}
+
+static void check_macro(void)
+{
+    /* Text right before a record: the leading 0x00 closes it */
+    out_n = 0;
+    __io_putchar('T');
+    __io_putchar('=');
+    BLOG("%d %u %c %hd %x %f", -5, 5u, 'A', (short)-3, 0xDEADBEEFu, 1.5f);
+    CHECK(memcmp(out, "T=\0", 3) == 0);
+    check_frame(out + 2, (uint32_t)out_n - 2u, fmt_id("%d %u %c %hd %x %f"), 1u | 1u << 2 | 1u << 3, vtime,
+                (const uint32_t[]){ 9u, 5u, 130u, 5u, 0xDEADBEEFu, fbits(1.5f) }, 6);
+
+    /* No arguments */
+    out_n = 0;
+    BLOG("plain");
+    check_frame(out, (uint32_t)out_n, fmt_id("plain"), 0u, vtime, NULL, 0);
+
+    /* long and long long are signed and sent as their low 32 bits, unsigned not zigzagged */
+    out_n = 0;
+    BLOG("%ld %lld %lu %hhu", -100000L, -2LL, 7UL, (unsigned char)250);
+    check_frame(out, (uint32_t)out_n, fmt_id("%ld %lld %lu %hhu"), 3u, vtime,
+                (const uint32_t[]){ 199999u, 3u, 7u, 250u }, 4);
+}
+
+/* BLOG() and fprintf() of the same line; the text before it has no newline */
+static int emit_n;
+#define BOTH(fmt, ...) do {                                    \
+        printf("t%d:", emit_n++);                              \
+        BLOG(fmt, ##__VA_ARGS__);                              \
+        fprintf(stderr, fmt "\n", ##__VA_ARGS__);              \
+    } while (0)
+
+static void emit_cases(void)
+{
+    emit = true;
+    BOTH("no args");
+    BOTH("%d", -5);
+    BOTH("%u", -5);                                      /* printed with the other sign */
+    BOTH("%d", 4000000000u);
+    BOTH("%i %d %d", INT32_MIN, INT32_MAX, 0);
+    BOTH("%x %X %o", -1, 255u, 8u);
+    BOTH("%#x %#x %#X", 0u, 255u, 171u);
+    BOTH("%hd %hu", (short)-3, (short)-3);
+    BOTH("%hhd %hhu", (signed char)-2, (unsigned char)250);
+    BOTH("%c%c%c", 'O', 'K', 33);
+    BOTH("%+d %05d %-4d|%4u|", 7, -42, 3, 12u);
+    BOTH("%5.2f|%-9.3e|%g|%f", 3.25f, -0.125f, 1e-3f, -0.0f);
+    BOTH("%ld %lu", -100000L, 100000UL);
+    BOTH("%d%% done", 50);
+    BOTH("T1=%d.%02u C T2=%d.%02u C", -3, 5u, 21, 75u);
+    printf("tail text\n");
+    fflush(stdout);
+    emit = false;
+}
+
+static void bench(void)
+{
+    enum { N = 2000000 };
+    char line[64];
+    uint64_t t0 = host_ns();
+    for (int i = 0; i < N; ++i) {
+        out_n = 0;
+        BLOG("T1=%d.%02u C T2=%d.%02u C", i / 100, (unsigned)i % 100u, -i / 100, (unsigned)i % 100u);
+        host_sink += out[3];
+    }
+    uint64_t t1 = host_ns();
+    for (int i = 0; i < N; ++i) {
+        int n = snprintf(line, sizeof line, "T1=%d.%02u C T2=%d.%02u C", i / 100, (unsigned)i % 100u, -i / 100,
+                         (unsigned)i % 100u);
+        host_sink += (uint32_t)n + (uint8_t)line[4];
+    }
+    uint64_t t2 = host_ns();
+    printf("BLOG() %.1f ns, snprintf() %.1f ns per line on the host; %zu vs %zu bytes on the wire\n",
+           (double)(t1 - t0) / N, (double)(t2 - t1) / N, out_n, strlen("T1=12.34 C T2=-12.34 C\r\n"));
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--emit") == 0) {
+            emit_cases();
+            return 0;
+        }
+    }
+    check_cobs();
+    check_records();
+    check_macro();
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_32_binlog");
+}
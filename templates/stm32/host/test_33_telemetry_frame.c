@@ -0,0 +1,340 @@
+/* Host test for 33_telemetry_frame.c: the CRC-16/CCITT-FALSE check value and
+ * the table against a bitwise reference; TEMP and Z frames round-tripped
+ * through tlm_parse() and the decoders for random snapshots and states; every
+ * cap below a frame refused; a stream of frames and garbage fed in random
+ * chunks, parsed to TLM_NEED_MORE and resumed, must give back exactly the
+ * frames sent, with single-byte corruptions and false 0xA5 headers in
+ * between. measure_temperatures_send() of 20_json_telemetry.c is checked in
+ * both formats and the frame size printed next to the JSON document.
+ * --emit writes TEMP and Z frames with text in between to stdout and the
+ * values of every frame to stderr; tools/test_tlm_decode.py decodes stdout
+ * and compares. --bench prints ns per frame for encode, parse and decode.
+ */
+#include <stdlib.h>
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+#define TEMP_ACQ_MAX 8u
+typedef struct {
+    uint32_t tick;
+    uint8_t  count, valid, addr[TEMP_ACQ_MAX];
+    int16_t  raw[TEMP_ACQ_MAX];
+} TempSnapshot_t;
+#define Z_POSITION_TEXT 1
+typedef struct {
+    char     position[32];
+    int32_t  position_um;
+    uint8_t  position_ok, referenced, busy, back, front, speed;
+} RemoteState_t;
+RemoteState_t remoteState;
+
+static TempSnapshot_t snap;
+static bool           snap_ok;
+bool temp_acq_latest(TempSnapshot_t *out)
+{
+    *out = snap;
+    return snap_ok;
+}
+
+static uint8_t  sent[512];
+static uint32_t sent_len;
+bool uart_log_write(const void *data, uint32_t n)
+{
+    memcpy(sent, data, n);
+    sent_len = n;
+    return true;
+}
+
+#include "../33_telemetry_frame.c"
+#include "../20_json_telemetry.c"
+
+static uint16_t crc16_bitwise(const uint8_t *p, size_t n)
+{
+    uint16_t crc = 0xFFFFu;
+    while (n--) {
+        crc ^= (uint16_t)(*p++ << 8);
+        for (int k = 0; k < 8; ++k) crc = (uint16_t)(crc & 0x8000u ? (crc << 1) ^ 0x1021u : (unsigned)crc << 1);
+    }
+    return crc;
+}
+
+static void check_crc(void)
+{
+    CHECK_EQ(tlm_crc16((const uint8_t *)"123456789", 9), 0x29B1);
+    CHECK_EQ(tlm_crc16(NULL, 0), 0xFFFF);
+    uint8_t buf[80];
+    for (int r = 0; r < 20000; ++r) {
+        size_t n = host_rand() % sizeof buf;
+        for (size_t i = 0; i < n; ++i) buf[i] = (uint8_t)host_rand();
+        CHECK_EQ(tlm_crc16(buf, n), crc16_bitwise(buf, n));
+    }
+}
+
+static TempSnapshot_t random_snapshot(void)
+{
+    TempSnapshot_t s = { .tick = host_rand(), .count = (uint8_t)(host_rand() % (TEMP_ACQ_MAX + 1u)) };
+    s.valid = (uint8_t)host_rand();
+    for (uint8_t j = 0; j < s.count; ++j) {
+        s.addr[j] = (uint8_t)host_rand();
+        s.raw[j] = (int16_t)host_rand();
+    }
+    return s;
+}
+
+static void check_temp_roundtrip(void)
+{
+    uint8_t f[TLM_FRAME_MAX];
+    for (int r = 0; r < 20000; ++r) {
+        TempSnapshot_t s = random_snapshot(), d;
+        size_t n = tlm_frame_temperatures(f, sizeof f, &s);
+        uint8_t valid = 0;
+        for (uint8_t j = 0; j < s.count; ++j) valid += (s.valid >> j) & 1u;
+        CHECK_EQ(n, TLM_HDR_LEN + 5u + 3u * valid + 2u);
+        for (size_t cap = 0; cap < n; cap += 1u + host_rand() % 7u) CHECK_EQ(tlm_frame_temperatures(f, cap, &s), 0);
+
+        TlmFrame_t fr;
+        size_t used;
+        CHECK_EQ(tlm_parse(f, n, &fr, &used), TLM_FRAME_OK);
+        CHECK_EQ(used, n);
+        CHECK(tlm_decode_temperatures(&fr, &d));
+        CHECK(!tlm_decode_z(&fr));
+        CHECK_EQ(d.tick, s.tick);
+        CHECK_EQ(d.count, valid);
+        CHECK_EQ(d.valid, (1u << valid) - 1u);
+        for (uint8_t j = 0, k = 0; j < s.count; ++j) {
+            if (!(s.valid & (1u << j))) continue;
+            CHECK_EQ(d.addr[k], s.addr[j]);
+            CHECK_EQ(d.raw[k], s.raw[j]);
+            k++;
+        }
+    }
+}
+
+static void check_z_roundtrip(void)
+{
+    static const int32_t edge[] = { 0, -1, 999, -1000, 12500, -12500, INT32_MAX, INT32_MIN };
+    uint8_t f[TLM_FRAME_MAX];
+    for (int r = 0; r < 20000; ++r) {
+        RemoteState_t st = { .position_um = r < 8 ? edge[r] : (int32_t)host_rand() >> (host_rand() % 32u) };
+        uint32_t b = host_rand();
+        st.position_ok = b & 1u;
+        st.referenced = b >> 1 & 1u;
+        st.busy = b >> 2 & 1u;
+        st.back = b >> 3 & 1u;
+        st.front = b >> 4 & 1u;
+        st.speed = (uint8_t)(b >> 8);
+        size_t n = tlm_frame_z(f, sizeof f, &st);
+        CHECK_EQ(n, TLM_HDR_LEN + 6u + 2u);
+        CHECK_EQ(tlm_frame_z(f, n - 1u, &st), 0);
+
+        TlmFrame_t fr;
+        size_t used;
+        TempSnapshot_t d;
+        memset(&remoteState, 0x5A, sizeof remoteState);
+        CHECK_EQ(tlm_parse(f, n, &fr, &used), TLM_FRAME_OK);
+        CHECK(!tlm_decode_temperatures(&fr, &d));
+        CHECK(tlm_decode_z(&fr));
+        CHECK_EQ(remoteState.position_um, st.position_um);
+        CHECK_EQ(remoteState.position_ok, st.position_ok);
+        CHECK_EQ(remoteState.referenced, st.referenced);
+        CHECK_EQ(remoteState.busy, st.busy);
+        CHECK_EQ(remoteState.back, st.back);
+        CHECK_EQ(remoteState.front, st.front);
+        CHECK_EQ(remoteState.speed, st.speed);
+        char want[32];
+        long long um = st.position_um, mag = um < 0 ? -um : um;
+        snprintf(want, sizeof want, "%s%lld.%03lld", um < 0 ? "-" : "", mag / 1000, mag % 1000);
+        CHECK(strcmp(remoteState.position, want) == 0);
+    }
+}
+
+/* One frame at every prefix: NEED_MORE without consuming; behind garbage:
+ * BAD up to the sync byte first */
+static void check_split(void)
+{
+    uint8_t f[TLM_FRAME_MAX + 8];
+    TempSnapshot_t s = { 7, 2, 3, { 73, 72 }, { 392, -9 } };
+    size_t n = tlm_frame_temperatures(f, sizeof f, &s);
+    TlmFrame_t fr;
+    size_t used;
+    for (size_t k = 0; k < n; ++k) {
+        CHECK_EQ(tlm_parse(f, k, &fr, &used), TLM_NEED_MORE);
+        CHECK_EQ(used, 0);
+    }
+
+    uint8_t g[3 + sizeof f] = { '{', 0x00, '#' };
+    memcpy(g + 3, f, n);
+    CHECK_EQ(tlm_parse(g, 3u + n - 1u, &fr, &used), TLM_BAD);
+    CHECK_EQ(used, 3);
+    CHECK_EQ(tlm_parse(g + used, n, &fr, &used), TLM_FRAME_OK);
+    CHECK_EQ(used, n);
+
+    /* Any single corrupted byte after the sync: BAD, one byte consumed */
+    for (size_t k = 1; k < n; ++k) {
+        memcpy(g, f, n);
+        g[k] ^= (uint8_t)(1u + host_rand() % 255u);
+        TlmParse_t r = tlm_parse(g, n, &fr, &used);
+        if (k == 3 && g[3] > s.count * 3u + 5u && g[3] <= TLM_MAX_PAYLOAD) {
+            CHECK_EQ(r, TLM_NEED_MORE);          /* longer length: waits for the rest */
+        } else {
+            CHECK_EQ(r, TLM_BAD);
+            CHECK_EQ(used, 1);
+        }
+    }
+}
+
+/* Frames, garbage and corrupted frames in one stream, fed in random chunks */
+static void check_stream(void)
+{
+    enum { FRAMES = 3000 };
+    static uint8_t  stream[FRAMES * (TLM_FRAME_MAX + 40)];
+    static uint32_t want_tick[FRAMES];
+    size_t len = 0, want_n = 0;
+    uint8_t f[TLM_FRAME_MAX];
+
+    for (int r = 0; r < FRAMES; ++r) {
+        uint32_t kind = host_rand() % 8u;
+        if (kind == 0) {                                  /* garbage with false headers */
+            for (uint32_t k = host_rand() % 40u; k; --k)
+                stream[len++] = host_rand() % 4u ? (uint8_t)host_rand() : TLM_SYNC;
+            if (host_rand() & 1u) {
+                stream[len++] = TLM_SYNC;
+                stream[len++] = TLM_VERSION;
+                stream[len++] = TLM_TYPE_TEMP;
+                stream[len++] = (uint8_t)(host_rand() % 8u);   /* short: ends inside the next frame */
+            }
+            continue;
+        }
+        TempSnapshot_t s = random_snapshot();
+        s.tick = (uint32_t)r;
+        size_t n = tlm_frame_temperatures(f, sizeof f, &s);
+        if (kind == 1) f[1u + host_rand() % (n - 1u)] ^= (uint8_t)(1u + host_rand() % 255u);
+        else want_tick[want_n++] = s.tick;
+        memcpy(stream + len, f, n);
+        len += n;
+    }
+
+    /* Receive buffer: append a chunk, parse until NEED_MORE, keep the rest */
+    static uint8_t rx[512];
+    size_t rx_n = 0, pos = 0, got = 0, bad = 0;
+    while (pos < len || rx_n) {
+        size_t chunk = 1u + host_rand() % 96u;
+        if (chunk > len - pos) chunk = len - pos;
+        if (chunk > sizeof rx - rx_n) chunk = sizeof rx - rx_n;
+        memcpy(rx + rx_n, stream + pos, chunk);
+        rx_n += chunk;
+        pos += chunk;
+
+        size_t off = 0, used;
+        TlmFrame_t fr;
+        TlmParse_t r;
+        while ((r = tlm_parse(rx + off, rx_n - off, &fr, &used)) != TLM_NEED_MORE) {
+            CHECK(used > 0);
+            off += used;
+            if (r == TLM_BAD) {
+                bad++;
+                continue;
+            }
+            TempSnapshot_t d;
+            CHECK(tlm_decode_temperatures(&fr, &d));
+            CHECK(got < want_n);
+            if (got < want_n) CHECK_EQ(d.tick, want_tick[got]);
+            got++;
+        }
+        memmove(rx, rx + off, rx_n - off);
+        rx_n -= off;
+        if (pos == len && chunk == 0) break;              /* a torn tail stays */
+    }
+    CHECK_EQ(got, want_n);
+    CHECK(bad > 0);
+    CHECK(rx_n < TLM_FRAME_MAX);
+}
+
+static void check_send(void)
+{
+    snap = (TempSnapshot_t){ 123456, 4, 0x0F, { 73, 72, 75, 79 }, { 392, -9, 0, 1601 } };
+    snap_ok = true;
+
+    CHECK_EQ(tlm_negotiate(2), TLM_FMT_JSON);             /* unknown version: keeps JSON */
+    CHECK(measure_temperatures_send());
+    size_t json = sent_len;
+    CHECK(sent[0] == '{');
+
+    CHECK_EQ(tlm_negotiate(TLM_VERSION), TLM_FMT_BINARY);
+    CHECK(measure_temperatures_send());
+    TlmFrame_t fr;
+    size_t used;
+    TempSnapshot_t d = {0};
+    CHECK_EQ(tlm_parse(sent, sent_len, &fr, &used), TLM_FRAME_OK);
+    CHECK_EQ(used, sent_len);
+    CHECK(tlm_decode_temperatures(&fr, &d));
+    CHECK(memcmp(&d, &snap, sizeof d) == 0);
+    CHECK(sent_len < json);
+    printf("4 sensors: frame %u bytes, JSON %u bytes\n", (unsigned)sent_len, (unsigned)json);
+    tlm_negotiate(0);
+}
+
+/* One line per frame: "T tick addr:raw ..." or "Z um ok ref busy back front speed" */
+static void emit_frames(void)
+{
+    static const uint8_t addrs[] = { 73, 72, 75, 79, 77, 78 };
+    uint8_t f[TLM_FRAME_MAX];
+    for (int r = 0; r < 60; ++r) {
+        size_t n;
+        printf("t%d:", r);
+        if (r % 4 == 3) {
+            uint32_t b = host_rand();
+            RemoteState_t st = { .position_um = (int32_t)host_rand() >> (host_rand() % 32u), .position_ok = b & 1u,
+                                 .referenced = b >> 1 & 1u, .busy = b >> 2 & 1u, .back = b >> 3 & 1u,
+                                 .front = b >> 4 & 1u, .speed = (uint8_t)(b >> 8) };
+            n = tlm_frame_z(f, sizeof f, &st);
+            fprintf(stderr, "Z %ld %u %u %u %u %u %u\n", (long)st.position_um, st.position_ok, st.referenced,
+                    st.busy, st.back, st.front, st.speed);
+        } else {
+            TempSnapshot_t s = { .tick = host_rand(), .count = sizeof addrs, .valid = (uint8_t)host_rand() };
+            fprintf(stderr, "T %lu", (unsigned long)s.tick);
+            for (uint8_t j = 0; j < s.count; ++j) {
+                s.addr[j] = addrs[j];
+                s.raw[j] = (int16_t)(host_rand() % 4096u) - 2048;
+                if (s.valid >> j & 1u) fprintf(stderr, " %u:%d", s.addr[j], s.raw[j]);
+            }
+            fprintf(stderr, "\n");
+            n = tlm_frame_temperatures(f, sizeof f, &s);
+        }
+        fwrite(f, 1, n, stdout);
+    }
+    printf("tail text\n");
+}
+
+static void bench(void)
+{
+    enum { N = 2000000 };
+    uint8_t f[TLM_FRAME_MAX];
+    TempSnapshot_t d;
+    uint64_t t0 = host_ns();
+    for (int i = 0; i < N; ++i) {
+        snap.raw[i & 3] = (int16_t)i;
+        TlmFrame_t fr;
+        size_t used, n = tlm_frame_temperatures(f, sizeof f, &snap);
+        if (tlm_parse(f, n, &fr, &used) == TLM_FRAME_OK && tlm_decode_temperatures(&fr, &d)) host_sink += d.tick;
+    }
+    printf("TEMP frame encode + parse + decode: %.1f ns on the host\n", (double)(host_ns() - t0) / N);
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--emit") == 0) {
+            emit_frames();
+            return 0;
+        }
+    }
+    check_crc();
+    check_temp_roundtrip();
+    check_z_roundtrip();
+    check_split();
+    check_stream();
+    check_send();
+    if (host_bench(argc, argv)) bench();
+    return host_result("test_33_telemetry_frame");
+}
@@ -0,0 +1,175 @@
+/* Host test for 34_input_events.c: a bouncing button on a 50 us time grid.
+ * Every press and release bounces for up to ~15 ms, some holds have short
+ * dropouts (the contact opens for 0.2..1.5 ms, caught by one tick sample or
+ * none), the tick runs across the HAL_GetTick() wrap. The EXTI fires on an
+ * edge only while its IMR bit is set. Checks:
+ * - exactly PRESS [LONG] RELEASE per press, never a dropout event;
+ * - PRESS and LONG carry the first edge of the press, RELEASE the first tick
+ *   sample that saw the contact open, dropouts do not move either;
+ * - LONG arrives INPUT_LONG_MS after the press edge, dropouts or not;
+ * - one EXTI interrupt per press, nothing sampled while no button is busy.
+ */
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+void uart_log_init(UART_HandleTypeDef *huart) { (void)huart; }
+void uart_log_tx_complete(void) { }
+void uart_log_tx_error(void) { }
+
+#define main input34_main
+#include "../34_input_events.c"
+#undef main
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin)
+{
+    return (port->IDR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+void HAL_GPIO_TogglePin(GPIO_TypeDef *port, uint16_t pin) { port->ODR ^= pin; }
+void HAL_GPIO_EXTI_IRQHandler(uint16_t pin) { HAL_GPIO_EXTI_Callback(pin); }
+
+#define STEP_US    50u
+#define TICK0      (0xFFFFFFFFu - 20000u)   /* wraps 20 s in */
+#define MAX_PRESS  300
+#define MAX_TR     (MAX_PRESS * 48)
+
+/* Contact script: the contact is closed (pressed) from t_us on, or open */
+typedef struct { uint64_t t_us; uint8_t closed; } Transition_t;
+static Transition_t tr[MAX_TR];
+static uint32_t     tr_n;
+
+typedef struct {
+    uint64_t press_us, release_us;
+    bool     long_press;
+    uint32_t release_tick;             /* found while simulating */
+} Press_t;
+static Press_t  presses[MAX_PRESS];
+static uint32_t press_n;
+
+static uint64_t rand_us(uint32_t lo, uint32_t hi)
+{
+    return (lo + host_rand() % (hi - lo + 1u)) / STEP_US * STEP_US;
+}
+
+static void add(uint64_t t, uint8_t closed)
+{
+    CHECK(tr_n < MAX_TR && t % STEP_US == 0 && (tr_n == 0 || t > tr[tr_n - 1].t_us));
+    tr[tr_n++] = (Transition_t){ t, closed };
+}
+
+/* First edge at t, up to 8 bounces of 50..900 us each way; returns the end */
+static uint64_t bounce(uint64_t t, uint8_t closed)
+{
+    add(t, closed);
+    for (uint32_t k = host_rand() % 9u; k; --k) {
+        t += rand_us(STEP_US, 900);
+        add(t, !closed);
+        t += rand_us(STEP_US, 900);
+        add(t, closed);
+    }
+    return t;
+}
+
+/* A press at t held for hold_us, with 'drops' dropouts inside the hold;
+ * returns when the line is quiet and unmasked again */
+static uint64_t add_press(uint64_t t, uint64_t hold_us, uint32_t drops)
+{
+    Press_t *p = &presses[press_n++];
+    *p = (Press_t){ .press_us = t, .release_us = t + hold_us, .long_press = hold_us >= 900000u };
+    bounce(t, 1);
+    uint64_t slot = (hold_us - 80000u) / (drops ? drops : 1u) / STEP_US * STEP_US;
+    for (uint32_t d = 0; d < drops; ++d) {
+        uint64_t at = t + 40000u + d * slot + rand_us(0, (uint32_t)slot - 2000u);
+        add(at, 0);
+        add(at + rand_us(200, 1500), 1);
+    }
+    return bounce(p->release_us, 0) + INPUT_DEBOUNCE_MS * 1000u + rand_us(20000, 400000);
+}
+
+typedef struct { InputEvent_t ev; uint32_t at; } Got_t;
+static Got_t    got[MAX_PRESS * 3 + 8];
+static uint32_t got_n;
+
+/* Runs the script: SysTick every ms (tick, sample, main loop drains the
+ * queue), then the contact changes of this step and their EXTI */
+static void simulate(uint64_t end_us)
+{
+    uint32_t next = 0, cur = 0;
+    for (uint64_t t = 0; t <= end_us; t += STEP_US) {
+        if (t % 1000u == 0 && t) {
+            SysTick_Handler();
+            bool open = GPIOA->IDR & GPIO_PIN_0;
+            while (cur < press_n && presses[cur].release_tick) cur++;
+            if (cur < press_n && t >= presses[cur].release_us && open) presses[cur].release_tick = HAL_GetTick();
+            InputEvent_t ev;
+            while (input_poll(&ev)) {
+                CHECK(got_n < sizeof got / sizeof got[0]);
+                if (got_n < sizeof got / sizeof got[0]) got[got_n++] = (Got_t){ ev, HAL_GetTick() };
+            }
+        }
+        for (; next < tr_n && tr[next].t_us == t; ++next) {
+            uint32_t idr = tr[next].closed ? 0u : GPIO_PIN_0;      /* active low */
+            if ((GPIOA->IDR & GPIO_PIN_0) == idr) continue;
+            GPIOA->IDR = idr;
+            if (EXTI->IMR & GPIO_PIN_0) EXTI0_IRQHandler();
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    MX_USART2_UART_Init();
+    CHECK(huart2.hdmatx == &hdma_usart2_tx && hdma_usart2_tx.Parent == &huart2);
+    uwTick = TICK0;
+    GPIOA->IDR = GPIO_PIN_0;                            /* pull-up, open */
+    EXTI->IMR = GPIO_PIN_0;
+
+    /* The review case: held 1.5 s, a 1 ms dropout 300 ms in */
+    uint64_t t = 100000u + 350u;
+    presses[0] = (Press_t){ .press_us = t, .release_us = t + 1500000u, .long_press = true };
+    press_n = 1;
+    add(t, 1);
+    add(t + 300000u, 0);
+    add(t + 301000u, 1);
+    add(t + 1500000u, 0);
+    t += 2000000u;
+
+    while (press_n < MAX_PRESS) {
+        uint64_t hold = host_rand() & 1u ? rand_us(900000, 2500000) : rand_us(100000, 700000);
+        t = add_press(t, hold, host_rand() % 4u);
+    }
+    simulate(t + 1000000u);
+
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < press_n && k < got_n; ++i) {
+        const Press_t *p = &presses[i];
+        uint32_t press_tick = TICK0 + (uint32_t)(p->press_us / 1000u);
+        CHECK_EQ(got[k].ev.type, INPUT_PRESS);
+        CHECK_EQ(got[k].ev.t_ms, press_tick);
+        if (p->long_press && ++k < got_n) {
+            CHECK_EQ(got[k].ev.type, INPUT_LONG);
+            CHECK_EQ(got[k].ev.t_ms, press_tick);
+            CHECK_EQ(got[k].at, press_tick + INPUT_LONG_MS);
+        }
+        if (++k < got_n) {
+            CHECK_EQ(got[k].ev.type, INPUT_RELEASE);
+            CHECK_EQ(got[k].ev.t_ms, p->release_tick);
+            CHECK(p->release_tick - TICK0 >= p->release_us / 1000u);
+        }
+        k++;
+    }
+    CHECK_EQ(k, got_n);
+    CHECK_EQ(input_exti_irqs, press_n);
+    CHECK_EQ(input_dropped, 0);
+    CHECK_EQ(input_busy_mask, 0);
+    CHECK(EXTI->IMR & GPIO_PIN_0);
+
+    /* Idle: the tick returns at the first test */
+    uint32_t samples = input_samples;
+    for (int i = 0; i < 1000; ++i) SysTick_Handler();
+    CHECK_EQ(input_samples, samples);
+
+    printf("%u presses, %u events, %u EXTI irqs, %u tick samples\n", (unsigned)press_n, (unsigned)got_n,
+           (unsigned)input_exti_irqs, (unsigned)input_samples);
+    return host_result("test_34_input_events");
+}
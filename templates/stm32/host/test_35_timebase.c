@@ -0,0 +1,135 @@
+/* Host test for 35_timebase.c on a virtual 64-bit core clock, TB_CYCLES() its
+ * low 32 bits. The core runs 40 ppm fast against the RTC; the RTC second
+ * starts mid-way between two core cycles, its SQW edge calls tb_on_second()
+ * (TB_SQW 1), tb_service() runs every millisecond. tb_now_us() and tb_now_s()
+ * are read every few microseconds and must never go back. Checks:
+ * - locked, tb_now_us() is within 10 us (SQW) or 1.1 ms (polling) of the RTC,
+ *   across the 32-bit counter wrap;
+ * - no edge and no tb_service() for 1.5 * 2^31 cycles: tb_now_us() holds at
+ *   .999999 instead of dropping to .000000, then catches up;
+ * - an RTC read below the published second is never published (counted in
+ *   tb_rtc_behind), one above it is; with polling, an RTC set back holds the
+ *   time until the RTC has caught up.
+ * test_35_timebase_poll.c builds the same with TB_SQW 0.
+ */
+#include "host_test.h"
+#include "stm32xx_hal.h"
+
+static uint64_t vcyc;
+#define TB_CYCLES()    ((uint32_t)vcyc)
+#define TB_NOMINAL_CPS 168000000u
+#include "../35_timebase.c"
+
+#ifndef TEST_NAME
+#define TEST_NAME "test_35_timebase"
+#endif
+
+#define RTC_CPS   168006720ull              /* core cycles per RTC second: 40 ppm fast */
+#define RTC_T0    800000000u                /* 2025-05-08 */
+#define RTC_PHASE 62000037ull               /* the RTC is this far into its second at vcyc 0 */
+
+static int32_t  rtc_offset;                 /* what tb_rtc_read() adds to the true second */
+static int32_t  expect_offset;              /* what tb_now_us() should add to it */
+static bool     sqw_on = true, svc_on = true, check_err;
+static uint64_t last_us;
+static uint32_t last_s, max_err;
+
+static uint32_t true_s(void) { return RTC_T0 + (uint32_t)((vcyc + RTC_PHASE) / RTC_CPS); }
+static uint64_t true_us(void)
+{
+    uint64_t t = vcyc + RTC_PHASE;
+    return (uint64_t)(RTC_T0 + t / RTC_CPS) * 1000000u + t % RTC_CPS * 1000000u / RTC_CPS;
+}
+
+bool tb_rtc_read(TbCivil_t *t)
+{
+    tb_to_civil((uint32_t)((int32_t)true_s() + rtc_offset), t);
+    return true;
+}
+
+static void check(void)
+{
+    uint64_t us = tb_now_us();
+    uint32_t s = tb_now_s();
+    CHECK(us >= last_us);
+    CHECK(s >= last_s);
+    last_us = us;
+    last_s = s;
+    if (!check_err) return;
+    int64_t err = (int64_t)us - (int64_t)(true_us() + (int64_t)expect_offset * 1000000);
+    uint32_t e = (uint32_t)(err < 0 ? -err : err);
+    if (e > max_err) max_err = e;
+    CHECK(e < (TB_SQW ? 10u : 1100u));
+}
+
+/* Runs the clock for 'cycles': SQW edges, tb_service() every ms, checks
+ * every 'chk' cycles */
+static void run(uint64_t cycles, uint64_t chk)
+{
+    uint64_t end = vcyc + cycles;
+    uint64_t next_chk = vcyc + chk;
+    uint64_t next_svc = vcyc - vcyc % 168000u + 168000u;
+    while (vcyc < end) {
+        uint64_t next_edge = (vcyc + RTC_PHASE) / RTC_CPS * RTC_CPS + RTC_CPS - RTC_PHASE;
+        uint64_t t = next_edge < next_svc ? next_edge : next_svc;
+        if (next_chk < t) t = next_chk;
+        if (end < t) t = end;
+        vcyc = t;
+        if (t == next_edge && TB_SQW && sqw_on) tb_on_second();
+        if (t == next_svc) {
+            if (svc_on) tb_service();
+            next_svc += 168000u;
+        }
+        if (t == next_chk) {
+            check();
+            next_chk += chk + host_rand() % 64u;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    tb_init();
+    CHECK_EQ(tb_now_s(), RTC_T0);
+    run(3 * RTC_CPS, 997);                          /* lock, first resync, poll window */
+    check_err = true;
+    run(30 * RTC_CPS, 997);                         /* wraps TB_CYCLES() */
+
+    /* SQW line lost and the main loop blocked for 1.5 * 2^31 cycles */
+    check_err = false;
+    sqw_on = svc_on = false;
+    uint32_t held = tb_now_s();
+    run(3ull << 30, 1u << 20);
+    CHECK_EQ(tb_now_us(), (uint64_t)held * 1000000u + 999999u);
+    sqw_on = svc_on = true;
+    run((TB_SQW ? 3 : 8) * RTC_CPS, 997);          /* polling: the window widens again first */
+    check_err = true;
+    run(3 * RTC_CPS, 997);
+
+    /* RTC behind the count: never published, the time keeps going */
+    rtc_offset = -2;
+    tb_resync = 1;
+    check_err = TB_SQW;
+    run(3 * RTC_CPS, 997);
+    CHECK(tb_rtc_behind > 0);
+#if TB_SQW
+    /* RTC ahead: published at the next resync */
+    rtc_offset = 3;
+    tb_resync = 1;
+    check_err = false;
+    run(2 * RTC_CPS, 997);
+    expect_offset = 3;
+    check_err = true;
+    run(3 * RTC_CPS, 997);
+#else
+    /* Set back for good: held until it caught up, then followed */
+    run(3 * RTC_CPS, 997);
+    expect_offset = -2;
+    check_err = true;
+    run(5 * RTC_CPS, 997);
+#endif
+
+    printf("max error %u us, %u RTC reads behind\n", (unsigned)max_err, (unsigned)tb_rtc_behind);
+    return host_result(TEST_NAME);
+}
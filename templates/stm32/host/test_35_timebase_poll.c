@@ -0,0 +1,4 @@
+/* test_35_timebase.c without the SQW line: tb_service() polls the RTC */
+#define TB_SQW    0
+#define TEST_NAME "test_35_timebase_poll"
+#include "test_35_timebase.c"
@@ -0,0 +1,222 @@
+/* Fuzz harness and benchmark for the host build of help_functions.c (the file
+ * "-" at the repository root), with main.h, ds3231.h and tmp1075.h from this
+ * folder standing in for the project headers.
+ *
+ * fuzz_one() takes any byte string and:
+ * - runs strip_T_after_chevron(), sanitize_command() and normalize_command()
+ *   on an exact-size heap copy without a terminator, so ASan reports any read
+ *   past buf_size, and checks strip_T_after_chevron() against a reference;
+ * - on a terminated copy, checks normalize_command() against
+ *   sanitize_command() + strip_T_after_chevron();
+ * - parses it as a Z frame: no crash, position_ok only inside the limits.
+ * measure_temperatures() is checked once: blocking reads with HAL_Delay(10)
+ * each, or with TEMP_ACQ_CACHED 1 (test_help_functions_cached.c) the cached
+ * document, no sensor read and no delay.
+ *
+ * libFuzzer (clang):
+ *   clang -g -O1 -fsanitize=fuzzer,address,undefined -DHOST_LIBFUZZER \
+ *       -I templates/stm32/host templates/stm32/host/test_help_functions.c \
+ *       templates/stm32/host/hal_stub.c -o fuzz_help && ./fuzz_help corpus/
+ * gcc (tools/host_tests.py): main() replays the files given on the command
+ * line, else every string up to 5 bytes over the bytes that matter plus
+ * 300000 random ones. --bench times the functions of the -O2 build.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "../../../help_functions.h"
+
+#ifndef TEST_NAME
+#define TEST_NAME "test_help_functions"
+#endif
+
+RemoteState_t      remoteState;
+TIM_HandleTypeDef  htim9;
+UART_HandleTypeDef huart2;
+
+static char     log_last[256];
+static uint32_t tmp_reads;
+bool  uart_log_write(const void *data, uint32_t n)
+{
+    if (n < sizeof log_last) {
+        memcpy(log_last, data, n);
+        log_last[n] = '\0';
+    }
+    return n != 0;
+}
+void  DS3231_get(DS_TIME *t) { *t = (DS_TIME){ 12, 34, 56, 1, 2, 25 }; }
+float TMP1075_Get_Temperature_Celsius(uint8_t addr) { tmp_reads++; return addr / 4.0f; }
+#if TEMP_ACQ_CACHED
+#define CACHED_DOC "{\"temp_system\":21.5}\r\n"
+size_t measure_temperatures_cached(char *json_out, size_t out_size)
+{
+    return (size_t)snprintf(json_out, out_size, "%s", CACHED_DOC);
+}
+#endif
+int   print_number_or_float(UART_HandleTypeDef *huart, float val, const char *label, int width, int prec,
+                            const char *suffix, char *out, size_t out_sz, int also_print)
+{
+    (void)huart; (void)also_print;
+    return snprintf(out, out_sz, "%s%*.*f%s", label, width, prec, (double)val, suffix);
+}
+
+#include "../../../-"
+
+/* strip_T_after_chevron() by its contract, on a copy */
+static size_t ref_strip(const uint8_t *in, size_t size, char *out)
+{
+    size_t len = strnlen((const char *)in, size), n = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (i == 1 && size >= 2 && in[0] == '>' && in[1] == 'T') continue;
+        out[n++] = (char)in[i];
+    }
+    return n;
+}
+
+static void fuzz_one(const uint8_t *data, size_t size)
+{
+    if (size == 0 || size > 4096) return;
+    char *buf = malloc(size), *want = malloc(size + 1);
+
+    /* Exact size, maybe unterminated */
+    memcpy(buf, data, size);
+    size_t want_n = ref_strip(data, size, want);
+    bool stripped = size >= 2 && data[0] == '>' && data[1] == 'T';
+    strip_T_after_chevron(buf, size);
+    if (stripped) {
+        CHECK_EQ(strnlen(buf, size), want_n);            /* terminated now */
+        CHECK(memcmp(buf, want, want_n) == 0);
+    } else {
+        CHECK(memcmp(buf, data, size) == 0);             /* untouched */
+    }
+    memcpy(buf, data, size);
+    sanitize_command(buf, size);
+    memcpy(buf, data, size);
+    CHECK(normalize_command(buf, size) < size);
+    free(buf);
+
+    /* Terminated: fused against the two-step version */
+    char *a = malloc(size + 1), *b = malloc(size + 1);
+    memcpy(a, data, size);
+    a[size] = '\0';
+    memcpy(b, a, size + 1);
+    sanitize_command(a, size + 1);
+    strip_T_after_chevron(a, size + 1);
+    size_t n = normalize_command(b, size + 1);
+    CHECK(strcmp(a, b) == 0);
+    CHECK_EQ(n, strlen(b));
+
+    /* Z frame */
+    memcpy(a, data, size);
+    parse_z_frame(a);
+    if (remoteState.position_ok)
+        CHECK(remoteState.position_um >= Z_POS_MIN_UM && remoteState.position_um <= Z_POS_MAX_UM);
+    CHECK_EQ(host_primask, 0);
+    free(a);
+    free(b);
+    free(want);
+}
+
+#ifdef HOST_LIBFUZZER
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_one(data, size);
+    if (host_failures) abort();                          /* report as a crash */
+    return 0;
+}
+#else
+
+static void replay(const char *path)
+{
+    static uint8_t data[4096];
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        host_failures++;
+        return;
+    }
+    size_t n = fread(data, 1, sizeof data, f);
+    fclose(f);
+    fuzz_one(data, n);
+}
+
+static void generate(void)
+{
+    static const uint8_t small[] = ">T#Z\r\n\0M";
+    uint8_t s[8];
+    for (size_t len = 1; len <= 5; ++len) {
+        size_t total = 1;
+        for (size_t i = 0; i < len; ++i) total *= sizeof small;
+        for (size_t k = 0; k < total; ++k) {
+            size_t v = k;
+            for (size_t i = 0; i < len; ++i, v /= sizeof small) s[i] = small[v % sizeof small];
+            fuzz_one(s, len);
+        }
+    }
+
+    static const char bias[] = ">TZ#\r\n{}\"prbouv:,.-+0123456789 ";
+    uint8_t r[64];
+    for (int i = 0; i < 300000; ++i) {
+        size_t len = 1 + host_rand() % sizeof r;
+        for (size_t j = 0; j < len; ++j)
+            r[j] = (host_rand() & 7u) ? (uint8_t)bias[host_rand() % (sizeof bias - 1)] : (uint8_t)host_rand();
+        if (i & 1) memcpy(r, ">T", len < 2 ? len : 2);
+        fuzz_one(r, len);
+    }
+}
+
+static void check_measure(void)
+{
+    uint8_t addr[] = { 73, 72 };
+    char json[160];
+    uint32_t t0 = uwTick;
+    log_last[0] = '\0';
+    measure_temperatures(1, json, sizeof json, 2, addr);
+#if TEMP_ACQ_CACHED
+    CHECK_EQ(tmp_reads, 0);
+    CHECK_EQ(uwTick - t0, 0);
+    CHECK(strcmp(json, CACHED_DOC) == 0);
+#else
+    CHECK_EQ(tmp_reads, 2);
+    CHECK_EQ(uwTick - t0, 20);                      /* HAL_Delay(10) per sensor */
+    CHECK(strncmp(json, "{\"temp_system\":18.", 17) == 0 && strstr(json, "\"temp_drivers\":18.0,"));
+#endif
+    CHECK(strcmp(log_last, json) == 0);
+}
+
+static void bench(void)
+{
+    enum { N = 2000000 };
+    static const char *cmds[] = { ">TMA090.000#", "\r\nTZ#", ">SP1500#", "\n>TMR-12.5#" };
+    static const char frame[] = "{\"p\":12.500,\"r\":1,\"b\":0,\"o\":0,\"u\":1,\"v\":40}";
+    char buf[32];
+    const char *names[] = { "strip_T_after_chevron", "sanitize + strip", "normalize_command", "parse_z_frame" };
+    for (int f = 0; f < 4; ++f) {
+        uint64_t t0 = host_ns();
+        for (int i = 0; i < N; ++i) {
+            strcpy(buf, cmds[i & 3]);
+            if (f == 0) strip_T_after_chevron(buf, sizeof buf);
+            else if (f == 1) { sanitize_command(buf, sizeof buf); strip_T_after_chevron(buf, sizeof buf); }
+            else if (f == 2) normalize_command(buf, sizeof buf);
+            else parse_z_frame(frame);
+            host_sink += (uint8_t)buf[1] + remoteState.speed;
+        }
+        printf("%-22s %6.1f ns per call on the host (copy of the command included)\n", names[f],
+               (double)(host_ns() - t0) / N);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool files = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--bench") == 0) continue;
+        replay(argv[i]);
+        files = true;
+    }
+    if (!files) generate();
+    check_measure();
+    if (host_bench(argc, argv)) bench();
+    return host_result(TEST_NAME);
+}
+#endif
@@ -0,0 +1,4 @@
+/* test_help_functions.c with measure_temperatures() on the cached snapshot */
+#define TEMP_ACQ_CACHED 1
+#define TEST_NAME       "test_help_functions_cached"
+#include "test_help_functions.c"
@@ -0,0 +1,9 @@
+/* Host stand-in for the TMP1075 driver header; the test defines the reader */
+#ifndef TMP1075_H
+#define TMP1075_H
+
+#include <stdint.h>
+
+float TMP1075_Get_Temperature_Celsius(uint8_t addr);
+
+#endif /* TMP1075_H */
@@ -0,0 +1,3 @@
+/* help_functions.c includes "uart_log.h" from the project root; the header
+ * lives next to the templates */
+#include "../uart_log.h"
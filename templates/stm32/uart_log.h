@@ -0,0 +1,20 @@
+/* Buffered, DMA-backed printf retarget, implemented in 21_uart_log.c.
+ * The logger is the only user of the log UART's TX DMA: everything that sends
+ * on that UART goes through __io_putchar() (printf) or uart_log_write().
+ */
+#ifndef UART_LOG_H
+#define UART_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32xx_hal.h" // replace with your series header
+
+void uart_log_init(UART_HandleTypeDef *huart);
+int  __io_putchar(int ch);
+bool uart_log_write(const void *data, uint32_t n);  // block, sent unsplit; false if dropped
+void uart_log_tx_complete(void);                     // from HAL_UART_TxCpltCallback
+void uart_log_tx_error(void);                        // from HAL_UART_ErrorCallback
+void uart_log_flush(void);
+bool uart_log_idle(void);                            // nothing buffered, nothing on the wire
+
+#endif /* UART_LOG_H */
@@ -5,8 +5,6 @@ library ieee;
 use ieee.std_logic_1164.all;
 use ieee.numeric_std.all;
 
-type state_t is (S0, S1, S2);
-
 entity moore_fsm is
   port (
     clk, rst : in  std_logic;
@@ -16,6 +14,7 @@ entity moore_fsm is
 end entity;
 
 architecture rtl of moore_fsm is
+  type state_t is (S0, S1, S2);
   signal st, st_n : state_t := S0;
 begin
   -- state register
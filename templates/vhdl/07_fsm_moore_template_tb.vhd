@@ -0,0 +1,55 @@
+-- 07_fsm_moore_template_tb.vhd
+-- Purpose: Self-checking testbench for moore_fsm
+-- Notes: o must be '1' exactly when i was '1' at the last two clock edges
+--        since reset; stimulus from an LFSR, checked on every falling edge
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+entity moore_fsm_tb is
+  generic (
+    CYCLES : natural := 100000
+  );
+end entity;
+
+architecture sim of moore_fsm_tb is
+  signal clk  : std_logic := '0';
+  signal rst  : std_logic := '1';
+  signal i    : std_logic := '0';
+  signal o    : std_logic;
+  signal done : boolean := false;
+begin
+  dut : entity work.moore_fsm(rtl)
+    port map (clk => clk, rst => rst, i => i, o => o);
+
+  clk <= not clk after 5 ns when not done;
+
+  stim : process
+    variable lfsr : unsigned(15 downto 0) := x"ACE1";
+    variable ones : natural := 0; -- consecutive '1' samples since reset
+    variable exp  : std_logic;
+  begin
+    wait until falling_edge(clk); -- first edge applies the reset
+    for c in 1 to CYCLES loop
+      if ones >= 2 then exp := '1'; else exp := '0'; end if;
+      assert o = exp
+        report "cycle " & integer'image(c) & ": o=" & std_logic'image(o) &
+               " after " & integer'image(ones) & " ones" severity error;
+
+      lfsr := lfsr(14 downto 0) & (lfsr(15) xor lfsr(13) xor lfsr(12) xor lfsr(10));
+      if lfsr(15 downto 9) = 0 then -- occasional reset
+        rst <= '1';
+        ones := 0;
+      else
+        rst <= '0';
+        i <= lfsr(0) or lfsr(1); -- mostly ones: reach and hold S2
+        if (lfsr(0) or lfsr(1)) = '1' then ones := ones + 1; else ones := 0; end if;
+      end if;
+      wait until falling_edge(clk);
+    end loop;
+    report "moore_fsm_tb: " & integer'image(CYCLES) & " cycles";
+    done <= true;
+    wait;
+  end process;
+end architecture;
@@ -1,38 +1,69 @@
 -- 08_modn_counter.vhd
 -- Purpose: Parameterizable mod-N counter with enable and synchronous reset
+-- Notes: cnt/q are ceil_log2(N) bits (4 for N=10), from 10_utils_pkg.vhd.
+--        PIPELINE_TC registers the terminal count one clock ahead, so the wrap
+--        mux is driven by a flip-flop instead of a full-width compare.
 
 library ieee;
 use ieee.std_logic_1164.all;
 use ieee.numeric_std.all;
+use work.utils_pkg.all;
 
 entity modn_counter is
   generic (
-    N : natural := 10 -- modulus
+    N           : positive := 10;   -- modulus, at least 2
+    PIPELINE_TC : boolean  := false -- registered terminal count for high clock rates
   );
   port (
     clk : in  std_logic;
     rst : in  std_logic; -- synchronous active-high
     en  : in  std_logic;
-    q   : out unsigned(31 downto 0)
+    q   : out unsigned(ceil_log2(N)-1 downto 0)
   );
 end entity;
 
 architecture rtl of modn_counter is
-  signal cnt : unsigned(31 downto 0) := (others => '0');
+  signal cnt : unsigned(q'range) := (others => '0');
+  signal tc  : std_logic := '0'; -- cnt = N-1, registered (PIPELINE_TC)
 begin
-  process(clk)
-  begin
-    if rising_edge(clk) then
-      if rst='1' then
-        cnt <= (others => '0');
-      elsif en='1' then
-        if to_integer(cnt) = N-1 then
+  assert N >= 2 report "modn_counter: N must be at least 2" severity failure;
+
+  g_comb : if not PIPELINE_TC generate
+    process(clk)
+    begin
+      if rising_edge(clk) then
+        if rst='1' then
+          cnt <= (others => '0');
+        elsif en='1' then
+          if cnt = N-1 then
+            cnt <= (others => '0');
+          else
+            cnt <= cnt + 1;
+          end if;
+        end if;
+      end if;
+    end process;
+  end generate;
+
+  g_pipe : if PIPELINE_TC generate
+    process(clk)
+    begin
+      if rising_edge(clk) then
+        if rst='1' then
           cnt <= (others => '0');
-        else
-          cnt <= cnt + 1;
+          tc  <= '0';
+        elsif en='1' then
+          if tc='1' then
+            cnt <= (others => '0');
+            tc  <= '0';
+          else
+            cnt <= cnt + 1;
+            if cnt = N-2 then tc <= '1'; end if; -- next value is N-1
+          end if;
         end if;
       end if;
-    end if;
-  end process;
+    end process;
+  end generate;
+
   q <= cnt;
 end architecture;
@@ -0,0 +1,57 @@
+-- 08_modn_counter_tb.vhd
+-- Purpose: Self-checking testbench for modn_counter
+-- Notes: random enable and occasional reset from an LFSR, q compared with a
+--        reference count on every falling edge
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use work.utils_pkg.all;
+
+entity modn_counter_tb is
+  generic (
+    N           : positive := 10;
+    PIPELINE_TC : boolean  := false;
+    CYCLES      : natural  := 100000
+  );
+end entity;
+
+architecture sim of modn_counter_tb is
+  signal clk  : std_logic := '0';
+  signal rst  : std_logic := '1';
+  signal en   : std_logic := '0';
+  signal q    : unsigned(ceil_log2(N)-1 downto 0);
+  signal done : boolean := false;
+begin
+  dut : entity work.modn_counter(rtl)
+    generic map (N => N, PIPELINE_TC => PIPELINE_TC)
+    port map (clk => clk, rst => rst, en => en, q => q);
+
+  clk <= not clk after 5 ns when not done;
+
+  stim : process
+    variable lfsr  : unsigned(15 downto 0) := x"ACE1";
+    variable model : natural := 0;
+  begin
+    wait until falling_edge(clk); -- first edge applies the reset
+    for c in 1 to CYCLES loop
+      assert to_integer(q) = model
+        report "cycle " & integer'image(c) & ": q=" & integer'image(to_integer(q)) &
+               " expected " & integer'image(model) severity error;
+
+      lfsr := lfsr(14 downto 0) & (lfsr(15) xor lfsr(13) xor lfsr(12) xor lfsr(10));
+      if lfsr(15 downto 9) = 0 then -- occasional reset
+        rst <= '1';
+        model := 0;
+      else
+        rst <= '0';
+        en <= lfsr(0) or lfsr(1); -- enabled 3 cycles out of 4
+        if (lfsr(0) or lfsr(1)) = '1' then model := (model + 1) mod N; end if;
+      end if;
+      wait until falling_edge(clk);
+    end loop;
+    report "modn_counter_tb: " & integer'image(CYCLES) & " cycles";
+    done <= true;
+    wait;
+  end process;
+end architecture;
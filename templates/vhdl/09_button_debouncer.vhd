@@ -1,14 +1,18 @@
 -- 09_button_debouncer.vhd
 -- Purpose: Synchronizer + debounce filter for a push button
--- Notes: Two flip-flop synchronizer, then counter-based stable detection
+-- Notes: Two flip-flop synchronizer, then counter-based stable detection.
+--        cnt is ceil_log2(CNT_MAX+1) bits (16 for 50000) instead of 32;
+--        PIPELINE_TC registers cnt = CNT_MAX one clock ahead for high clock rates.
 
 library ieee;
 use ieee.std_logic_1164.all;
 use ieee.numeric_std.all;
+use work.utils_pkg.all;
 
 entity button_debouncer is
   generic (
-    CNT_MAX : natural := 50000 -- adjust to clock speed and desired debounce time
+    CNT_MAX     : positive := 50000; -- adjust to clock speed and desired debounce time
+    PIPELINE_TC : boolean  := false  -- registered terminal count, same timing
   );
   port (
     clk   : in  std_logic;
@@ -20,8 +24,9 @@ end entity;
 
 architecture rtl of button_debouncer is
   signal s1, s2 : std_logic := '0';
-  signal cnt    : unsigned(31 downto 0) := (others => '0');
+  signal cnt    : unsigned(ceil_log2(CNT_MAX+1)-1 downto 0) := (others => '0');
   signal stable : std_logic := '0';
+  signal tc     : boolean := false; -- cnt = CNT_MAX
 begin
   -- 2FF synchronizer
   process(clk)
@@ -32,6 +37,24 @@ begin
     end if;
   end process;
 
+  -- Terminal count: compare in the same clock, or registered one clock ahead
+  g_comb : if not PIPELINE_TC generate
+    tc <= (cnt = CNT_MAX);
+  end generate;
+
+  g_pipe : if PIPELINE_TC generate
+    process(clk)
+    begin
+      if rising_edge(clk) then
+        if rst='1' or s2 = stable or tc then
+          tc <= false;
+        else
+          tc <= (cnt = CNT_MAX-1);       -- cnt + 1 reaches CNT_MAX
+        end if;
+      end if;
+    end process;
+  end generate;
+
   -- Debounce counter
   process(clk)
   begin
@@ -43,7 +66,7 @@ begin
         if s2 = stable then
           cnt <= (others => '0');
         else
-          if cnt = to_unsigned(CNT_MAX, cnt'length) then
+          if tc then
             stable <= s2;
             cnt <= (others => '0');
           else
@@ -0,0 +1,77 @@
+-- 09_button_debouncer_tb.vhd
+-- Purpose: Self-checking testbench for button_debouncer
+-- Notes: btn_i toggles after random hold times, from bounces far shorter than
+--        the filter to levels held well past it. The model follows the spec:
+--        two synchronizer stages, then btn_o takes the synchronized level once
+--        it has differed from btn_o for CNT_MAX + 1 clocks in a row.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+entity button_debouncer_tb is
+  generic (
+    CNT_MAX     : positive := 20; -- short filter, so long holds stay cheap
+    PIPELINE_TC : boolean  := false;
+    CYCLES      : natural  := 100000
+  );
+end entity;
+
+architecture sim of button_debouncer_tb is
+  signal clk   : std_logic := '0';
+  signal rst   : std_logic := '1';
+  signal btn_i : std_logic := '0';
+  signal btn_o : std_logic;
+  signal done  : boolean := false;
+begin
+  dut : entity work.button_debouncer(rtl)
+    generic map (CNT_MAX => CNT_MAX, PIPELINE_TC => PIPELINE_TC)
+    port map (clk => clk, rst => rst, btn_i => btn_i, btn_o => btn_o);
+
+  clk <= not clk after 5 ns when not done;
+
+  stim : process
+    variable lfsr    : unsigned(15 downto 0) := x"ACE1";
+    variable hold    : natural := 0;         -- clocks until btn_i toggles
+    variable sync    : std_logic_vector(1 to 2) := "00";
+    variable out_m   : std_logic := '0';     -- expected btn_o
+    variable run     : natural := 0;         -- clocks the synced level differed
+    variable changes : natural := 0;
+  begin
+    wait until falling_edge(clk); -- first edge applies the reset
+    rst <= '0';
+    for c in 1 to CYCLES loop
+      assert btn_o = out_m
+        report "cycle " & integer'image(c) & ": btn_o=" & std_logic'image(btn_o) &
+               " expected " & std_logic'image(out_m) severity error;
+
+      lfsr := lfsr(14 downto 0) & (lfsr(15) xor lfsr(13) xor lfsr(12) xor lfsr(10));
+      if hold = 0 then
+        btn_i <= not btn_i;
+        hold := 1 + to_integer(lfsr(7 downto 0)) mod (2 * CNT_MAX + 8);
+      else
+        hold := hold - 1;
+      end if;
+      wait for 0 ns; -- btn_i as the next rising edge samples it
+
+      -- model of the next rising edge
+      if sync(2) /= out_m then
+        run := run + 1;
+        if run = CNT_MAX + 1 then
+          out_m := sync(2);
+          run := 0;
+          changes := changes + 1;
+        end if;
+      else
+        run := 0;
+      end if;
+      sync := btn_i & sync(1);
+      wait until falling_edge(clk);
+    end loop;
+    assert changes > CYCLES / (16 * CNT_MAX)
+      report "only " & integer'image(changes) & " debounced changes: stimulus too short" severity error;
+    report "button_debouncer_tb: " & integer'image(CYCLES) & " cycles";
+    done <= true;
+    wait;
+  end process;
+end architecture;
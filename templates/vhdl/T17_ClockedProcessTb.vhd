@@ -3,6 +3,8 @@ use ieee.std_logic_1164.all;
 use ieee.numeric_std.all;
 
 entity T17_ClockedProcessTb is
+generic(
+    Cycles : integer := 100000); -- random cycles after the fixed sequence
 end entity;
 
 architecture sim of T17_ClockedProcessTb is
@@ -14,6 +16,7 @@ architecture sim of T17_ClockedProcessTb is
     signal nRst : std_logic := '0';
     signal Input : std_logic := '0';
     signal Output : std_logic;
+    signal Done   : boolean := false;
 
 begin
 
@@ -26,10 +29,23 @@ begin
         Output => Output);
 
     -- Process for generating the clock
-    Clk <= not Clk after ClockPeriod / 2;
+    Clk <= not Clk after ClockPeriod / 2 when not Done;
+
+    -- Checker: after every rising edge Output must follow Input, or be '0' in reset
+    process is
+        variable Expected : std_logic;
+    begin
+        wait until rising_edge(Clk);
+        Expected := Input and nRst; -- the values the DUT sampled at this edge
+        wait for ClockPeriod / 4;
+        assert Output = Expected
+            report "Output=" & std_logic'image(Output) & " expected " & std_logic'image(Expected)
+            severity error;
+    end process;
 
     -- Testbench sequence
     process is
+        variable Lfsr : unsigned(15 downto 0) := x"ACE1";
     begin
         -- Take the DUT out of reset
         nRst <= '1';
@@ -44,7 +60,23 @@ begin
 
         -- Reset the DUT
         nRst <= '0';
+        wait for 20 ns;
+
+        -- Random input between the clock edges, occasional reset
+        nRst <= '1';
+        for i in 1 to Cycles loop
+            wait until falling_edge(Clk);
+            Lfsr := Lfsr(14 downto 0) & (Lfsr(15) xor Lfsr(13) xor Lfsr(12) xor Lfsr(10));
+            Input <= Lfsr(0);
+            if Lfsr(15 downto 10) = 0 then
+                nRst <= '0';
+            else
+                nRst <= '1';
+            end if;
+        end loop;
 
+        report "T17_ClockedProcessTb: " & integer'image(Cycles) & " cycles";
+        Done <= true;
         wait;
     end process;
 
@@ -0,0 +1,53 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+
+-- Self-checking testbench for counter: q counts every rising edge and wraps
+-- at 256; the asynchronous reset clears it between edges, without a clock.
+entity counter_tb is
+    Generic ( CYCLES : natural := 100000 );
+end counter_tb;
+
+architecture sim of counter_tb is
+    signal clk   : STD_LOGIC := '0';
+    signal reset : STD_LOGIC := '1';
+    signal q     : UNSIGNED(7 downto 0);
+    signal done  : boolean := false;
+begin
+    dut : entity work.counter(Behavioral)
+        port map ( clk => clk, reset => reset, q => q );
+
+    clk <= not clk after 5 ns when not done;
+
+    process
+        variable lfsr  : UNSIGNED(15 downto 0) := x"ACE1";
+        variable model : natural := 0;
+    begin
+        wait for 2 ns;
+        assert q = 0 report "q not cleared by reset" severity error;
+        reset <= '0';
+        for c in 1 to CYCLES loop
+            wait until falling_edge(clk);
+            if reset = '0' then
+                model := (model + 1) mod 256;
+            end if;
+            assert to_integer(q) = model
+                report "cycle " & integer'image(c) & ": q=" & integer'image(to_integer(q)) &
+                       " expected " & integer'image(model) severity error;
+
+            lfsr := lfsr(14 downto 0) & (lfsr(15) xor lfsr(13) xor lfsr(12) xor lfsr(10));
+            if reset = '1' then
+                reset <= '0';
+            elsif lfsr(15 downto 8) = 0 then
+                wait for 1 ns;          -- mid cycle, away from both edges
+                reset <= '1';
+                wait for 1 ns;
+                assert q = 0 report "asynchronous reset did not clear q" severity error;
+                model := 0;
+            end if;
+        end loop;
+        report "counter_tb: " & integer'image(CYCLES) & " cycles";
+        done <= true;
+        wait;
+    end process;
+end sim;
@@ -0,0 +1,168 @@
+"""Decode binary log records from templates/stm32/32_binlog.c.
+
+The firmware sends (id, signed, time, args) records, COBS framed between two
+0x00; time and arguments are LEB128 varints, arguments whose bit is set in
+"signed" zigzag encoded. The 32-bit value is then formatted the way printf
+would format it with that conversion. The id is the offset of the format string
+in the "binlog" section of the ELF, so the ELF of the same build is needed.
+Text from printf in the same stream is passed through unchanged; profiler
+records of 30_profile.c (same framing, tools/profile_report.py) are skipped.
+
+Usage:
+    python tools/binlog_decode.py firmware.elf capture.bin
+    cat /dev/ttyACM0 | python tools/binlog_decode.py firmware.elf -
+Tests: python -m unittest tools/test_binlog_decode.py
+"""
+import re
+import struct
+import sys
+
+SECTION = b'binlog'
+PROFILE_MAGIC = b'PF\x02'
+CONV = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcfFeEgG%])')
+
+
+def read_section(path, name=SECTION):
+    """Return the raw bytes of the named section of a 32- or 64-bit little endian ELF."""
+    with open(path, 'rb') as f:
+        elf = f.read()
+    if elf[:4] != b'\x7fELF' or elf[5] != 1:
+        sys.exit(f"{path}: not a little endian ELF file")
+    if elf[4] == 1:
+        shoff, = struct.unpack_from('<I', elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x2E)
+        sh = lambda i: struct.unpack_from('<IIIIII', elf, shoff + i * shentsize)
+    else:
+        shoff, = struct.unpack_from('<Q', elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x3A)
+        sh = lambda i: struct.unpack_from('<IIQQQQ', elf, shoff + i * shentsize)
+
+    strtab = sh(shstrndx)
+    names = elf[strtab[4]:strtab[4] + strtab[5]]
+    for i in range(shnum):
+        hdr = sh(i)
+        end = names.find(b'\0', hdr[0])
+        if names[hdr[0]:end] == name:
+            return elf[hdr[4]:hdr[4] + hdr[5]]
+    sys.exit(f"{path}: no '{name.decode()}' section (BLOG not used or not linked?)")
+
+
+def fmt_at(table, offset):
+    end = table.find(b'\0', offset)
+    if offset >= len(table) or end < 0:
+        return None
+    return table[offset:end].decode('ascii', 'replace')
+
+
+def render(fmt, words):
+    """printf-style formatting of 32-bit words, typed by the conversion like printf."""
+    out, pos, k = [], 0, 0
+    for m in CONV.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, size, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        if k >= len(words):
+            out.append('<?>')
+            continue
+        w = words[k]
+        k += 1
+        spec = '%' + flags + width + ('.' + prec if prec is not None else '')
+        if conv in 'fFeEgG':
+            out.append((spec + conv) % struct.unpack('<f', struct.pack('<I', w))[0])
+        elif conv == 'c':
+            out.append(chr(w & 0xFF))
+        else:
+            bits = {'hh': 8, 'h': 16}.get(size, 32)
+            w &= (1 << bits) - 1
+            if conv in 'di':
+                out.append((spec + 'd') % (w - (1 << bits) if w >> (bits - 1) else w))
+            else:
+                if w == 0:
+                    spec = spec.replace('#', '')            # C prints 0, not 0x0
+                out.append((spec + ('d' if conv == 'u' else conv)) % w)
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def cobs_decode(frame):
+    out, i = bytearray(), 0
+    while i < len(frame):
+        code = frame[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(frame):
+            return None
+        out += frame[i:i + code - 1]
+        i += code - 1
+        if code != 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def varints(data):
+    """All LEB128 values in data (32 bit), None if one is cut off or too long."""
+    values, v, shift = [], 0, 0
+    for b in data:
+        v |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            values.append(v)
+            v, shift = 0, 0
+        elif shift >= 35:
+            return None
+    return None if shift else values
+
+
+def decode_record(table, frame):
+    """Return (time, text) for a valid record, None otherwise."""
+    rec = cobs_decode(frame)
+    if rec is None or len(rec) < 5 or sum(rec[:-1]) & 0xFF != rec[-1]:
+        return None
+    fmt = fmt_at(table, rec[0] | rec[1] << 8)
+    sign = rec[2]
+    values = varints(rec[3:-1])
+    if fmt is None or not values or max(values) > 0xFFFFFFFF or sign >> (len(values) - 1):
+        return None
+    words = [((w >> 1) ^ -(w & 1)) & 0xFFFFFFFF if sign >> i & 1 else w for i, w in enumerate(values[1:])]
+    return values[0], render(fmt, words)
+
+
+def decode(table, data):
+    """Yield ('text', str) for printf text and ('record', time, str) for records."""
+    chunks = data.split(b'\0')
+    for n, chunk in enumerate(chunks):
+        if not chunk:
+            continue
+        rec = decode_record(table, chunk) if n < len(chunks) - 1 else None
+        if rec is None and n < len(chunks) - 1 and (cobs_decode(chunk) or b'').startswith(PROFILE_MAGIC):
+            continue                                              # profiler record
+        if rec is None:
+            yield 'text', chunk.decode('ascii', 'replace')       # printf text or a torn record
+        else:
+            yield ('record',) + rec
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    table = read_section(sys.argv[1])
+    if sys.argv[2] == '-':
+        data = sys.stdin.buffer.read()
+    else:
+        with open(sys.argv[2], 'rb') as f:
+            data = f.read()
+
+    records = 0
+    for item in decode(table, data):
+        if item[0] == 'text':
+            sys.stdout.write(item[1])
+            continue
+        records += 1
+        print(f"[{item[1]:>10}] {item[2]}")
+    print(f"{records} record(s)", file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
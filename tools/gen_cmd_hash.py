@@ -0,0 +1,47 @@
+"""Find a collision-free multiplier for the command opcode hash.
+
+Used by templates/stm32/29_cmd_dispatch.c:
+    key  = op[0] | op[1] << 8          (op[1] = 0 for one-letter opcodes)
+    slot = (uint16_t)(key * CMD_HASH_MULT) >> (16 - CMD_HASH_BITS)
+
+Usage: python tools/gen_cmd_hash.py MA MR SP RF ST Z EN DI
+Prints the #define lines to paste into the template.
+"""
+import sys
+
+
+def slot(op, mult, bits):
+    key = ord(op[0]) | (ord(op[1]) << 8 if len(op) > 1 else 0)
+    return ((key * mult) & 0xFFFF) >> (16 - bits)
+
+
+def find(ops, bits):
+    for mult in range(1, 0x10000, 2):
+        slots = {slot(op, mult, bits) for op in ops}
+        if len(slots) == len(ops):
+            return mult
+    return None
+
+
+def main():
+    ops = sys.argv[1:]
+    if not ops or any(not 1 <= len(op) <= 2 for op in ops):
+        sys.exit("usage: gen_cmd_hash.py OP [OP ...]   (opcodes of 1 or 2 characters)")
+
+    bits = max(1, (len(ops) - 1).bit_length())
+    while bits <= 8:
+        mult = find(ops, bits)
+        if mult is not None:
+            break
+        bits += 1
+    else:
+        sys.exit("no multiplier found for up to 256 slots")
+
+    print(f"#define CMD_HASH_BITS  {bits}u")
+    print(f"#define CMD_HASH_MULT  0x{mult:04X}u")
+    for op in sorted(ops, key=lambda o: slot(o, mult, bits)):
+        print(f"/* {op:<2} -> slot {slot(op, mult, bits)} */")
+
+
+if __name__ == '__main__':
+    main()
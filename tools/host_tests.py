@@ -0,0 +1,80 @@
+"""Build and run the host tests of the STM32 templates (templates/stm32/host).
+
+Each test_*.c includes the template it covers, is linked with hal_stub.c and
+runs against the stub stm32xx_hal.h in the same folder. Tests are built with
+gcc, ASan and UBSan and run in parallel, one per core unless -j says otherwise.
+Warnings are errors, so a test that does not compile cleanly fails. A test
+passes when it exits 0.
+
+--bench builds the same files with -O2 and no sanitizers and runs them with
+--bench, so each prints its measurements after its checks.
+
+Usage:
+    python tools/host_tests.py [-jN] [--bench] [test ...]
+    python tools/host_tests.py --bench test_16_parse_z_frame
+"""
+import glob
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+
+HOST_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'templates', 'stm32', 'host')
+CFLAGS = ['-std=gnu11', '-g', '-Wall', '-Wextra', '-Werror', '-Wno-unused-function', '-pthread']
+CHECK_FLAGS = ['-O1', '-fsanitize=address,undefined', '-fno-sanitize-recover=undefined', '-fno-omit-frame-pointer']
+BENCH_FLAGS = ['-O2']
+
+
+def tests():
+    return {os.path.splitext(os.path.basename(p))[0]: p
+            for p in sorted(glob.glob(os.path.join(HOST_DIR, 'test_*.c')))}
+
+
+def run(name, path, bench):
+    """Return (passed, output) for one test."""
+    cc = os.environ.get('CC', 'gcc')
+    with tempfile.TemporaryDirectory(prefix=f'host_{name}_') as work:
+        exe = os.path.join(work, name)
+        cmd = [cc] + CFLAGS + (BENCH_FLAGS if bench else CHECK_FLAGS) + \
+              ['-I', HOST_DIR, path, os.path.join(HOST_DIR, 'hal_stub.c'), '-o', exe, '-lm']
+        p = subprocess.run(cmd, capture_output=True, text=True)
+        if p.returncode:
+            return False, p.stdout + p.stderr
+        p = subprocess.run([exe] + (['--bench'] if bench else []), cwd=work, capture_output=True, text=True)
+        return p.returncode == 0, p.stdout + p.stderr
+
+
+def main():
+    jobs, bench, names = os.cpu_count() or 1, False, []
+    known = tests()
+    for arg in sys.argv[1:]:
+        if arg.startswith('-j') and arg[2:].isdigit():
+            jobs = int(arg[2:])
+        elif arg == '--bench':
+            bench = True
+        elif arg in known:
+            names.append(arg)
+        else:
+            sys.exit(__doc__)
+    if shutil.which(os.environ.get('CC', 'gcc')) is None:
+        sys.exit("C compiler not found in PATH")
+
+    names = names or list(known)
+    # Benchmarks one at a time, so they do not compete for cores
+    with ThreadPoolExecutor(max_workers=1 if bench else jobs) as pool:
+        results = list(pool.map(lambda n: run(n, known[n], bench), names))
+
+    failed = 0
+    for name, (passed, out) in zip(names, results):
+        print(f"{name:<32} {'PASS' if passed else 'FAIL'}")
+        if bench or not passed:
+            print('\n'.join('    ' + line for line in out.strip().splitlines()))
+        failed += not passed
+    print(f"{len(names) - failed}/{len(names)} passed")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,85 @@
+"""Decode profiler records from templates/stm32/30_profile.c.
+
+The firmware writes binary records ('P' 'F' 2 ...) into the normal UART log,
+COBS framed between two 0x00 like the records of 32_binlog.c. Capture the port
+to a file (or pipe it in) and this script finds every record in the stream,
+checks it and prints the last one as a report sorted by total cycles. printf
+text and binlog records in between are skipped.
+
+Usage:
+    python tools/profile_report.py capture.bin
+    cat /dev/ttyACM0 | python tools/profile_report.py -
+"""
+import struct
+import sys
+
+from binlog_decode import cobs_decode
+
+MAGIC = b'PF\x02'
+
+
+def parse_record(data, pos):
+    """Return (cpu_mhz, probes, end) for a record at pos, or None if invalid."""
+    try:
+        mhz, n = struct.unpack_from('<HB', data, pos + 3)
+        p = pos + 6
+        probes = []
+        for _ in range(n):
+            pid, length = struct.unpack_from('<BB', data, p)
+            p += 2
+            name = data[p:p + length].decode('ascii', 'replace')
+            p += length
+            count, cmin, cmax, total = struct.unpack_from('<IIIQ', data, p)
+            p += 20
+            probes.append((pid, name, count, cmin, cmax, total))
+        if sum(data[pos:p]) & 0xFF != data[p]:
+            return None
+        return mhz, probes, p + 1
+    except (struct.error, IndexError):
+        return None
+
+
+def find_records(data):
+    records = []
+    chunks = data.split(b'\0')
+    for chunk in chunks[1:-1]:                     # the first and last may be torn
+        frame = cobs_decode(chunk) if chunk else None
+        if not frame or not frame.startswith(MAGIC):
+            continue
+        rec = parse_record(frame, 0)
+        if rec and rec[2] == len(frame):
+            records.append(rec[:2])
+    return records
+
+
+def report(mhz, probes):
+    grand = sum(p[5] for p in probes) or 1
+    scale = 1.0 / mhz if mhz else 0.0
+    print(f"{'probe':<24}{'count':>10}{'min':>10}{'mean':>10}{'max':>10}{'total %':>9}   cycles (us @ {mhz} MHz)")
+    for pid, name, count, cmin, cmax, total in sorted(probes, key=lambda p: p[5], reverse=True):
+        if count == 0:
+            print(f"{name:<24}{0:>10}{'-':>10}{'-':>10}{'-':>10}{0:>8.1f}%")
+            continue
+        mean = total / count
+        print(f"{name:<24}{count:>10}{cmin:>10}{mean:>10.0f}{cmax:>10}{100.0 * total / grand:>8.1f}%"
+              f"   ({cmin * scale:.2f} / {mean * scale:.2f} / {cmax * scale:.2f} us)")
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    if sys.argv[1] == '-':
+        data = sys.stdin.buffer.read()
+    else:
+        with open(sys.argv[1], 'rb') as f:
+            data = f.read()
+
+    records = find_records(data)
+    if not records:
+        sys.exit("no valid profiler record found")
+    print(f"{len(records)} record(s), showing the last one")
+    report(*records[-1])
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,129 @@
+"""Tests for tools/binlog_decode.py.
+
+The unit tests build records by hand against a small string table. The end to
+end test compiles templates/stm32/host/test_32_binlog.c with gcc, runs it with
+--emit (printf text and BLOG() records mixed, no newline before a record) and
+checks that the decoder gives back the text and, for every record, the line
+printf printed for the same arguments. It is skipped without gcc.
+
+Usage:
+    python -m unittest tools/test_binlog_decode.py
+"""
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import binlog_decode  # noqa: E402
+
+HOST_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'templates', 'stm32', 'host')
+
+
+def varint(v):
+    out = bytearray()
+    while v >= 0x80:
+        out.append(v & 0x7F | 0x80)
+        v >>= 7
+    out.append(v)
+    return bytes(out)
+
+
+def zigzag(v):
+    return ((v << 1) ^ (v >> 31)) & 0xFFFFFFFF
+
+
+def cobs_encode(data):
+    out, block = bytearray(), bytearray()
+    for b in data:
+        if b:
+            block.append(b)
+        if not b or len(block) == 254:
+            out += bytes([len(block) + 1]) + block
+            block = bytearray()
+    return bytes(out + bytes([len(block) + 1]) + block)
+
+
+def frame(fmt_id, time, args, sign=0):
+    """0x00 | COBS(id | sign | time | args | sum) | 0x00, as blog_encode() builds it."""
+    rec = bytes([fmt_id & 0xFF, fmt_id >> 8, sign]) + varint(time) + b''.join(varint(a) for a in args)
+    rec += bytes([sum(rec) & 0xFF])
+    return b'\0' + cobs_encode(rec) + b'\0'
+
+
+TABLE = b'%d %u\0%hd %hhu %x\0%c%c\0%5.2f\0'
+ID_DU, ID_SHORT, ID_CC, ID_F = 0, 6, 18, 23
+
+
+class DecodeTest(unittest.TestCase):
+    def items(self, data):
+        return list(binlog_decode.decode(TABLE, data))
+
+    def test_sign_from_record_not_format(self):
+        # int -5 and unsigned 4000000000, each printed with the other conversion
+        data = frame(ID_DU, 1, [zigzag(-5), zigzag(-5)], sign=3) + frame(ID_DU, 2, [4000000000, 4000000000])
+        self.assertEqual(self.items(data), [('record', 1, '-5 4294967291'),
+                                            ('record', 2, '-294967296 4000000000')])
+
+    def test_length_modifiers(self):
+        data = frame(ID_SHORT, 3, [zigzag(-3), 250, 0xDEADBEEF], sign=1)
+        self.assertEqual(self.items(data), [('record', 3, '-3 250 deadbeef')])
+
+    def test_char_and_float(self):
+        data = frame(ID_CC, 4, [zigzag(ord('O')), ord('K')], sign=1) + frame(ID_F, 5, [0x40500000])
+        self.assertEqual(self.items(data), [('record', 4, 'OK'), ('record', 5, ' 3.25')])
+
+    def test_text_before_and_after(self):
+        data = b'boot ok\r\nT=' + frame(ID_DU, 9, [zigzag(7), 8], sign=1) + b' C\r\n' + frame(ID_CC, 10, [65, 66])
+        self.assertEqual(self.items(data), [('text', 'boot ok\r\nT='), ('record', 9, '7 8'),
+                                            ('text', ' C\r\n'), ('record', 10, 'AB')])
+
+    def test_broken_records_are_text(self):
+        good = frame(ID_DU, 1, [1, 2])
+        bad_sum = bytearray(good)
+        bad_sum[-2] ^= 1
+        torn = good[:-3]                                 # end of the capture
+        items = self.items(bytes(bad_sum) + good + torn)
+        self.assertEqual([i[0] for i in items], ['text', 'record', 'text'])
+
+    def test_profile_records_are_skipped(self):
+        prof = b'\0' + cobs_encode(binlog_decode.PROFILE_MAGIC + bytes([168, 0, 0, 0x40])) + b'\0'
+        data = b'a' + prof + b'b' + frame(ID_CC, 4, [65, 66])
+        self.assertEqual(self.items(data), [('text', 'a'), ('text', 'b'), ('record', 4, 'AB')])
+
+    def test_sign_bit_past_the_arguments(self):
+        self.assertEqual(self.items(frame(ID_DU, 1, [1, 2], sign=4))[0][0], 'text')
+
+    def test_zero_bytes_and_32_bit_limits(self):
+        table = b'%u' * 6 + b'\0'
+        args = [0xFFFFFFFF, 0, 0x80, 0x7F, 0x10000000, 1]
+        data = frame(0, 0xFFFFFFFF, args)
+        self.assertEqual(list(binlog_decode.decode(table, data)),
+                         [('record', 0xFFFFFFFF, ''.join(str(a) for a in args))])
+
+
+@unittest.skipUnless(shutil.which(os.environ.get('CC', 'gcc')), 'needs gcc')
+class EndToEndTest(unittest.TestCase):
+    def test_host_build(self):
+        with tempfile.TemporaryDirectory(prefix='binlog_') as work:
+            exe = os.path.join(work, 'test_32_binlog')
+            subprocess.run([os.environ.get('CC', 'gcc'), '-std=gnu11', '-O1', '-I', HOST_DIR,
+                            os.path.join(HOST_DIR, 'test_32_binlog.c'), os.path.join(HOST_DIR, 'hal_stub.c'),
+                            '-o', exe, '-lm'], check=True)
+            run = subprocess.run([exe, '--emit'], capture_output=True, check=True)
+            table = binlog_decode.read_section(exe)
+
+        items = list(binlog_decode.decode(table, run.stdout))
+        want = run.stderr.decode().splitlines()
+        texts = [i[1] for i in items if i[0] == 'text']
+        records = [i[2] for i in items if i[0] == 'record']
+        self.assertEqual(records, want)
+        self.assertEqual(texts, [f't{n}:' for n in range(len(want))] + ['tail text\n'])
+        times = [i[1] for i in items if i[0] == 'record']
+        self.assertEqual(times, [7 * (n + 1) for n in range(len(want))])
+
+
+if __name__ == '__main__':
+    unittest.main()
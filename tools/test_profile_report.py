@@ -0,0 +1,51 @@
+"""Tests for tools/profile_report.py.
+
+Records are built by hand the way profile_dump() in 30_profile.c sends them,
+COBS framed between two 0x00, and mixed with printf text and binlog frames.
+
+Usage:
+    python -m unittest tools/test_profile_report.py
+"""
+import os
+import struct
+import sys
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import profile_report  # noqa: E402
+from test_binlog_decode import cobs_encode, frame  # noqa: E402
+
+PROBES = [(0, 'parse_z_frame', 3, 100, 300, 600), (1, 'idle', 0, 0, 0, 0), (2, 'big', 2, 1, 0xFFFFFFFF, 2**32 + 1)]
+
+
+def record(mhz, probes, corrupt=False):
+    rec = b'PF\x02' + struct.pack('<HB', mhz, len(probes))
+    for pid, name, count, cmin, cmax, total in probes:
+        rec += bytes([pid, len(name)]) + name.encode() + struct.pack('<IIIQ', count, cmin, cmax, total)
+    rec += bytes([(sum(rec) + corrupt) & 0xFF])
+    return b'\0' + cobs_encode(rec) + b'\0'
+
+
+class FindRecordsTest(unittest.TestCase):
+    def test_between_text_and_binlog_frames(self):
+        data = b'boot\r\n' + record(168, PROBES) + b'T=' + frame(0, 1, [2]) + b' C\r\n'
+        self.assertEqual(profile_report.find_records(data), [(168, PROBES)])
+
+    def test_zero_bytes_inside_the_record(self):
+        probes = [(0, 'z', 0, 0, 0, 0)]
+        data = record(16, probes)
+        self.assertGreater(data.count(b'\0'), 0)
+        self.assertEqual(data[1:-1].count(b'\0'), 0)
+        self.assertEqual(profile_report.find_records(data), [(16, probes)])
+
+    def test_bad_checksum_and_torn_records(self):
+        good = record(168, PROBES[:1])
+        data = record(168, PROBES[:1], corrupt=True) + good + good[:-4]
+        self.assertEqual(profile_report.find_records(data), [(168, PROBES[:1])])
+
+    def test_unframed_record_is_not_found(self):
+        self.assertEqual(profile_report.find_records(b'x' + record(168, PROBES[:1])[1:-1] + b'y'), [])
+
+
+if __name__ == '__main__':
+    unittest.main()
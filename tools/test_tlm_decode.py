@@ -0,0 +1,105 @@
+"""Tests for tools/tlm_decode.py.
+
+The unit tests build frames by hand. The end to end test compiles
+templates/stm32/host/test_33_telemetry_frame.c with gcc, runs it with --emit
+(TEMP and Z frames with text in between) and checks that every frame decodes
+to the values the firmware side printed for it. It is skipped without gcc.
+
+Usage:
+    python -m unittest tools/test_tlm_decode.py
+"""
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import tlm_decode  # noqa: E402
+
+HOST_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'templates', 'stm32', 'host')
+
+
+def frame(ftype, payload, version=tlm_decode.VERSION):
+    """0xA5 | version | type | len | payload | crc16, as tlm_seal() builds it."""
+    body = bytes([version, ftype, len(payload)]) + payload
+    return bytes([tlm_decode.SYNC]) + body + struct.pack('<H', tlm_decode.crc16(body))
+
+
+def temp(tick, sensors):
+    return frame(1, struct.pack('<IB', tick, len(sensors)) + b''.join(struct.pack('<Bh', a, r) for a, r in sensors))
+
+
+def decoded(data):
+    return [tlm_decode.DECODERS[t](p) for _, t, p in tlm_decode.frames(data)]
+
+
+class DecodeTest(unittest.TestCase):
+    def test_crc_check_value(self):
+        self.assertEqual(tlm_decode.crc16(b'123456789'), 0x29B1)
+
+    def test_temp_keys_and_rounding(self):
+        data = temp(7, [(73, 392), (72, -9), (77, 16)])
+        self.assertEqual(decoded(data), [{'tick': 7, 'temp_system': 24.5, 'temp_drivers': -0.6, '77': 1.0}])
+
+    def test_z_flags_and_position(self):
+        data = frame(2, struct.pack('<iBB', -12500, 0x1F, 40)) + frame(2, struct.pack('<iBB', 5, 0x01, 0))
+        self.assertEqual(decoded(data), [{'p': -12.5, 'r': 1, 'b': 1, 'o': 1, 'u': 1, 'v': 40},
+                                         {'p': None, 'r': 1, 'b': 0, 'o': 0, 'u': 0, 'v': 0}])
+
+    def test_short_payloads_are_not_decoded(self):
+        for n in range(5):
+            self.assertIsNone(tlm_decode.decode_temp(bytes(n)))
+        self.assertIsNone(tlm_decode.decode_temp(struct.pack('<IB', 1, 2) + bytes(3)))
+        self.assertIsNone(tlm_decode.decode_z(bytes(5)))
+
+    def test_resync_after_garbage_and_bad_frames(self):
+        good = temp(1, [(73, 16)])
+        bad_crc = bytearray(good)
+        bad_crc[-1] ^= 1
+        false_header = bytes([tlm_decode.SYNC, tlm_decode.VERSION, 1, 3])
+        data = b'{"x":1}\xa5\xa5' + bytes(bad_crc) + false_header + good + frame(1, b'', version=2) + good[:-1]
+        found = list(tlm_decode.frames(data))
+        self.assertEqual(len(found), 1)
+        self.assertEqual(data[found[0][0]:found[0][0] + len(good)], good)
+
+    def test_main_prints_short_frame_as_hex(self):
+        with tempfile.TemporaryDirectory(prefix='tlm_') as work:
+            path = os.path.join(work, 'capture.bin')
+            with open(path, 'wb') as f:
+                f.write(frame(1, b'\x01\x02') + temp(2, [(79, -32)]))
+            run = subprocess.run([sys.executable, os.path.join(os.path.dirname(tlm_decode.__file__), 'tlm_decode.py'),
+                                  path], capture_output=True, text=True, check=True)
+        self.assertEqual(run.stdout.splitlines(), ['type 1: 0102', '{"tick":2,"temp_motor_y":-2.0}'])
+
+
+@unittest.skipUnless(shutil.which(os.environ.get('CC', 'gcc')), 'needs gcc')
+class EndToEndTest(unittest.TestCase):
+    def test_host_build(self):
+        with tempfile.TemporaryDirectory(prefix='tlm_') as work:
+            exe = os.path.join(work, 'test_33_telemetry_frame')
+            subprocess.run([os.environ.get('CC', 'gcc'), '-std=gnu11', '-O1', '-I', HOST_DIR,
+                            os.path.join(HOST_DIR, 'test_33_telemetry_frame.c'), os.path.join(HOST_DIR, 'hal_stub.c'),
+                            '-o', exe, '-lm'], check=True)
+            run = subprocess.run([exe, '--emit'], capture_output=True, check=True)
+
+        docs = decoded(run.stdout)
+        want = run.stderr.decode().splitlines()
+        self.assertEqual(len(docs), len(want))
+        for doc, line in zip(docs, want):
+            kind, *fields = line.split()
+            if kind == 'T':
+                expect = {'tick': int(fields[0])}
+                for field in fields[1:]:
+                    addr, raw = map(int, field.split(':'))
+                    expect[tlm_decode.SENSOR_KEYS.get(addr, str(addr))] = round(raw / 16.0, 1)
+            else:
+                um, ok, ref, busy, back, front, speed = map(int, fields)
+                expect = {'p': um / 1000.0 if ok else None, 'r': ref, 'b': busy, 'o': back, 'u': front, 'v': speed}
+            self.assertEqual(doc, expect)
+
+
+if __name__ == '__main__':
+    unittest.main()
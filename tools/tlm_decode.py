@@ -0,0 +1,100 @@
+"""Decode binary telemetry frames from templates/stm32/33_telemetry_frame.c.
+
+    0xA5 | version | type | len | payload[len] | crc16 (LE)
+
+CRC-16/CCITT-FALSE over version..payload. Every valid frame is printed as one
+JSON line with the same keys as the text telemetry, so existing consumers of the
+JSON output can read either. Bytes outside frames are skipped and counted.
+
+Usage:
+    python tools/tlm_decode.py capture.bin
+    cat /dev/ttyACM0 | python tools/tlm_decode.py -
+Tests: python -m unittest tools/test_tlm_decode.py
+"""
+import json
+import struct
+import sys
+
+SYNC = 0xA5
+VERSION = 1
+MAX_PAYLOAD = 64
+
+SENSOR_KEYS = {73: 'temp_system', 72: 'temp_drivers', 75: 'temp_motor_x', 79: 'temp_motor_y'}
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def decode_temp(p):
+    if len(p) < 5:
+        return None
+    tick, n = struct.unpack_from('<IB', p)
+    if len(p) != 5 + 3 * n:
+        return None
+    doc = {'tick': tick}
+    for j in range(n):
+        addr, raw = struct.unpack_from('<Bh', p, 5 + 3 * j)
+        doc[SENSOR_KEYS.get(addr, str(addr))] = round(raw / 16.0, 1)
+    return doc
+
+
+def decode_z(p):
+    if len(p) != 6:
+        return None
+    um, flags, speed = struct.unpack('<iBB', p)
+    return {
+        'p': um / 1000.0 if flags & 0x10 else None,
+        'r': flags & 1, 'b': flags >> 1 & 1, 'o': flags >> 2 & 1, 'u': flags >> 3 & 1, 'v': speed,
+    }
+
+
+DECODERS = {1: decode_temp, 2: decode_z}
+
+
+def frames(data):
+    """Yield (offset, type, payload) for each valid frame, resyncing after bad ones."""
+    i = 0
+    while True:
+        i = data.find(bytes([SYNC]), i)
+        if i < 0 or len(data) - i < 4:
+            return
+        ver, ftype, n = data[i + 1], data[i + 2], data[i + 3]
+        end = i + 4 + n + 2
+        if ver != VERSION or n > MAX_PAYLOAD or end > len(data) \
+                or crc16(data[i + 1:i + 4 + n]) != struct.unpack_from('<H', data, i + 4 + n)[0]:
+            i += 1
+            continue
+        yield i, ftype, data[i + 4:i + 4 + n]
+        i = end
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    if sys.argv[1] == '-':
+        data = sys.stdin.buffer.read()
+    else:
+        with open(sys.argv[1], 'rb') as f:
+            data = f.read()
+
+    count = framed = 0
+    for _, ftype, payload in frames(data):
+        decode = DECODERS.get(ftype)
+        doc = decode(payload) if decode else None
+        framed += 4 + len(payload) + 2
+        if doc is None:
+            print(f"type {ftype}: {payload.hex()}")
+        else:
+            print(json.dumps(doc, separators=(',', ':')))
+        count += 1
+    print(f"{count} frame(s), {len(data) - framed} byte(s) outside frames", file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,107 @@
+"""Run the self-checking VHDL testbenches in templates/vhdl with GHDL.
+
+Every testbench is analysed, elaborated and run in its own work directory, so
+they run in parallel, one per core unless -j says otherwise. A testbench passes
+when GHDL exits 0 (run with --assert-level=error, so any failed assertion stops
+it) and it reported its "<n> cycles" line at the end. Simulated clock cycles per
+second of the run step are printed for comparing designs and testbenches.
+
+Usage:
+    python tools/vhdl_regress.py [-jN] [-gNAME=VALUE ...] [testbench ...]
+    python tools/vhdl_regress.py -gCYCLES=1000000 modn_counter_tb
+
+-g is passed to every selected testbench; they all have a CYCLES generic.
+The "/tc" runs repeat a testbench with PIPELINE_TC=true.
+
+Exit status: 0 all passed, 1 a testbench failed, 2 ghdl not in PATH. In the
+last case the table still lists the selected testbenches, as SKIP, so a log
+never reads as a pass that did not happen.
+"""
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+VHDL_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'templates', 'vhdl')
+STD = '--std=08'
+
+# run name -> (testbench entity, sources in analysis order, generics)
+TESTS = {
+    'moore_fsm_tb': ('moore_fsm_tb', ['07_fsm_moore_template.vhd', '07_fsm_moore_template_tb.vhd'], []),
+    'modn_counter_tb': ('modn_counter_tb', ['10_utils_pkg.vhd', '08_modn_counter.vhd', '08_modn_counter_tb.vhd'], []),
+    'modn_counter_tb/tc': ('modn_counter_tb', ['10_utils_pkg.vhd', '08_modn_counter.vhd', '08_modn_counter_tb.vhd'],
+                           ['-gPIPELINE_TC=true']),
+    'button_debouncer_tb': ('button_debouncer_tb', ['10_utils_pkg.vhd', '09_button_debouncer.vhd',
+                                                    '09_button_debouncer_tb.vhd'], []),
+    'button_debouncer_tb/tc': ('button_debouncer_tb', ['10_utils_pkg.vhd', '09_button_debouncer.vhd',
+                                                       '09_button_debouncer_tb.vhd'], ['-gPIPELINE_TC=true']),
+    'T17_ClockedProcessTb': ('T17_ClockedProcessTb', ['T17_FlipFlop.vhd', 'T17_ClockedProcessTb.vhd'], []),
+    'counter_tb': ('counter_tb', ['counter.vhd', 'counter_tb.vhd'], []),
+}
+CYCLES = re.compile(r'(\d+) cycles')
+
+
+def run(name, generics):
+    """Return (passed, cycles, run seconds, output) for one testbench run."""
+    tb, files, fixed = TESTS[name]
+    with tempfile.TemporaryDirectory(prefix=f'ghdl_{tb}_') as work:
+        opts = [STD, f'--workdir={work}']
+        sources = [os.path.join(VHDL_DIR, s) for s in files]
+        for cmd in (['ghdl', '-a'] + opts + sources, ['ghdl', '-e'] + opts + [tb]):
+            p = subprocess.run(cmd, cwd=work, capture_output=True, text=True)
+            if p.returncode:
+                return False, 0, 0.0, p.stdout + p.stderr
+        t0 = time.perf_counter()
+        p = subprocess.run(['ghdl', '-r'] + opts + [tb, '--assert-level=error'] + fixed + generics,
+                           cwd=work, capture_output=True, text=True)
+        seconds = time.perf_counter() - t0
+    out = p.stdout + p.stderr
+    m = CYCLES.search(out)
+    cycles = int(m.group(1)) if m else 0
+    return p.returncode == 0 and m is not None, cycles, seconds, out
+
+
+def main():
+    jobs, generics, names = os.cpu_count() or 1, [], []
+    for arg in sys.argv[1:]:
+        if arg.startswith('-j') and arg[2:].isdigit():
+            jobs = int(arg[2:])
+        elif arg.startswith('-g') and '=' in arg:
+            generics.append(arg)
+        elif arg in TESTS:
+            names.append(arg)
+        else:
+            sys.exit(__doc__)
+    names = names or list(TESTS)
+    have_ghdl = shutil.which('ghdl') is not None
+    if have_ghdl:
+        with ThreadPoolExecutor(max_workers=jobs) as pool:
+            results = list(pool.map(lambda tb: run(tb, generics), names))
+    else:
+        results = [None] * len(names)
+
+    failed = 0
+    print(f"{'testbench':<24} {'result':<6} {'cycles':>10} {'run s':>8} {'cycles/s':>12}")
+    for name, result in zip(names, results):
+        if result is None:
+            print(f"{name:<24} {'SKIP':<6} {'-':>10} {'-':>8} {'-':>12}")
+            continue
+        passed, cycles, seconds, out = result
+        rate = cycles / seconds if seconds > 0 else 0.0
+        print(f"{name:<24} {'PASS' if passed else 'FAIL':<6} {cycles:>10} {seconds:>8.2f} {rate:>12.0f}")
+        if not passed:
+            failed += 1
+            print('\n'.join('    ' + line for line in out.strip().splitlines()[-10:]))
+    if not have_ghdl:
+        print(f"0/{len(names)} run: ghdl not found in PATH, nothing was simulated")
+        sys.exit(2)
+    print(f"{len(names) - failed}/{len(names)} passed")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,109 @@
+"""Synthesis report for the counters in templates/vhdl (Yosys + GHDL plugin).
+
+Synthesises modn_counter and button_debouncer for iCE40 with and without
+PIPELINE_TC, and optionally the versions from an older git revision, then
+prints LUT, flip-flop and carry cell counts, the longest combinational path in
+cells and an Fmax estimate. Fmax comes from nextpnr-ice40 (HX8K, unconstrained
+pins) when it is installed; otherwise only the path length is shown.
+
+Usage:
+    python tools/vhdl_synth_report.py [--base REV]
+    python tools/vhdl_synth_report.py --base fce8e76~1  # before/after the ceil_log2 sizing
+
+Exit status 2 when yosys is not in PATH; the table then lists the runs as
+SKIP and no figures.
+"""
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+VHDL_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'templates', 'vhdl')
+UTILS = '10_utils_pkg.vhd'
+
+# label, entity, source, generics
+DESIGNS = [
+    ('modn_counter N=10', 'modn_counter', '08_modn_counter.vhd', {'N': 10}),
+    ('modn_counter N=1000000', 'modn_counter', '08_modn_counter.vhd', {'N': 1000000}),
+    ('button_debouncer 50000', 'button_debouncer', '09_button_debouncer.vhd', {'CNT_MAX': 50000}),
+]
+
+
+def git_file(rev, name, work):
+    """Write templates/vhdl/<name> at rev into work and return its path."""
+    p = subprocess.run(['git', 'show', f'{rev}:templates/vhdl/{name}'], cwd=VHDL_DIR,
+                       capture_output=True, text=True)
+    if p.returncode:
+        sys.exit(f"git show {rev}:templates/vhdl/{name}: {p.stderr.strip()}")
+    path = os.path.join(work, f'base_{name}')
+    with open(path, 'w') as f:
+        f.write(p.stdout)
+    return path
+
+
+def synth(entity, sources, generics, work):
+    """Return (cell counts by type, longest path, Fmax MHz or None)."""
+    work = tempfile.mkdtemp(dir=work)    # fresh GHDL library for every run
+    gen = ' '.join(f'-g{k}={v}' for k, v in generics.items())
+    stat, ltp, netlist = (os.path.join(work, n) for n in ('stat.json', 'ltp.txt', 'out.json'))
+    script = (f"ghdl --std=08 {gen} {' '.join(sources)} -e {entity}; "
+              f"synth_ice40 -top {entity} -json {netlist}; "
+              f"tee -q -o {stat} stat -json; tee -q -o {ltp} ltp -noff")
+    p = subprocess.run(['yosys', '-q', '-m', 'ghdl', '-p', script], cwd=work, capture_output=True, text=True)
+    if p.returncode:
+        sys.exit(f"yosys failed for {entity} {gen}:\n{p.stdout}{p.stderr}")
+    with open(stat) as f:
+        cells = json.load(f)['design']['num_cells_by_type']
+    with open(ltp) as f:
+        m = re.search(r'length=(\d+)', f.read())
+    depth = int(m.group(1)) if m else 0
+
+    fmax = None
+    if shutil.which('nextpnr-ice40'):
+        p = subprocess.run(['nextpnr-ice40', '--hx8k', '--package', 'ct256', '--json', netlist,
+                            '--pcf-allow-unconstrained', '--timing-allow-fail', '--freq', '500', '--seed', '1'],
+                           cwd=work, capture_output=True, text=True)
+        found = re.findall(r"Max frequency for clock .*?: ([\d.]+) MHz", p.stderr)
+        fmax = float(found[-1]) if found else None
+    return cells, depth, fmax
+
+
+def main():
+    args = sys.argv[1:]
+    base = None
+    if args[:1] == ['--base'] and len(args) == 2:
+        base = args[1]
+    elif args:
+        sys.exit(__doc__)
+    have_yosys = shutil.which('yosys') is not None
+
+    print(f"{'design':<24} {'variant':<8} {'LUT':>6} {'FF':>5} {'CARRY':>6} {'path':>5} {'Fmax MHz':>9}")
+    with tempfile.TemporaryDirectory(prefix='synth_') as work:
+        utils = os.path.join(VHDL_DIR, UTILS)
+        for label, entity, source, generics in DESIGNS:
+            runs = []
+            if base:
+                runs.append(('base', [git_file(base, UTILS, work), git_file(base, source, work)], generics))
+            src = [utils, os.path.join(VHDL_DIR, source)]
+            runs.append(('comb', src, dict(generics, PIPELINE_TC='false')))
+            runs.append(('tc', src, dict(generics, PIPELINE_TC='true')))
+            for variant, sources, gen in runs:
+                if not have_yosys:
+                    print(f"{label:<24} {variant:<8} {'SKIP':>6}")
+                    continue
+                cells, depth, fmax = synth(entity, sources, gen, work)
+                luts = cells.get('SB_LUT4', 0)
+                ffs = sum(n for t, n in cells.items() if t.startswith('SB_DFF'))
+                carry = cells.get('SB_CARRY', 0)
+                print(f"{label:<24} {variant:<8} {luts:>6} {ffs:>5} {carry:>6} {depth:>5} "
+                      f"{f'{fmax:.1f}' if fmax is not None else 'n/a':>9}")
+    if not have_yosys:
+        print("yosys not found in PATH (needs the ghdl plugin: yosys -m ghdl), nothing was synthesised")
+        sys.exit(2)
+
+
+if __name__ == '__main__':
+    main()